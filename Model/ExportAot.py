@@ -0,0 +1,133 @@
+import argparse
+import os
+import platform
+import shutil
+import subprocess
+
+import tensorflow as tf
+from tensorflow.python.framework.convert_to_constants import \
+    convert_variables_to_constants_v2
+
+from Model import Model
+
+
+def node_name(tensor_name):
+    """
+    Function to strip the output index from a graph tensor name.
+
+    Args:
+        tensor_name (str): tensor name such as "main_input:0"
+
+    Returns:
+        str: node name
+    """
+
+    return tensor_name.split(":")[0]
+
+
+def write_config(path, frozen_func):
+    """
+    Function to write the tf2xla config listing the feeds and fetches of the
+    frozen graph in model input and output order.
+
+    Args:
+        path (str): config file path
+        frozen_func: frozen concrete function
+    """
+
+    with open(path, "w") as config:
+        for tensor in frozen_func.inputs:
+            dims = " ".join("dim { size: %d }" % d for d in tensor.shape)
+            config.write('feed { id { node_name: "%s" } shape { %s } }\n'
+                         % (node_name(tensor.name), dims))
+        for tensor in frozen_func.outputs:
+            name, _, index = tensor.name.partition(":")
+            config.write('fetch { id { node_name: "%s" output_index: %s } }\n'
+                         % (name, index or "0"))
+
+
+def write_header(path, model):
+    """
+    Function to write the constants the C++ AotModel needs to drive the
+    compiled function.
+
+    Args:
+        path (str): header file path
+        model (Model): model the graph was exported from
+    """
+
+    with open(path, "w") as header:
+        header.write("#ifndef NOISE_REDUCTION_AOT_CONFIG_H\n"
+                     "#define NOISE_REDUCTION_AOT_CONFIG_H\n\n"
+                     "#include <cstddef>\n\n"
+                     "namespace rtnr_aot\n{\n"
+                     "constexpr std::size_t kBlockLen = %d;\n"
+                     "constexpr std::size_t kStateCount = %d;\n"
+                     "constexpr std::size_t kStateSize = %d;\n"
+                     "} // namespace rtnr_aot\n\n"
+                     "#endif // NOISE_REDUCTION_AOT_CONFIG_H\n"
+                     % (model.block_len, 2 * 2 * model.layers_count,
+                        model.units_count))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Export the noise reduction model for ahead-of-time "
+                    "compilation with tfcompile.")
+    parser.add_argument("weights", help="trained .h5 weights file")
+    parser.add_argument("out_dir", help="output directory")
+    parser.add_argument("--units_count", type=int, default=384)
+    parser.add_argument("--filter_count", type=int, default=768)
+    parser.add_argument("--block_len", type=int, default=1536)
+    parser.add_argument("--tfcompile", default="tfcompile",
+                        help="tfcompile binary, skipped if not found")
+    parser.add_argument("--target_triple",
+                        default="x86_64-pc-windows-msvc"
+                        if platform.system() == "Windows"
+                        else "x86_64-pc-linux",
+                        help="LLVM target of the compiled object")
+    args = parser.parse_args()
+
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    # stateless twin of the trained network, the states become feeds
+    model = Model(units_count=args.units_count,
+                  filter_count=args.filter_count,
+                  block_len=args.block_len)
+    model.build_stateless_model()
+    model.model.load_weights(args.weights)
+
+    # freeze weights into constants, XLA compiles them into the function
+    func = tf.function(lambda *inputs: model.model(list(inputs)))
+    concrete = func.get_concrete_function(
+        *[tf.TensorSpec(i.shape, tf.float32) for i in model.model.inputs])
+    frozen_func = convert_variables_to_constants_v2(concrete)
+
+    graph_path = os.path.join(args.out_dir, "noise_reduction_aot.pb")
+    config_path = os.path.join(args.out_dir,
+                               "noise_reduction_aot.config.pbtxt")
+    with open(graph_path, "wb") as graph:
+        graph.write(frozen_func.graph.as_graph_def().SerializeToString())
+    write_config(config_path, frozen_func)
+    write_header(os.path.join(args.out_dir, "noise_reduction_aot_config.h"),
+                 model)
+
+    tfcompile = shutil.which(args.tfcompile)
+    if tfcompile is None:
+        print("tfcompile not found, run it on %s and %s"
+              % (graph_path, config_path))
+        return
+
+    subprocess.run([
+        tfcompile,
+        "--graph=" + graph_path,
+        "--config=" + config_path,
+        "--cpp_class=rtnr_aot::NoiseReductionAot",
+        "--target_triple=" + args.target_triple,
+        "--out_header=" + os.path.join(args.out_dir, "noise_reduction_aot.h"),
+        "--out_object=" + os.path.join(args.out_dir, "noise_reduction_aot.o"),
+    ], check=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -5,48 +5,134 @@ from pystoi import stoi
 import matplotlib.pyplot as plt
 
 
-# Sample rate
-sr = 48000
-
-# Load the audio files
-audio_clean = librosa.load("", sr=sr)
-audio_noisy = librosa.load("", sr=sr)
-
-# resampling to 16k because pesq support only 8k or 16k audio
-audio_clean = librosa.resample(audio_clean, orig_sr=sr, target_sr=16000)
-audio_noisy = librosa.resample(audio_noisy, orig_sr=sr, target_sr=16000)
-
-# Calculate the metrics
-pesq_score = pesq(16000, audio_clean, audio_noisy, "wb")
-stoi_score = stoi(audio_clean, audio_noisy, 16000)
-
-# Print the results
-print("STOI: {:.2f}".format(stoi_score))
-print("PESQ: {:.2f}".format(pesq_score))
-
-
-# plot noisy and clean waveforms
-plt.figure(figsize=(12, 4))
-librosa.display.waveshow(audio_noisy, sr=sr)
-librosa.display.waveshow(audio_clean, sr=sr)
-plt.title("Audio waveform")
-plt.xlabel("Time (s)")
-plt.ylabel("Amplitude")
-plt.savefig("plot.png")
-
-# plot noisy spectrogram
-noisy = np.abs(librosa.stft(audio_noisy))
-plt.figure(figsize=(12, 5))
-librosa.display.specshow(
-    librosa.amplitude_to_db(noisy, ref=np.max),
-    y_axis="log", x_axis="time", sr=sr)
-plt.colorbar(format="%+2.0f dB")
-plt.title("Spectrogram")
-plt.savefig("spec_noisy.png")
-
-# plot clean spectrogram
-clean = np.abs(librosa.stft(audio_clean))
-librosa.display.specshow(
-    librosa.amplitude_to_db(clean, ref=np.max),
-    y_axis="log", x_axis="time", sr=sr)
-plt.savefig("spec_clean.png")
+EPS = np.finfo(np.float64).eps
+
+
+def snr(reference, processed):
+    """
+    Function to compute the signal-to-noise ratio.
+
+    Args:
+        reference (np.ndarray): clean reference
+        processed (np.ndarray): processed signal of the same length
+
+    Returns:
+        float: SNR in dB
+    """
+
+    reference = reference.astype(np.float64)
+    noise = reference - processed.astype(np.float64)
+    return 10 * np.log10((np.sum(reference ** 2) + EPS) /
+                         (np.sum(noise ** 2) + EPS))
+
+
+def seg_snr(reference, processed, sr, frame_len=0.03):
+    """
+    Function to compute the segmental SNR the way pysepm does: Hann windowed
+    frames with 75 % overlap, frame SNRs clamped to [-10, 35] dB and the last
+    frame left out.
+
+    Args:
+        reference (np.ndarray): clean reference
+        processed (np.ndarray): processed signal of the same length
+        sr (int): sample rate
+        frame_len (float): frame length in seconds
+
+    Returns:
+        float: mean frame SNR in dB
+    """
+
+    length = int(round(frame_len * sr))
+    hop = max(length // 4, 1)
+    window = 0.5 * (1 - np.cos(2 * np.pi * np.arange(1, length + 1) /
+                               (length + 1)))
+    starts = range(0, len(reference) - length + 1, hop)
+    reference = reference.astype(np.float64)
+    processed = processed.astype(np.float64)
+
+    values = []
+    for start in starts:
+        clean = window * reference[start:start + length]
+        noisy = window * processed[start:start + length]
+        signal = np.sum(clean ** 2)
+        noise = np.sum((clean - noisy) ** 2)
+        values.append(10 * np.log10(signal / (noise + EPS) + EPS))
+    values = np.clip(np.array(values[:-1]), -10, 35)
+    return float(np.mean(values)) if len(values) > 0 else float("nan")
+
+
+def si_sdr(reference, processed):
+    """
+    Function to compute the scale-invariant signal-to-distortion ratio of
+    the zero-mean signals.
+
+    Args:
+        reference (np.ndarray): clean reference
+        processed (np.ndarray): processed signal of the same length
+
+    Returns:
+        float: SI-SDR in dB
+    """
+
+    reference = reference.astype(np.float64)
+    processed = processed.astype(np.float64)
+    reference = reference - np.mean(reference)
+    processed = processed - np.mean(processed)
+    scale = np.dot(processed, reference) / (np.dot(reference, reference) +
+                                            EPS)
+    target = scale * reference
+    distortion = processed - target
+    return 10 * np.log10((np.sum(target ** 2) + EPS) /
+                         (np.sum(distortion ** 2) + EPS))
+
+
+def main():
+    # Sample rate
+    sr = 48000
+
+    # Load the audio files
+    audio_clean = librosa.load("", sr=sr)
+    audio_noisy = librosa.load("", sr=sr)
+
+    # resampling to 16k because pesq support only 8k or 16k audio
+    audio_clean = librosa.resample(audio_clean, orig_sr=sr, target_sr=16000)
+    audio_noisy = librosa.resample(audio_noisy, orig_sr=sr, target_sr=16000)
+
+    # Calculate the metrics
+    pesq_score = pesq(16000, audio_clean, audio_noisy, "wb")
+    stoi_score = stoi(audio_clean, audio_noisy, 16000)
+
+    # Print the results
+    print("STOI: {:.2f}".format(stoi_score))
+    print("PESQ: {:.2f}".format(pesq_score))
+
+
+    # plot noisy and clean waveforms
+    plt.figure(figsize=(12, 4))
+    librosa.display.waveshow(audio_noisy, sr=sr)
+    librosa.display.waveshow(audio_clean, sr=sr)
+    plt.title("Audio waveform")
+    plt.xlabel("Time (s)")
+    plt.ylabel("Amplitude")
+    plt.savefig("plot.png")
+
+    # plot noisy spectrogram
+    noisy = np.abs(librosa.stft(audio_noisy))
+    plt.figure(figsize=(12, 5))
+    librosa.display.specshow(
+        librosa.amplitude_to_db(noisy, ref=np.max),
+        y_axis="log", x_axis="time", sr=sr)
+    plt.colorbar(format="%+2.0f dB")
+    plt.title("Spectrogram")
+    plt.savefig("spec_noisy.png")
+
+    # plot clean spectrogram
+    clean = np.abs(librosa.stft(audio_clean))
+    librosa.display.specshow(
+        librosa.amplitude_to_db(clean, ref=np.max),
+        y_axis="log", x_axis="time", sr=sr)
+    plt.savefig("spec_clean.png")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+import argparse
+import csv
+import sys
+
+import soundfile as sf
+from pystoi import stoi
+
+from Metrics import seg_snr, si_sdr, snr
+
+
+# largest accepted difference per metric, dB for the ratios
+TOLERANCES = {"snr": 0.01, "seg_snr": 0.01, "si_sdr": 0.01, "stoi": 0.005}
+
+
+def python_scores(reference_path, processed_path):
+    """
+    Function to score one file pair with the Python metrics.
+
+    Args:
+        reference_path (str): clean reference file
+        processed_path (str): processed file
+
+    Returns:
+        dict: score per metric name
+    """
+
+    reference, sr = sf.read(reference_path, dtype="float32", always_2d=True)
+    processed, _ = sf.read(processed_path, dtype="float32", always_2d=True)
+    length = min(len(reference), len(processed))
+    reference = reference[:length, 0]
+    processed = processed[:length, 0]
+    return {
+        "snr": snr(reference, processed),
+        "seg_snr": seg_snr(reference, processed, sr),
+        "si_sdr": si_sdr(reference, processed),
+        "stoi": stoi(reference, processed, sr),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Check the scores of RTNR --score-list against the "
+                    "Python metrics.")
+    parser.add_argument("scores", help="CSV written by RTNR --score-list")
+    args = parser.parse_args()
+
+    failed = False
+    with open(args.scores) as scores:
+        for row in csv.DictReader(scores):
+            expected = python_scores(row["reference"], row["processed"])
+            for name, tolerance in TOLERANCES.items():
+                difference = abs(float(row[name]) - expected[name])
+                if difference > tolerance:
+                    failed = True
+                    print("FAIL %s %s: C++ %s, Python %.6f"
+                          % (row["processed"], name, row[name],
+                             expected[name]))
+
+    if failed:
+        sys.exit(1)
+    print("PASS")
+
+
+if __name__ == "__main__":
+    main()
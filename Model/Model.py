@@ -14,9 +14,17 @@ class Model():
     Model class
     """
 
-    def __init__(self):
+    def __init__(self, units_count=384, filter_count=768, block_len=1536,
+                 block_shift=384):
         """
-        Constructor of the Model class.
+        Constructor of the Model class. The size arguments select the model
+        variant; variants are listed in a manifest for the C++ auto-tuner.
+
+        Args:
+            units_count (int): LSTM units in each mask kernel layer
+            filter_count (int): filters count for finding features
+            block_len (int): one time domain frame size
+            block_shift (int): shift between consecutive frames
         """
 
         # initialising internal class members
@@ -31,20 +39,20 @@ class Model():
         self.activation = "selu"
 
         # mag mask kernel
-        self.units_count = 384
+        self.units_count = units_count
         self.layers_count = 2
 
         # one time domain frame size = 32 ms for 48k sr
-        self.block_len = 1536
+        self.block_len = block_len
         # shift for block_len = 8 ms for 48k sr
-        self.block_shift = 384
+        self.block_shift = block_shift
 
         self.dropout = 0.25
         self.learning_rate = 1e-3
         self.max_epochs = 200
 
         # filters count for finding features
-        self.filter_count = 768
+        self.filter_count = filter_count
 
         # epsilon
         self.eps = 1e-7
@@ -154,7 +162,8 @@ class Model():
         # return calculated iSTFT signals
         return ifft
 
-    def mask_kernel(self, layers_count, mask_size, x):
+    def mask_kernel(self, layers_count, mask_size, x, states=None,
+                    name=None):
         """
         Method for creating a mask in the separation kernel.
 
@@ -162,25 +171,43 @@ class Model():
             layers_count (int): LSTM layers count
             mask_size (int): size of output mask and Dense layer size
             x: signal magnitude
+            states (list): optional [h, c] input tensors for every LSTM layer;
+                when given, the layers keep no hidden state and take and
+                return their states explicitly
+            name (str): optional prefix of the layer names, so that weights
+                can be copied between models by layer name
 
         Returns:
-             : mask
+             : mask, followed by the list of [h, c] output tensors for every
+                LSTM layer when states are given
         """
 
+        states_out = []
+
         # creating layers_count LSTM layers
         for i in range(layers_count):
-            x = LSTM(self.units_count, return_sequences=True,
-                     stateful=True)(x)
+            layer_name = None if name is None else "%s_lstm_%d" % (name, i)
+            if states is None:
+                x = LSTM(self.units_count, return_sequences=True,
+                         stateful=True, name=layer_name)(x)
+            else:
+                x, h, c = LSTM(self.units_count, return_sequences=True,
+                               return_state=True,
+                               name=layer_name)(x, initial_state=states[i])
+                states_out.append([h, c])
 
             # dropout for regularization
             if i < (layers_count - 1):
                 x = Dropout(self.dropout)(x)
 
         # creating the mask
-        mask = Dense(mask_size)(x)
+        mask = Dense(mask_size,
+                     name=None if name is None else name + "_dense")(x)
         mask = Activation(self.activation)(mask)
 
-        return mask
+        if states is None:
+            return mask
+        return mask, states_out
 
     def build_model(self):
         """
@@ -226,6 +253,154 @@ class Model():
         # print model summary
         print(self.model.summary())
 
+    def state_inputs(self, kernel):
+        """
+        Method to create the [h, c] state inputs of every LSTM layer of one
+        separation kernel.
+
+        Args:
+            kernel (int): separation kernel number, 1 or 2
+
+        Returns:
+            list: one [h, c] input pair per LSTM layer
+        """
+
+        return [[Input(batch_shape=(1, self.units_count),
+                       name="state_%d_%d_%s" % (kernel, layer, part))
+                 for part in ("h", "c")]
+                for layer in range(self.layers_count)]
+
+    def stateless_stage_1(self, time_signal, states):
+        """
+        Method to apply the spectral mask kernel with explicit LSTM states.
+
+        Args:
+            time_signal: time signal block
+            states (list): [h, c] input tensors for every LSTM layer
+
+        Returns:
+            : time signal with the magnitude mask applied, followed by the
+                list of [h, c] output tensors
+        """
+
+        mag, phase = Lambda(self.fft_lambda_layer)(time_signal)
+
+        mask_1, states_out = self.mask_kernel(
+            self.layers_count,
+            (self.block_len // 2 + 1),
+            mag,
+            states,
+            "kernel_1"
+        )
+        processed_mag = Multiply()([mag, mask_1])
+        x = Lambda(self.ifft_lambda_layer)([processed_mag, phase])
+
+        return x, states_out
+
+    def stateless_stage_2(self, x, states):
+        """
+        Method to apply the learned feature mask kernel with explicit LSTM
+        states.
+
+        Args:
+            x: output of the first stage
+            states (list): [h, c] input tensors for every LSTM layer
+
+        Returns:
+            : processed time signal, followed by the list of [h, c] output
+                tensors
+        """
+
+        encoded_frames = Conv1D(self.filter_count, 1,
+                                strides=1, use_bias=False,
+                                name="encoder")(x)
+        mask_2, states_out = self.mask_kernel(
+            self.layers_count, self.filter_count, encoded_frames,
+            states, "kernel_2")
+        x = Multiply()([encoded_frames, mask_2])
+
+        x = Conv1D(self.block_len, 1, padding='causal',
+                   use_bias=False, name="main_output")(x)
+
+        return x, states_out
+
+    @staticmethod
+    def flatten_states(states):
+        """
+        Function to flatten [h, c] pairs into one list in graph order.
+
+        Args:
+            states (list): [h, c] pairs
+
+        Returns:
+            list: h and c tensors of every layer
+        """
+
+        return [state for pair in states for state in pair]
+
+    def build_stateless_model(self):
+        """
+        Method to build the model with explicit LSTM states. The network and
+        its weights are the same as in build_model, but every LSTM h and c
+        state is an extra input and output instead of hidden runtime state.
+        Inputs are the time signal followed by the states, outputs are the
+        processed signal followed by the new states in the same order.
+        """
+
+        time_signal = Input(batch_shape=(1, self.block_len), name="main_input")
+
+        # one [h, c] input pair per LSTM layer of both separation kernels
+        states_in_1 = self.state_inputs(1)
+        states_in_2 = self.state_inputs(2)
+
+        x, states_out_1 = self.stateless_stage_1(time_signal, states_in_1)
+        x, states_out_2 = self.stateless_stage_2(x, states_in_2)
+
+        self.model = tf.keras.Model(
+            inputs=[time_signal] + self.flatten_states(states_in_1) +
+            self.flatten_states(states_in_2),
+            outputs=[x] + self.flatten_states(states_out_1) +
+            self.flatten_states(states_out_2))
+
+    def build_split_models(self):
+        """
+        Method to build the two separation stages of the stateless model as
+        separate models, so that they can run on different cores. Both take a
+        [1, block_len] signal followed by their states, and return a signal
+        of the same shape followed by the new states. Weights are copied from
+        self.model, which must be the stateless model with loaded weights.
+
+        Returns:
+            list: the first and the second stage model
+        """
+
+        stages = []
+
+        time_signal = Input(batch_shape=(1, self.block_len), name="main_input")
+        states_in = self.state_inputs(1)
+        x, states_out = self.stateless_stage_1(time_signal, states_in)
+        x = Lambda(lambda frame: tf.squeeze(frame, axis=0))(x)
+        stages.append(tf.keras.Model(
+            inputs=[time_signal] + self.flatten_states(states_in),
+            outputs=[x] + self.flatten_states(states_out)))
+
+        time_signal = Input(batch_shape=(1, self.block_len), name="main_input")
+        states_in = self.state_inputs(2)
+        x = Lambda(lambda frame: tf.expand_dims(frame, axis=0))(time_signal)
+        x, states_out = self.stateless_stage_2(x, states_in)
+        stages.append(tf.keras.Model(
+            inputs=[time_signal] + self.flatten_states(states_in),
+            outputs=[x] + self.flatten_states(states_out)))
+
+        # the named layers hold every weight of the network
+        for stage in stages:
+            for layer in stage.layers:
+                if layer.weights:
+                    layer.set_weights(
+                        self.model.get_layer(layer.name).get_weights())
+
+        return stages
+
     def compile_model(self):
         """
         Method to compile the model.
@@ -255,6 +430,74 @@ class Model():
         # save model
         self.model.save(target_name, save_format="tf")
 
+    @staticmethod
+    def save_with_state_signature(model, target_name):
+        """
+        Function for saving a model with explicit LSTM states. The serving
+        signature takes main_input and state_00 to state_NN and returns
+        output_00 (the signal) followed by the new states, so that the C++
+        side can feed and fetch them by index.
+
+        Args:
+            model: model with the signal and the states as inputs and outputs
+            target_name (str): saved model name
+        """
+
+        # zero padded names keep the signature order equal to the graph order
+        specs = [tf.TensorSpec(model.inputs[0].shape, tf.float32,
+                               name="main_input")]
+        specs += [tf.TensorSpec(state.shape, tf.float32,
+                                name="state_%02d" % i)
+                  for i, state in enumerate(model.inputs[1:])]
+
+        @tf.function(input_signature=specs)
+        def serve(*inputs):
+            outputs = model(list(inputs))
+            return {"output_%02d" % i: output
+                    for i, output in enumerate(outputs)}
+
+        model.save(target_name, save_format="tf", signatures=serve)
+
+    def save_stateless_model(self, weights_file_path, target_name):
+        """
+        Method for saving the model with explicit LSTM states.
+
+        Args:
+            weights_file_path (str): path to weight file
+            target_name (str): saved model name
+        """
+
+        # build model
+        self.build_stateless_model()
+
+        # load weights, the layers are the same as in the stateful model
+        self.model.load_weights(weights_file_path)
+
+        # save model
+        self.save_with_state_signature(self.model, target_name)
+
+    def save_split_model(self, weights_file_path, target_name):
+        """
+        Method for saving the two separation stages as the stage_1 and
+        stage_2 models of one directory, which the C++ side runs pipelined
+        on two cores.
+
+        Args:
+            weights_file_path (str): path to weight file
+            target_name (str): saved model directory name
+        """
+
+        # build model
+        self.build_stateless_model()
+
+        # load weights, the layers are the same as in the stateful model
+        self.model.load_weights(weights_file_path)
+
+        # save models
+        for i, stage in enumerate(self.build_split_models()):
+            self.save_with_state_signature(
+                stage, os.path.join(target_name, "stage_%d" % (i + 1)))
+
     def train_model(self, run_name,
                     path_train_noisy, path_train_clean,
                     path_valid_noisy, path_valid_clean):
@@ -331,6 +574,10 @@ class Model():
 
         # save model
         self.save_model(save_path + run_name + ".h5", save_path + run_name)
+        self.save_stateless_model(save_path + run_name + ".h5",
+                                  save_path + run_name + "_stateless")
+        self.save_split_model(save_path + run_name + ".h5",
+                              save_path + run_name + "_split")
 
         # clear session
         tf.keras.backend.clear_session()
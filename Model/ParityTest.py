@@ -0,0 +1,75 @@
+import argparse
+import sys
+import time
+
+import numpy as np
+import soundfile as sf
+import tensorflow as tf
+
+from RealTimeTest import denoise
+
+
+def compare(reference, candidate):
+    """
+    Function to measure how far the C++ output is from the Python reference.
+
+    Args:
+        reference (np.ndarray): output of RealTimeTest.denoise
+        candidate (np.ndarray): output of the offline neural mode
+
+    Returns:
+        tuple: maximum absolute difference and signal to difference ratio
+        in dB
+    """
+
+    length = min(len(reference), len(candidate))
+    difference = reference[:length] - candidate[:length]
+    max_error = float(np.max(np.abs(difference))) if length > 0 else 0.0
+    signal = np.sum(reference[:length] ** 2)
+    noise = np.sum(difference ** 2)
+    if noise == 0:
+        return max_error, float("inf")
+    return max_error, 10 * np.log10(signal / noise)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Check that the offline neural mode of the C++ "
+                    "application matches RealTimeTest.py.")
+    parser.add_argument("model",
+                        help="SavedModel directory, stateful or with "
+                             "explicit states")
+    parser.add_argument("noisy", help="noisy input, mono 48k sr")
+    parser.add_argument("cpp_output",
+                        help="output of RTNR --denoise-file for the input")
+    parser.add_argument("--min_snr", type=float, default=60.0,
+                        help="lowest accepted signal to difference ratio "
+                             "in dB")
+    args = parser.parse_args()
+
+    audio, sr = sf.read(args.noisy, dtype="float32")
+    if sr != 48000:
+        raise ValueError("Sampling rates don't match the specifications.")
+    candidate, candidate_sr = sf.read(args.cpp_output, dtype="float32")
+    if candidate_sr != sr or len(candidate) != len(audio):
+        print("FAIL: output has %d samples at %d Hz, expected %d at %d Hz"
+              % (len(candidate), candidate_sr, len(audio), sr))
+        sys.exit(1)
+
+    infer = tf.saved_model.load(args.model).signatures["serving_default"]
+    start = time.perf_counter()
+    reference = denoise(infer, audio)
+    elapsed = time.perf_counter() - start
+    print("Python real-time factor: %.4f" % (elapsed / (len(audio) / sr)))
+
+    max_error, snr = compare(reference, candidate)
+    print("Max abs difference: %.3g, signal to difference: %.1f dB"
+          % (max_error, snr))
+    if snr < args.min_snr:
+        print("FAIL: below %.1f dB" % args.min_snr)
+        sys.exit(1)
+    print("PASS")
+
+
+if __name__ == "__main__":
+    main()
@@ -8,53 +8,92 @@ block_len = 1536
 # shift for block_len = 8 ms for 48k sr
 block_shift = 384
 
-# load model
-model = tf.saved_model.load("")
-# inference model
-infer = model.signatures["serving_default"]
 
-# load audio
-audio, sr = sf.read("")
-
-# check sampling rate
-if sr != 48000:
-    raise ValueError("Sampling rates don't match the specifications.")
-
-# output audio init
-out_file = np.zeros((len(audio)))
-
-# create input and output buffers
-input_buffer = np.zeros((block_len))
-output_buffer = np.zeros((block_len))
-
-# calculate number of blocks
-num_blocks = (audio.shape[0] - (block_len-block_shift)) // block_shift
-
-# iterate over the number of blocks
-for i in range(num_blocks):
-    # shift values and write to the buffer
-    input_buffer[:-block_shift] = input_buffer[block_shift:]
-    input_buffer[-block_shift:] = \
-        audio[i * block_shift: (i * block_shift) + block_shift]
-
-    # create a batch dimension of one
-    in_block = np.expand_dims(input_buffer, axis=0).astype('float32')
-
-    # process one block
-    out_block = infer(tf.constant(in_block))["conv1d_3"]
-
-    # shift values and write to buffer
-    output_buffer[:-block_shift] = output_buffer[block_shift:]
-    output_buffer[-block_shift:] = np.zeros((block_shift))
-    output_buffer += np.squeeze(out_block)
-
-    # devide signal values by 2
-    output_buffer[:] = [x / 2 for x in output_buffer]
-
-    # write block to output file
-    out_file[i * block_shift:
-             (i * block_shift) + block_shift] = output_buffer[:block_shift]
-
-
-# write result to .wav file
-sf.write("", out_file, sr)
+def denoise(infer, audio):
+    """
+    Function to denoise audio block by block the way the real-time stream
+    does. The offline neural mode of ProcessAudioFile mirrors it, so the two
+    can be compared with ParityTest.py.
+
+    Both exports are supported: the stateful one returns the signal as
+    conv1d_3, the one with explicit states (save_stateless_model) takes
+    state_00 to state_NN and returns output_00 and the new states, which
+    start at zero and are carried from block to block.
+
+    Args:
+        infer: serving_default signature of the loaded model
+        audio (np.ndarray): mono audio at 48k sr
+
+    Returns:
+        np.ndarray: denoised audio, as long as the input
+    """
+
+    # output audio init
+    out_file = np.zeros((len(audio)))
+
+    # create input and output buffers
+    input_buffer = np.zeros((block_len))
+    output_buffer = np.zeros((block_len))
+
+    # explicit LSTM states of the model, empty for a stateful export
+    specs = infer.structured_input_signature[1]
+    state_names = sorted(name for name in specs if name.startswith("state_"))
+    states = {name: tf.zeros([1 if dim is None else dim
+                              for dim in specs[name].shape], tf.float32)
+              for name in state_names}
+
+    # calculate number of blocks
+    num_blocks = (audio.shape[0] - (block_len-block_shift)) // block_shift
+
+    # iterate over the number of blocks
+    for i in range(num_blocks):
+        # shift values and write to the buffer
+        input_buffer[:-block_shift] = input_buffer[block_shift:]
+        input_buffer[-block_shift:] = \
+            audio[i * block_shift: (i * block_shift) + block_shift]
+
+        # create a batch dimension of one
+        in_block = np.expand_dims(input_buffer, axis=0).astype('float32')
+
+        # process one block
+        if states:
+            outputs = infer(main_input=tf.constant(in_block), **states)
+            out_block = outputs["output_00"]
+            # state_NN comes back as output_NN+1
+            for j, name in enumerate(state_names):
+                states[name] = outputs["output_%02d" % (j + 1)]
+        else:
+            out_block = infer(tf.constant(in_block))["conv1d_3"]
+
+        # shift values and write to buffer
+        output_buffer[:-block_shift] = output_buffer[block_shift:]
+        output_buffer[-block_shift:] = np.zeros((block_shift))
+        output_buffer += np.squeeze(out_block)
+
+        # devide signal values by 2
+        output_buffer[:] = [x / 2 for x in output_buffer]
+
+        # write block to output file
+        out_file[i * block_shift:
+                 (i * block_shift) + block_shift] = output_buffer[:block_shift]
+
+    return out_file
+
+
+if __name__ == "__main__":
+    # load model
+    model = tf.saved_model.load("")
+    # inference model
+    infer = model.signatures["serving_default"]
+
+    # load audio
+    audio, sr = sf.read("")
+
+    # check sampling rate
+    if sr != 48000:
+        raise ValueError("Sampling rates don't match the specifications.")
+
+    out_file = denoise(infer, audio)
+
+    # write result to .wav file
+    sf.write("", out_file, sr)
@@ -0,0 +1,427 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/DSP/SlidingStft.h"
+#include "../src/Filters/KalmanBank.h"
+#include "../src/Inference/ModelSwitcher.h"
+#include "../src/Pipeline/Stages.h"
+#include "../src/SharedAudio/SharedAudioReader.h"
+#include "../src/SharedAudio/SharedAudioSink.h"
+#include "../src/Stream/BlockAdapter.h"
+#include "../src/Util/Log.h"
+#include "../src/Util/MpscRing.h"
+#include "../src/Util/Arena.h"
+
+namespace
+{
+/// @brief Number of frames in one test block.
+constexpr std::size_t kBlockLen = 64;
+/// @brief Longest accepted load of a model that only fills a block.
+constexpr double kMaxLoadSeconds = 1.0;
+/// @brief Longest accepted time from publishing a model to its adoption;
+/// the audio thread of the tests runs a block every millisecond.
+constexpr double kMaxAdoptSeconds = 0.05;
+/// @brief Most blocks accepted before a swap is adopted.
+constexpr int kMaxBlocksBeforeAdoption = 1000;
+
+/// @brief Model that outputs a constant and records the thread that frees
+/// it.
+class ConstantModel : public InferenceModel
+{
+  private:
+    /// @brief The output block.
+    std::vector<float> mOutput;
+    /// @brief Receives the id of the thread running the destructor.
+    std::atomic<std::thread::id>* mFreedOn;
+    /// @brief Latency reported to the stream in blocks.
+    std::size_t mLatencyBlocks;
+
+  public:
+    ConstantModel(float value, std::atomic<std::thread::id>* freedOn,
+                  std::size_t latencyBlocks = 0) :
+        mOutput(kBlockLen, value), mFreedOn(freedOn),
+        mLatencyBlocks(latencyBlocks)
+    {}
+
+    ~ConstantModel() override
+    {
+        if (mFreedOn != nullptr) {
+            mFreedOn->store(std::this_thread::get_id());
+        }
+    }
+
+    const char* name() const override { return "constant"; }
+    std::size_t blockSize() const override { return kBlockLen; }
+    std::size_t latencyBlocks() const override { return mLatencyBlocks; }
+    const float* infer(const float* in, std::size_t frames) override
+    {
+        (void)in;
+        (void)frames;
+        return mOutput.data();
+    }
+};
+
+/// @brief Formats a log record and strips the time and level prefix.
+template <typename... Args>
+std::string formatMessage(const char* format, const Args&... args)
+{
+    std::string line =
+        Log::format(Log::makeRecord(LogLevel::Info, 0, format, args...));
+    return line.substr(line.find(": ") + 2);
+}
+} // namespace
+
+TEST(ModelSwap, FadesOverOneBlockAndFreesOffTheAudioThread)
+{
+    std::atomic<std::thread::id> freedOn{};
+    ModelSwitcher models;
+    models.setModel(std::make_unique<ConstantModel>(1.0f, &freedOn));
+
+    ModelStage stage(models, kBlockLen);
+    Arena arena(stage.arenaBytes(kBlockLen) +
+                2 * Arena::bytesFor<float>(kBlockLen));
+    stage.prepare(kBlockLen, arena);
+    float* in = arena.allocate<float>(kBlockLen);
+    float* out = arena.allocate<float>(kBlockLen);
+    std::fill(in, in + kBlockLen, 0.0f);
+
+    EXPECT_EQ(stage.process(in, out, kBlockLen)[0], 1.0f);
+    ASSERT_TRUE(models.swapAsync(
+        []() { return std::make_unique<ConstantModel>(2.0f, nullptr); }, 0));
+
+    // this thread plays the audio thread, blocks run until the adoption
+    const float* result = nullptr;
+    int blocksBeforeAdoption = -1;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        result = stage.process(in, out, kBlockLen);
+        ++blocksBeforeAdoption;
+    } while (result[0] == 1.0f && std::chrono::steady_clock::now() < deadline);
+    EXPECT_LT(blocksBeforeAdoption, kMaxBlocksBeforeAdoption);
+
+    // the adoption block ramps from the old to the new model
+    ASSERT_GT(result[0], 1.0f);
+    EXPECT_LT(result[0], 1.1f);
+    EXPECT_GT(result[kBlockLen - 1], 1.9f);
+    EXPECT_LT(result[kBlockLen - 1], 2.0f);
+    for (std::size_t i = 1; i < kBlockLen; ++i) {
+        EXPECT_GT(result[i], result[i - 1]);
+    }
+
+    // the next block is the new model alone
+    result = stage.process(in, out, kBlockLen);
+    for (std::size_t i = 0; i < kBlockLen; ++i) {
+        EXPECT_EQ(result[i], 2.0f);
+    }
+
+    while (models.getStats().busy &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ModelSwapStats stats = models.getStats();
+    EXPECT_EQ(stats.swaps, 1u);
+    EXPECT_LT(stats.loadSeconds, kMaxLoadSeconds);
+    EXPECT_GE(stats.adoptSeconds, 0.0);
+    EXPECT_LT(stats.adoptSeconds, kMaxAdoptSeconds);
+    // the fade turns the step of 1 between the models into a ramp
+    EXPECT_GT(stats.boundaryStep, 0.0);
+    EXPECT_LT(stats.boundaryStep, 1.0 / kBlockLen);
+    EXPECT_NE(freedOn.load(), std::thread::id());
+    EXPECT_NE(freedOn.load(), std::this_thread::get_id());
+}
+
+TEST(ModelSwap, RejectsAModelWithAnotherLatency)
+{
+    ModelSwitcher models;
+    models.setModel(std::make_unique<ConstantModel>(1.0f, nullptr));
+
+    ModelStage stage(models, kBlockLen);
+    Arena arena(stage.arenaBytes(kBlockLen) +
+                2 * Arena::bytesFor<float>(kBlockLen));
+    stage.prepare(kBlockLen, arena);
+    float* in = arena.allocate<float>(kBlockLen);
+    float* out = arena.allocate<float>(kBlockLen);
+    std::fill(in, in + kBlockLen, 0.0f);
+
+    // a split model would need longer delays than the stream was built for
+    ASSERT_TRUE(models.swapAsync(
+        []() { return std::make_unique<ConstantModel>(2.0f, nullptr, 1); },
+        0));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (models.getStats().busy &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(stage.process(in, out, kBlockLen)[0], 1.0f);
+    EXPECT_EQ(models.getStats().swaps, 0u);
+}
+
+TEST(BlockAdapter, DelaysTheProcessedInputByItsLatency)
+{
+    constexpr std::size_t kHop = 1536;
+    const std::size_t callbackSizes[] = {1, 37, 256, 1535, 4096};
+
+    BlockAdapter adapter(kHop);
+    std::size_t total = 0;
+    for (int round = 0; round < 3; ++round) {
+        for (std::size_t frames : callbackSizes) {
+            total += frames;
+        }
+    }
+    std::vector<float> input(total);
+    for (std::size_t i = 0; i < total; ++i) {
+        input[i] = static_cast<float>(i + 1);
+    }
+    std::vector<float> output(total, -1.0f);
+
+    // every hop is doubled, so the output shows which hop produced it
+    std::size_t hops = 0;
+    auto processHop = [&hops](const float* in, float* out) {
+        for (std::size_t i = 0; i < kHop; ++i) {
+            out[i] = 2 * in[i];
+        }
+        ++hops;
+    };
+
+    std::size_t offset = 0;
+    for (int round = 0; round < 3; ++round) {
+        for (std::size_t frames : callbackSizes) {
+            adapter.process(&input[offset], &output[offset], frames,
+                            processHop);
+            offset += frames;
+            // a hop runs in the callback that completes it, and only once
+            EXPECT_EQ(hops, offset / kHop);
+        }
+    }
+
+    ASSERT_EQ(adapter.latency(), kHop);
+    EXPECT_EQ(hops, total / kHop);
+    for (std::size_t i = 0; i < total; ++i) {
+        float expected = i < kHop ? 0.0f : 2 * input[i - kHop];
+        ASSERT_EQ(output[i], expected) << "frame " << i;
+    }
+}
+
+TEST(KalmanBank, AvxBuildMatchesTheBaselineBitForBit)
+{
+    // a bin count of the spectral filters, not a multiple of the lanes
+    constexpr std::size_t kBins = 257;
+    constexpr int kFrames = 200;
+
+    KalmanBank baseline(kBins);
+    KalmanBank avx(kBins);
+    baseline.setAvx(false);
+    if (!avx.setAvx(true)) {
+        GTEST_SKIP() << "no AVX on this processor";
+    }
+    ASSERT_EQ(baseline.padded(), avx.padded());
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> magnitude(0.0f, 4.0f);
+    std::uniform_real_distribution<float> noise(0.01f, 1.0f);
+    std::vector<float> z(baseline.padded());
+    std::vector<float> r(baseline.padded());
+    std::vector<float> baselineOut(baseline.padded());
+    std::vector<float> avxOut(avx.padded());
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (std::size_t i = 0; i < z.size(); ++i) {
+            // jumps now and then so the trackers also follow steps
+            z[i] = magnitude(random) * (frame % 50 < 25 ? 1.0f : 8.0f);
+            r[i] = noise(random);
+        }
+        baseline.update(z.data(), r.data(), baselineOut.data());
+        avx.update(z.data(), r.data(), avxOut.data());
+        for (std::size_t i = 0; i < kBins; ++i) {
+            ASSERT_EQ(baselineOut[i], avxOut[i])
+                << "frame " << frame << ", bin " << i;
+        }
+    }
+}
+
+TEST(SlidingStft, UnitGainReconstructsTheInputAfterItsLatency)
+{
+    // the synthesis scale depends on the overlap, so check several
+    const std::size_t configurations[][2] = {{1536, 384}, {1536, 768},
+                                             {480, 120}};
+    for (const auto& configuration : configurations) {
+        SlidingStft stft(configuration[0], configuration[1]);
+        std::size_t latency = stft.latency();
+        std::size_t total = 6 * configuration[0] + 123;
+
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+        std::vector<float> input(total);
+        for (float& value : input) {
+            value = sample(random);
+        }
+        std::vector<float> output(total);
+
+        // odd chunks, so hops complete in the middle of calls
+        std::size_t offset = 0;
+        std::size_t chunk = 1;
+        while (offset < total) {
+            std::size_t frames = std::min(chunk, total - offset);
+            stft.process(&input[offset], &output[offset], frames,
+                         [](std::complex<float>* spectrum) { (void)spectrum; });
+            offset += frames;
+            chunk = chunk * 7 % 1000 + 1;
+        }
+
+        for (std::size_t i = 0; i < total; ++i) {
+            float expected = i < latency ? 0.0f : input[i - latency];
+            ASSERT_NEAR(output[i], expected, 1e-4f)
+                << configuration[0] << "/" << configuration[1] << ", sample "
+                << i;
+        }
+    }
+}
+
+TEST(Log, ReplacesLengthModifiersToMatchTheStoredType)
+{
+    std::size_t frames = 42;
+    long long offset = -7;
+    short small = 3;
+    EXPECT_EQ(formatMessage("%zu frames, %lld, %hd, %5.2lf", frames, offset,
+                            small, 3.14159),
+              "42 frames, -7, 3,  3.14");
+    EXPECT_EQ(formatMessage("%x %c %e", 255u, 'A', 1.5f), "ff A 1.500000e+00");
+    // an integer for a floating point conversion and the other way round
+    EXPECT_EQ(formatMessage("%.1f %d", 2, 2.9), "2.0 2");
+}
+
+TEST(Log, FormatsNumbersForStringConversions)
+{
+    EXPECT_EQ(formatMessage("%s %s %s", 5, 2.5, 7u), "5 2.5 7");
+    std::string name = "stage";
+    EXPECT_EQ(formatMessage("%s and %s", name, "tier"), "stage and tier");
+}
+
+TEST(Log, CutsStringsAtTheTextBuffer)
+{
+    std::string first(100, 'a');
+    std::string second(100, 'b');
+    LogRecord record =
+        Log::makeRecord(LogLevel::Info, 0, "%s|%s|%s", first, second, "c");
+    std::string line = Log::format(record);
+    std::string message = line.substr(line.find(": ") + 2);
+
+    // the first string fits, the second gets the rest and the third nothing
+    std::size_t room = LogRecord::kTextBytes - (first.size() + 1) - 1;
+    EXPECT_EQ(message, first + "|" + std::string(room, 'b') + "|");
+
+    std::string longest(2 * LogRecord::kTextBytes, 'x');
+    EXPECT_EQ(formatMessage("%s", longest),
+              std::string(LogRecord::kTextBytes - 1, 'x'));
+}
+
+TEST(Log, KeepsLiteralPercentsAndUnmatchedConversions)
+{
+    EXPECT_EQ(formatMessage("100%% done, %d%%", 5), "100% done, 5%");
+    EXPECT_EQ(formatMessage("%d and %d", 1), "1 and %d");
+    EXPECT_EQ(formatMessage("trailing %"), "trailing %");
+}
+
+TEST(Log, ReportsSuppressedRecords)
+{
+    std::string line = Log::format(
+        Log::makeRecord(LogLevel::Warning, 3, "Dropout, flags 0x%lx", 4ul));
+    EXPECT_NE(line.find("warning: "), std::string::npos);
+    EXPECT_EQ(line.substr(line.find(": ") + 2),
+              "Dropout, flags 0x4 (3 similar suppressed)");
+    line = Log::format(Log::makeRecord(LogLevel::Info, 0, "quiet"));
+    EXPECT_EQ(line.find("suppressed"), std::string::npos);
+}
+
+TEST(Log, DropsAndCountsRecordsWhenTheRingIsFull)
+{
+    MpscRing<int> ring(5);
+    ASSERT_EQ(ring.capacity(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(8));
+
+    // a popped slot is free again, the order is kept over the wrap
+    int value = -1;
+    ASSERT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(ring.push(9));
+    EXPECT_FALSE(ring.push(10));
+    for (int expected : {1, 2, 3, 4, 5, 6, 7, 9}) {
+        ASSERT_TRUE(ring.pop(value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_FALSE(ring.pop(value));
+
+    // without a writer the log ring fills up and counts what it drops
+    std::uint64_t before = Log::dropped();
+    for (int i = 0; i < 10000; ++i) {
+        Log::write(LogLevel::Error, "record %d", i);
+    }
+    EXPECT_GT(Log::dropped(), before);
+}
+
+TEST(SharedAudio, SkipsOverrunBlocksAndDetectsTornReads)
+{
+    constexpr std::size_t kFrames = 16;
+    constexpr std::size_t kBlocks = 8;
+    std::string name = "rtnr_test_" + std::to_string(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+
+    SharedAudioSink sink;
+    ASSERT_TRUE(sink.open(name, 48000, kFrames, kBlocks));
+    SharedAudioReader reader;
+    ASSERT_TRUE(reader.open(name));
+
+    // every sample of a block holds its sequence number
+    std::vector<float> block(kFrames);
+    std::uint64_t next = 0;
+    auto publish = [&](std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i, ++next) {
+            std::fill(block.begin(), block.end(), static_cast<float>(next));
+            sink.publish(block.data(), kFrames);
+        }
+    };
+
+    // more than the ring between two reads, the reader restarts at the
+    // oldest block the writer is not about to overwrite
+    publish(2 * kBlocks + 4);
+    std::uint64_t oldest = next - kBlocks + 1;
+    std::uint64_t sequence = 0;
+    const float* samples = reader.acquire(sequence);
+    ASSERT_NE(samples, nullptr);
+    EXPECT_EQ(sequence, oldest);
+    EXPECT_EQ(reader.overruns(), oldest);
+    for (; samples != nullptr; samples = reader.acquire(sequence)) {
+        EXPECT_EQ(samples[0], static_cast<float>(sequence));
+        EXPECT_EQ(samples[kFrames - 1], static_cast<float>(sequence));
+        EXPECT_TRUE(reader.release());
+    }
+    EXPECT_EQ(reader.overruns(), oldest);
+    EXPECT_EQ(reader.lag(), 0u);
+
+    // a block overwritten while it is read is never reported intact
+    publish(1);
+    samples = reader.acquire(sequence);
+    ASSERT_NE(samples, nullptr);
+    EXPECT_EQ(sequence, next - 1);
+    publish(kBlocks);
+    EXPECT_NE(samples[0], static_cast<float>(sequence));
+    EXPECT_FALSE(reader.release());
+    EXPECT_EQ(reader.overruns(), oldest + 1);
+
+    // the count reaches the writer through the position entry
+    EXPECT_EQ(sink.getStats().readerOverruns, oldest + 1);
+
+    reader.close();
+    sink.close();
+}
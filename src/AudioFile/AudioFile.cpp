@@ -1,7 +1,29 @@
 #include "AudioFile.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "../DSP/Kernels.h"
+#include "../Inference/ModelFactory.h"
+
+namespace
+{
+/// @brief Frames of the model window, 32 ms at 48 kHz.
+constexpr std::size_t kNeuralBlockLen = 1536;
+/// @brief Frames the window slides per model call, 8 ms at 48 kHz.
+constexpr std::size_t kNeuralBlockShift = 384;
+/// @brief Shifts read and written per file access.
+constexpr std::size_t kNeuralChunkShifts = 256;
+/// @brief Sample rate the model was trained for.
+constexpr int kNeuralSampleRate = 48000;
+} // namespace
+
 ProcessAudioFile::ProcessAudioFile(string in_filename, string out_filename) :
-    m_in_filename(in_filename), m_out_filename(out_filename)
+    m_in_filename(in_filename), m_out_filename(out_filename), m_in_file(NULL),
+    m_out_file(NULL)
 {
     if (m_out_filename == "") {
         m_out_filename = m_in_filename;
@@ -11,121 +33,268 @@ ProcessAudioFile::ProcessAudioFile(string in_filename, string out_filename) :
     }
 }
 
-void ProcessAudioFile::open()
+bool ProcessAudioFile::open()
 {
     m_in_file = sf_open(m_in_filename.c_str(), SFM_READ, &m_in_sf_info);
     if (m_in_file == NULL) {
-        // TODO: error handling
-        printf("Error opening input file %s: %s\n", m_in_filename,
-               sf_strerror(m_in_file));
-        return;
+        Log::write(LogLevel::Error, "Error opening input file %s: %s",
+                   m_in_filename, sf_strerror(m_in_file));
+        return false;
     }
 
     m_out_sf_info = m_in_sf_info;
     m_out_file = sf_open(m_out_filename.c_str(), SFM_WRITE, &m_out_sf_info);
     if (m_out_file == NULL) {
-        // TODO: error handling
-        printf("Error opening output file %s: %s\n", m_out_filename,
-               sf_strerror(m_out_file));
-        close();
-        return;
-    }
-}
-
-void ProcessAudioFile::read()
-{
-    m_total_frames = m_in_sf_info.frames * m_in_sf_info.channels;
-    m_in_audio_data.resize(m_total_frames);
-    m_out_audio_data.resize(m_total_frames);
-    sf_count_t num_read =
-        sf_read_float(m_in_file, &m_in_audio_data[0], m_total_frames);
-    if (num_read != m_total_frames) {
-        // TODO: error handling
-        printf("Error reading input file: %s\n", sf_strerror(m_in_file));
+        Log::write(LogLevel::Error, "Error opening output file %s: %s",
+                   m_out_filename, sf_strerror(m_out_file));
         close();
-        return;
+        return false;
     }
-}
 
-void ProcessAudioFile::write()
-{
-    m_out_sf_info = m_in_sf_info;
-    sf_count_t num_written =
-        sf_write_float(m_out_file, &m_out_audio_data[0], m_total_frames);
-    if (num_written != m_total_frames) {
-        // TODO: error handling
-        printf("Error writing output file: %s\n", sf_strerror(m_out_file));
-    }
+    return true;
 }
 
 void ProcessAudioFile::close()
 {
     sf_close(m_in_file);
     sf_close(m_out_file);
+    m_in_file = NULL;
+    m_out_file = NULL;
 }
 
-void ProcessAudioFile::kalman(unsigned long framesPerBuffer)
+bool ProcessAudioFile::run(Pipeline& pipeline, unsigned long framesPerBuffer)
 {
-    open();
-    read();
+    if (!open()) {
+        return false;
+    }
 
-    double Q = 0.01;
-    double R = 0.1;
-    Kalman filter(Q, R);
+    // the input and output chunks are reserved next to the pipeline scratch
+    pipeline.build(framesPerBuffer,
+                   2 * Arena::bytesFor<float>(framesPerBuffer));
+    float* in = pipeline.arena().allocate<float>(framesPerBuffer);
+    float* out = pipeline.arena().allocate<float>(framesPerBuffer);
 
-    for (int i = 0; i < std::ceil(m_total_frames / framesPerBuffer); i++) {
-        if (i * framesPerBuffer > m_total_frames) {
-            for (int j = i * framesPerBuffer; j < m_total_frames; j++) {
-                double x_hat = filter.update(m_in_audio_data[j]);
-                m_out_audio_data[j] = x_hat;
-            }
-        } else {
-            for (int j = i * framesPerBuffer; j < (i + 1) * framesPerBuffer;
-                 j++) {
-                double x_hat = filter.update(m_in_audio_data[j]);
-                m_out_audio_data[j] = x_hat;
+    // a pipeline with latency is flushed with silence and its lead dropped,
+    // so the output lines up with the input
+    std::size_t skip = pipeline.latency();
+    std::size_t flush = skip;
+
+    // run the pipeline chunk by chunk, including the last partial chunk
+    bool ok = true;
+    while (true) {
+        sf_count_t num_read;
+        {
+            RTNR_TRACE_SCOPE("file_read");
+            num_read = sf_read_float(m_in_file, in, framesPerBuffer);
+        }
+        if (num_read <= 0) {
+            if (flush == 0) {
+                break;
             }
+            num_read = static_cast<sf_count_t>(
+                std::min<std::size_t>(flush, framesPerBuffer));
+            std::fill(in, in + num_read, 0.0f);
+            flush -= static_cast<std::size_t>(num_read);
+        }
+
+        pipeline.run(in, out, num_read);
+
+        auto dropped = static_cast<sf_count_t>(
+            std::min(skip, static_cast<std::size_t>(num_read)));
+        skip -= static_cast<std::size_t>(dropped);
+        sf_count_t num_written;
+        {
+            RTNR_TRACE_SCOPE("file_write");
+            num_written = sf_write_float(m_out_file, out + dropped,
+                                         num_read - dropped);
+        }
+        if (num_written != num_read - dropped) {
+            Log::write(LogLevel::Error, "Error writing output file: %s",
+                       sf_strerror(m_out_file));
+            ok = false;
+            break;
         }
     }
 
-    write();
+    Log::write(LogLevel::Info, "Arena high-water mark: %zu of %zu bytes",
+               pipeline.arena().highWaterMark(), pipeline.arena().capacity());
+
     close();
+    return ok;
+}
+
+void ProcessAudioFile::kalman(unsigned long framesPerBuffer)
+{
+    double Q = 0.01;
+    double R = 0.1;
+
+    Pipeline pipeline;
+    pipeline.add<KalmanStage>(Q, R);
+    run(pipeline, framesPerBuffer);
 }
 
 void ProcessAudioFile::adaptive_kalman(unsigned long framesPerBuffer)
 {
-    open();
-    read();
+    Pipeline pipeline;
+    pipeline.add<AdaptiveKalmanStage>(0, 1, 0.01, 0.1, 0.95);
+    run(pipeline, framesPerBuffer);
+}
 
-    AdaptiveKalmanFilter filter(0, 1, 0.01, 0.1, 0.95);
+void ProcessAudioFile::spectral_kalman(unsigned long framesPerBuffer)
+{
+    Pipeline pipeline;
+    pipeline.add<SpectralKalmanStage>(kNeuralSampleRate);
+    run(pipeline, framesPerBuffer);
+}
 
-    for (int i = 0; i < std::ceil(m_total_frames / framesPerBuffer); i++) {
-        if (i * framesPerBuffer > m_total_frames) {
-            for (int j = i * framesPerBuffer; j < m_total_frames; j++) {
-                double x_hat = filter.update(m_in_audio_data[j]);
-                m_out_audio_data[j] = x_hat;
-            }
-        } else {
-            for (int j = i * framesPerBuffer; j < (i + 1) * framesPerBuffer;
-                 j++) {
-                double x_hat = filter.update(m_in_audio_data[j]);
-                m_out_audio_data[j] = x_hat;
-            }
-        }
+void ProcessAudioFile::noise_gate(float threshold)
+{
+    NoiseGate ng(threshold);
+
+    Pipeline pipeline;
+    pipeline.add<GateStage>(ng);
+    run(pipeline, 1536);
+}
+
+double ProcessAudioFile::spectral(unsigned long framesPerBuffer)
+{
+    auto start = std::chrono::steady_clock::now();
+    // the filter frames match the model windows at the model rate
+    Pipeline pipeline;
+    pipeline.add<SpectralStage>(kNeuralSampleRate);
+    if (!run(pipeline, framesPerBuffer)) {
+        return -1;
     }
 
-    write();
-    close();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double duration =
+        static_cast<double>(m_in_sf_info.frames) / m_in_sf_info.samplerate;
+    double factor = duration > 0 ? elapsed.count() / duration : 0;
+    Log::write(LogLevel::Info,
+               "Filtered %.1f s of audio in %.2f s, real-time factor %.4f",
+               duration, elapsed.count(), factor);
+    return factor;
 }
 
-void ProcessAudioFile::noise_gate(float threshold)
+double ProcessAudioFile::neural(const string& model_filepath)
 {
-    open();
-    read();
+    // the spectral filter streams instead of taking overlapping windows
+    if (model_filepath == kSpectralModelPath) {
+        return spectral(kNeuralBlockLen);
+    }
 
-    NoiseGate ng(threshold);
-    ng.process(m_in_audio_data.data(), m_out_audio_data.data(), m_total_frames);
+    std::unique_ptr<InferenceModel> model;
+    try {
+        model = createModel(model_filepath, kNeuralBlockLen);
+    } catch (const std::exception& e) {
+        Log::write(LogLevel::Error, "Error loading model %s: %s",
+                   model_filepath, e.what());
+        return -1;
+    }
+
+    if (!open()) {
+        return -1;
+    }
+    if (m_in_sf_info.samplerate != kNeuralSampleRate ||
+        m_in_sf_info.channels != 1) {
+        Log::write(LogLevel::Error,
+                   "Neural mode needs mono %d Hz input, %s has %d channels "
+                   "at %d Hz",
+                   kNeuralSampleRate, m_in_filename, m_in_sf_info.channels,
+                   m_in_sf_info.samplerate);
+        close();
+        return -1;
+    }
 
-    write();
+    auto start = std::chrono::steady_clock::now();
+    model->resetState();
+
+    // as in the script, a window is processed only once it is full and the
+    // frames after the last full window stay silent
+    auto frames = static_cast<std::size_t>(m_in_sf_info.frames);
+    std::size_t lead = kNeuralBlockLen - kNeuralBlockShift;
+    std::size_t blocks =
+        frames >= lead ? (frames - lead) / kNeuralBlockShift : 0;
+    // a pipelined model returns the block of latency calls before
+    std::size_t latency = model->latencyBlocks();
+
+    KernelTable kernels = selectKernels(kNeuralBlockLen, kNeuralBlockShift);
+    std::vector<float> window(kNeuralBlockLen, 0.0f);
+    std::vector<float> overlap(kNeuralBlockLen, 0.0f);
+    std::vector<float> in(kNeuralChunkShifts * kNeuralBlockShift, 0.0f);
+    std::vector<float> out(in.size(), 0.0f);
+
+    std::size_t written = 0;
+    for (std::size_t step = 0; step < blocks + latency;
+         step += kNeuralChunkShifts) {
+        std::size_t shifts =
+            std::min(kNeuralChunkShifts, blocks + latency - step);
+        std::size_t available = step < blocks ? blocks - step : 0;
+        std::size_t reading = std::min(shifts, available) * kNeuralBlockShift;
+        sf_count_t count;
+        {
+            RTNR_TRACE_SCOPE("file_read");
+            count = sf_read_float(m_in_file, in.data(), reading);
+        }
+        if (count != static_cast<sf_count_t>(reading)) {
+            Log::write(LogLevel::Error, "Error reading input file %s: %s",
+                       m_in_filename, sf_strerror(m_in_file));
+            close();
+            return -1;
+        }
+        // the calls that flush a pipelined model see silence
+        std::fill(in.begin() + reading, in.end(), 0.0f);
+
+        std::size_t produced = 0;
+        for (std::size_t i = 0; i < shifts; ++i) {
+            const float* hop = &in[i * kNeuralBlockShift];
+            std::copy(window.begin() + kNeuralBlockShift, window.end(),
+                      window.begin());
+            std::copy(hop, hop + kNeuralBlockShift,
+                      window.end() - kNeuralBlockShift);
+
+            const float* block = model->infer(window.data(), kNeuralBlockLen);
+            if (step + i < latency) {
+                continue;
+            }
+
+            // shift the overlap, add the block and halve, as the script
+            kernels.overlapAdd(overlap.data(), block, kNeuralBlockLen,
+                               kNeuralBlockShift, 0.5f);
+            std::copy(overlap.begin(), overlap.begin() + kNeuralBlockShift,
+                      &out[produced]);
+            produced += kNeuralBlockShift;
+        }
+
+        RTNR_TRACE_SCOPE("file_write");
+        written += sf_write_float(m_out_file, out.data(), produced);
+    }
+
+    // the frames after the last window are written as silence
+    std::fill(out.begin(), out.end(), 0.0f);
+    while (written < frames) {
+        std::size_t chunk = std::min(out.size(), frames - written);
+        sf_count_t count = sf_write_float(m_out_file, out.data(), chunk);
+        if (count <= 0) {
+            break;
+        }
+        written += count;
+    }
+    if (written != frames) {
+        Log::write(LogLevel::Error, "Error writing output file: %s",
+                   sf_strerror(m_out_file));
+    }
     close();
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double duration = static_cast<double>(frames) / kNeuralSampleRate;
+    double factor = duration > 0 ? elapsed.count() / duration : 0;
+    Log::write(LogLevel::Info,
+               "Denoised %.1f s of audio in %.2f s, real-time factor %.4f "
+               "(%.0fx faster than real time)",
+               duration, elapsed.count(), factor,
+               factor > 0 ? 1 / factor : 0.0);
+    return factor;
 }
@@ -2,16 +2,16 @@
 #define AUDIO_FILE_H
 
 #include <string>
-#include <vector>
 
 #include "sndfile.h"
 
-#include "../Filters/AdaptiveKalman.h"
-#include "../Filters/Kalman.h"
 #include "../Filters/NoiseGate.h"
+#include "../Pipeline/Pipeline.h"
+#include "../Pipeline/Stages.h"
+#include "../Util/Log.h"
+#include "../Util/Trace.h"
 
 using std::string;
-using std::vector;
 
 class ProcessAudioFile
 {
@@ -25,22 +25,45 @@ class ProcessAudioFile
     SNDFILE* m_in_file;
     SNDFILE* m_out_file;
 
-    sf_count_t m_total_frames;
-
-    vector<float> m_in_audio_data;
-    vector<float> m_out_audio_data;
-
-    void open();
-    void read();
-    void write();
+    bool open();
     void close();
 
+    /// @brief Streams the input file through a pipeline chunk by chunk and
+    /// writes the result. The chunks come from the pipeline arena, so memory
+    /// use does not grow with the file length. The pipeline latency is
+    /// compensated, the output is as long as the input and aligned with it.
+    /// @param pipeline The pipeline, built here for the given block size.
+    /// @param framesPerBuffer Number of frames per pipeline run.
+    /// @return False if the files cannot be opened or written.
+    bool run(Pipeline& pipeline, unsigned long framesPerBuffer);
+
   public:
     ProcessAudioFile(string in_filename, string out_filename);
 
     void kalman(unsigned long framesPerBuffer);
     void adaptive_kalman(unsigned long framesPerBuffer);
+    /// @brief Filters the file with the per-bin Kalman filter on the STFT
+    /// magnitudes.
+    /// @param framesPerBuffer Number of frames per pipeline run.
+    void spectral_kalman(unsigned long framesPerBuffer);
     void noise_gate(float threshold);
+
+    /// @brief Denoises the file with the spectral Wiener filter, the cheap
+    /// alternative to the neural mode.
+    /// @param framesPerBuffer Number of frames per pipeline run.
+    /// @return Processing time divided by the audio duration, negative if
+    /// the files cannot be processed.
+    double spectral(unsigned long framesPerBuffer);
+
+    /// @brief Denoises the file with the neural model as fast as possible,
+    /// sliding a 1536 frame window by 384 frames and overlap-adding the
+    /// model output exactly like Model/RealTimeTest.py, so the result can be
+    /// checked against the Python reference with Model/ParityTest.py.
+    /// kSpectralModelPath runs the spectral mode instead.
+    /// @param model_filepath Path to the model, as taken by createModel.
+    /// @return Processing time divided by the audio duration, negative if
+    /// the files cannot be processed.
+    double neural(const string& model_filepath);
 };
 
 #endif // AUDIO_FILE_H
@@ -0,0 +1,194 @@
+#include "Fft.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+/// @brief Largest radix of a stage.
+constexpr std::size_t kMaxRadix = 5;
+
+/// @brief Complex product without the infinity and NaN recovery of the
+/// standard operator, which keeps the butterflies inlined and vectorizable.
+inline std::complex<float> multiply(std::complex<float> a,
+                                    std::complex<float> b)
+{
+    return std::complex<float>(a.real() * b.real() - a.imag() * b.imag(),
+                               a.real() * b.imag() + a.imag() * b.real());
+}
+} // namespace
+
+Fft::Fft(std::size_t size) : mSize(size)
+{
+    if (!supports(size)) {
+        throw std::invalid_argument("FFT size must be a product of 2, 3, 5");
+    }
+
+    // radix 4 first, it needs the fewest multiplications per point
+    std::size_t remaining = size;
+    for (std::size_t radix : {4, 2, 3, 5}) {
+        while (remaining % radix == 0 && remaining > 1) {
+            remaining /= radix;
+            mStages.push_back({radix, remaining});
+        }
+    }
+
+    const double pi = std::acos(-1.0);
+    mTwiddles.resize(size);
+    for (std::size_t k = 0; k < size; ++k) {
+        double phase = -2.0 * pi * static_cast<double>(k) / size;
+        mTwiddles[k] = std::complex<float>(static_cast<float>(std::cos(phase)),
+                                           static_cast<float>(std::sin(phase)));
+    }
+    mIn.resize(size);
+    mOut.resize(size);
+}
+
+std::size_t Fft::size() const
+{
+    return mSize;
+}
+
+bool Fft::supports(std::size_t size)
+{
+    if (size == 0) {
+        return false;
+    }
+    for (std::size_t radix : {2, 3, 5}) {
+        while (size % radix == 0) {
+            size /= radix;
+        }
+    }
+    return size == 1;
+}
+
+void Fft::forward(const std::complex<float>* in,
+                  std::complex<float>* out) const
+{
+    if (mStages.empty()) {
+        out[0] = in[0];
+        return;
+    }
+    work(out, in, 1, 0);
+}
+
+void Fft::forwardReal(const float* in, std::complex<float>* out)
+{
+    for (std::size_t i = 0; i < mSize; ++i) {
+        mIn[i] = std::complex<float>(in[i], 0.0f);
+    }
+    forward(mIn.data(), mOut.data());
+    std::copy(mOut.begin(), mOut.begin() + mSize / 2 + 1, out);
+}
+
+void Fft::inverseReal(const std::complex<float>* in, float* out)
+{
+    // the inverse is the conjugate of the forward transform of the
+    // conjugate, the upper half follows from the Hermitian symmetry
+    std::size_t half = mSize / 2;
+    for (std::size_t k = 0; k <= half; ++k) {
+        mIn[k] = std::conj(in[k]);
+    }
+    for (std::size_t k = half + 1; k < mSize; ++k) {
+        mIn[k] = in[mSize - k];
+    }
+    forward(mIn.data(), mOut.data());
+
+    float scale = 1.0f / static_cast<float>(mSize);
+    for (std::size_t i = 0; i < mSize; ++i) {
+        out[i] = mOut[i].real() * scale;
+    }
+}
+
+void Fft::work(std::complex<float>* out, const std::complex<float>* in,
+               std::size_t stride, std::size_t stage) const
+{
+    const std::size_t radix = mStages[stage].radix;
+    const std::size_t length = mStages[stage].length;
+
+    // sub-transforms of every radix-th input, written side by side
+    if (length == 1) {
+        for (std::size_t q = 0; q < radix; ++q) {
+            out[q] = in[q * stride];
+        }
+    } else {
+        for (std::size_t q = 0; q < radix; ++q) {
+            work(out + q * length, in + q * stride, stride * radix,
+                 stage + 1);
+        }
+    }
+
+    switch (radix) {
+        case 2:
+            butterfly2(out, stride, length);
+            break;
+        case 4:
+            butterfly4(out, stride, length);
+            break;
+        default:
+            butterflyGeneric(out, stride, length, radix);
+            break;
+    }
+}
+
+void Fft::butterfly2(std::complex<float>* out, std::size_t stride,
+                     std::size_t length) const
+{
+    std::complex<float>* second = out + length;
+    for (std::size_t k = 0; k < length; ++k) {
+        std::complex<float> t = multiply(second[k], mTwiddles[k * stride]);
+        second[k] = out[k] - t;
+        out[k] += t;
+    }
+}
+
+void Fft::butterfly4(std::complex<float>* out, std::size_t stride,
+                     std::size_t length) const
+{
+    for (std::size_t k = 0; k < length; ++k) {
+        std::complex<float> a0 = out[k];
+        std::complex<float> a1 =
+            multiply(out[k + length], mTwiddles[k * stride]);
+        std::complex<float> a2 =
+            multiply(out[k + 2 * length], mTwiddles[2 * k * stride]);
+        std::complex<float> a3 =
+            multiply(out[k + 3 * length], mTwiddles[3 * k * stride]);
+
+        std::complex<float> s0 = a0 + a2;
+        std::complex<float> s1 = a0 - a2;
+        std::complex<float> s2 = a1 + a3;
+        // -i (a1 - a3) for the forward direction
+        std::complex<float> d = a1 - a3;
+        std::complex<float> s3(d.imag(), -d.real());
+
+        out[k] = s0 + s2;
+        out[k + length] = s1 + s3;
+        out[k + 2 * length] = s0 - s2;
+        out[k + 3 * length] = s1 - s3;
+    }
+}
+
+void Fft::butterflyGeneric(std::complex<float>* out, std::size_t stride,
+                           std::size_t length, std::size_t radix) const
+{
+    std::complex<float> scratch[kMaxRadix];
+    for (std::size_t u = 0; u < length; ++u) {
+        for (std::size_t q = 0; q < radix; ++q) {
+            scratch[q] = out[u + q * length];
+        }
+        for (std::size_t q = 0; q < radix; ++q) {
+            std::size_t k = u + q * length;
+            std::size_t step = stride * k % mSize;
+            std::size_t twiddle = 0;
+            std::complex<float> sum = scratch[0];
+            for (std::size_t p = 1; p < radix; ++p) {
+                twiddle += step;
+                if (twiddle >= mSize) {
+                    twiddle -= mSize;
+                }
+                sum += multiply(scratch[p], mTwiddles[twiddle]);
+            }
+            out[k] = sum;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/// @brief Mixed-radix fast Fourier transform for sizes whose prime factors
+/// are 2, 3 and 5, so that the 1536 frame model block (2^9 * 3) transforms
+/// without padding. Twiddles and scratch are allocated by the constructor;
+/// the transforms never allocate, which makes them usable on the audio
+/// thread. An instance is not thread-safe, use one per thread.
+class Fft
+{
+  private:
+    /// @brief One stage of the decomposition.
+    struct Stage
+    {
+        /// @brief Radix of the butterflies.
+        std::size_t radix;
+        /// @brief Length of the sub-transforms combined by the stage.
+        std::size_t length;
+    };
+
+    /// @brief Transform size.
+    std::size_t mSize;
+    /// @brief Stages from the outermost to the innermost.
+    std::vector<Stage> mStages;
+    /// @brief exp(-2 pi i k / size) for every k.
+    std::vector<std::complex<float>> mTwiddles;
+    /// @brief Scratch of the real transforms.
+    std::vector<std::complex<float>> mIn;
+    /// @brief Scratch of the real transforms.
+    std::vector<std::complex<float>> mOut;
+
+    /// @brief Recursive decimation in time of one stage.
+    void work(std::complex<float>* out, const std::complex<float>* in,
+              std::size_t stride, std::size_t stage) const;
+    /// @brief Radix-2 butterflies of one stage.
+    void butterfly2(std::complex<float>* out, std::size_t stride,
+                    std::size_t length) const;
+    /// @brief Radix-4 butterflies of one stage.
+    void butterfly4(std::complex<float>* out, std::size_t stride,
+                    std::size_t length) const;
+    /// @brief Butterflies of any radix up to 5.
+    void butterflyGeneric(std::complex<float>* out, std::size_t stride,
+                          std::size_t length, std::size_t radix) const;
+
+  public:
+    /// @brief Constructor for the Fft class.
+    /// @param size Transform size, a product of 2, 3 and 5.
+    /// @throws std::invalid_argument If the size has another prime factor.
+    explicit Fft(std::size_t size);
+
+    /// @brief Returns the transform size.
+    /// @return The size.
+    std::size_t size() const;
+
+    /// @brief Returns whether a size can be transformed.
+    /// @param size The size.
+    /// @return True if the size is a product of 2, 3 and 5.
+    static bool supports(std::size_t size);
+
+    /// @brief Forward complex transform, not normalized.
+    /// @param in size input values.
+    /// @param out Receives size bins, must not alias the input.
+    void forward(const std::complex<float>* in,
+                 std::complex<float>* out) const;
+
+    /// @brief Forward transform of a real signal.
+    /// @param in size samples.
+    /// @param out Receives the size / 2 + 1 non-negative frequency bins.
+    void forwardReal(const float* in, std::complex<float>* out);
+
+    /// @brief Inverse of forwardReal, normalized so that a round trip gives
+    /// the input back.
+    /// @param in size / 2 + 1 bins, the rest follows by symmetry.
+    /// @param out Receives size samples.
+    void inverseReal(const std::complex<float>* in, float* out);
+};
+
+#endif // FFT_H
@@ -0,0 +1,108 @@
+#include "KernelBench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+#include "../Util/Arena.h"
+#include "Kernels.h"
+
+namespace
+{
+/// @brief Gate threshold of the timed calls, passes about half the samples.
+constexpr float kThreshold = 0.5f;
+
+/// @brief Times calls of a function and returns the median of the runs.
+/// @param calls Number of calls per run.
+/// @param runs Number of runs.
+/// @param call The function to time.
+/// @return Median time of one call in seconds.
+template <typename Call>
+double timeCalls(std::size_t calls, std::size_t runs, Call call)
+{
+    std::vector<double> times(std::max<std::size_t>(runs, 1));
+    for (auto& time : times) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < calls; ++i) {
+            call();
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        time = elapsed.count() / std::max<std::size_t>(calls, 1);
+    }
+    std::sort(times.begin(), times.end());
+    return times[(times.size() - 1) / 2];
+}
+} // namespace
+
+std::string KernelBenchReport::toString() const
+{
+    std::ostringstream report;
+    report << "Kernels " << block << "/" << hop << " ("
+           << (specialized ? "specialized" : "no specialization") << ")";
+    for (const KernelTiming& timing : timings) {
+        double speedup = timing.selectedSeconds > 0
+                             ? timing.genericSeconds / timing.selectedSeconds
+                             : 0;
+        report << "\n  " << timing.kernel << ": generic "
+               << timing.genericSeconds * 1e9 << " ns, selected "
+               << timing.selectedSeconds * 1e9 << " ns (" << speedup << "x)";
+    }
+    return report.str();
+}
+
+KernelBenchReport KernelBench::run(std::size_t block, std::size_t hop,
+                                   std::size_t calls, std::size_t runs)
+{
+    KernelTable selected = selectKernels(block, hop);
+    KernelTable generic = genericKernels(block, hop);
+
+    KernelBenchReport report;
+    report.block = selected.block;
+    report.hop = selected.hop;
+    report.specialized = selected.specialized;
+
+    // aligned like the pipeline buffers, so both builds see the same memory
+    Arena arena(3 * Arena::bytesFor<float>(block));
+    float* in = arena.allocate<float>(block);
+    float* out = arena.allocate<float>(block);
+    float* accumulator = arena.allocate<float>(block);
+    for (std::size_t i = 0; i < block; ++i) {
+        in[i] = std::sin(0.05f * static_cast<float>(i));
+    }
+    std::fill(accumulator, accumulator + block, 0.0f);
+
+    // the results feed a volatile sink so no call is optimized away
+    volatile float sink = 0;
+    float peak = 0;
+    float squares = 0;
+    auto measure = [&](const char* kernel, auto call) {
+        KernelTiming timing;
+        timing.kernel = kernel;
+        timing.genericSeconds =
+            timeCalls(calls, runs, [&]() { call(generic); });
+        timing.selectedSeconds =
+            timeCalls(calls, runs, [&]() { call(selected); });
+        sink = sink + out[0] + accumulator[0] + peak + squares;
+        report.timings.push_back(timing);
+    };
+
+    measure("gate", [&](const KernelTable& table) {
+        table.gate(in, out, kThreshold, block);
+    });
+    measure("copy", [&](const KernelTable& table) {
+        table.copy(in, out, block);
+    });
+    // a scale of one half keeps the accumulator bounded over the calls
+    measure("overlapAdd", [&](const KernelTable& table) {
+        table.overlapAdd(accumulator, in, block, report.hop, 0.5f);
+    });
+    measure("meter", [&](const KernelTable& table) {
+        peak = 0;
+        squares = 0;
+        table.meter(in, block, peak, squares);
+    });
+
+    return report;
+}
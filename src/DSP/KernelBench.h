@@ -0,0 +1,55 @@
+#ifndef KERNEL_BENCH_H
+#define KERNEL_BENCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// @brief Timing of one kernel in both builds.
+struct KernelTiming
+{
+    /// @brief Kernel name.
+    std::string kernel;
+    /// @brief Median time of one call to the generic kernel in seconds.
+    double genericSeconds = 0;
+    /// @brief Median time of one call to the selected kernel in seconds.
+    double selectedSeconds = 0;
+};
+
+/// @brief Timings of every kernel for one block and hop.
+struct KernelBenchReport
+{
+    /// @brief Number of frames in one block.
+    std::size_t block = 0;
+    /// @brief Number of frames between consecutive blocks.
+    std::size_t hop = 0;
+    /// @brief Flag to indicate that selectKernels found a specialization.
+    bool specialized = false;
+    /// @brief One entry per kernel of the table.
+    std::vector<KernelTiming> timings;
+
+    /// @brief Function to format the report.
+    /// @return The report as human readable lines, one per kernel.
+    std::string toString() const;
+};
+
+/// @brief The KernelBench class measures what the specialized kernels gain
+/// over the generic ones: it times every kernel of the table selectKernels
+/// picks for a block and hop against the same kernel of the generic table,
+/// on aligned buffers of full blocks.
+class KernelBench
+{
+  public:
+    /// @brief Times the kernels for one configuration.
+    /// @param block Number of frames in one block.
+    /// @param hop Number of frames between consecutive blocks.
+    /// @param calls Number of calls per timed run. Defaults to 20000.
+    /// @param runs Number of timed runs, the median is reported. Defaults
+    /// to 9.
+    /// @return The report.
+    static KernelBenchReport run(std::size_t block, std::size_t hop,
+                                 std::size_t calls = 20000,
+                                 std::size_t runs = 9);
+};
+
+#endif // KERNEL_BENCH_H
@@ -0,0 +1,37 @@
+#include "Kernels.h"
+
+namespace
+{
+/// @brief Builds the table of one specialization.
+template <std::size_t Block, std::size_t Hop>
+KernelTable makeTable()
+{
+    return {&FixedKernels<Block, Hop>::gate, &FixedKernels<Block, Hop>::copy,
+            &FixedKernels<Block, Hop>::overlapAdd,
+            &FixedKernels<Block, Hop>::meter, Block, Hop, true};
+}
+} // namespace
+
+KernelTable genericKernels(std::size_t block, std::size_t hop)
+{
+    return {&GenericKernels::gate, &GenericKernels::copy,
+            &GenericKernels::overlapAdd, &GenericKernels::meter, block,
+            hop == 0 ? block : hop, false};
+}
+
+KernelTable selectKernels(std::size_t block, std::size_t hop)
+{
+    if (hop == 0) {
+        hop = block;
+    }
+
+    // 1536 = 32 ms for 48k sr, 384 = 8 ms shift of the sliding window
+    if (block == 1536 && hop == 384) {
+        return makeTable<1536, 384>();
+    }
+    if (block == 1536 && hop == 1536) {
+        return makeTable<1536, 1536>();
+    }
+
+    return genericKernels(block, hop);
+}
@@ -0,0 +1,173 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+/// @brief Table of the DSP kernels used on the hot path. The table for a
+/// stream is picked once by selectKernels, so the per-block calls go through
+/// one indirect call to a loop whose trip count is a compile-time constant
+/// whenever the stream matches a specialization.
+struct KernelTable
+{
+    /// @brief Zeroes samples whose magnitude is not above the threshold.
+    /// Works in place.
+    void (*gate)(const float* in, float* out, float threshold,
+                 std::size_t frames);
+    /// @brief Copies a block.
+    void (*copy)(const float* in, float* out, std::size_t frames);
+    /// @brief Shifts the accumulator by one hop, clears the new tail, adds
+    /// a full block on top and scales the sum.
+    void (*overlapAdd)(float* accumulator, const float* block,
+                       std::size_t blockLen, std::size_t hop, float scale);
+    /// @brief Adds the peak and the sum of squares of a block to the given
+    /// accumulators.
+    void (*meter)(const float* in, std::size_t frames, float& peak,
+                  float& squares);
+    /// @brief Block length the table was selected for.
+    std::size_t block;
+    /// @brief Hop the table was selected for.
+    std::size_t hop;
+    /// @brief Flag to indicate that the kernels are specialized.
+    bool specialized;
+};
+
+/// @brief Kernels with runtime lengths, used when no specialization matches
+/// and for partial blocks.
+struct GenericKernels
+{
+    static void gate(const float* in, float* out, float threshold,
+                     std::size_t frames)
+    {
+        for (std::size_t i = 0; i < frames; ++i) {
+            out[i] = std::fabs(in[i]) > threshold ? in[i] : 0.0f;
+        }
+    }
+
+    static void copy(const float* in, float* out, std::size_t frames)
+    {
+        std::copy(in, in + frames, out);
+    }
+
+    static void overlapAdd(float* accumulator, const float* block,
+                           std::size_t blockLen, std::size_t hop, float scale)
+    {
+        std::copy(accumulator + hop, accumulator + blockLen, accumulator);
+        std::fill(accumulator + blockLen - hop, accumulator + blockLen, 0.0f);
+        for (std::size_t i = 0; i < blockLen; ++i) {
+            accumulator[i] = (accumulator[i] + block[i]) * scale;
+        }
+    }
+
+    static void meter(const float* in, std::size_t frames, float& peak,
+                      float& squares)
+    {
+        // eight independent lanes keep the reductions vectorizable
+        float lanePeak[8] = {};
+        float laneSquares[8] = {};
+        std::size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            for (std::size_t k = 0; k < 8; ++k) {
+                lanePeak[k] = std::max(lanePeak[k], std::fabs(in[i + k]));
+                laneSquares[k] += in[i + k] * in[i + k];
+            }
+        }
+        for (std::size_t k = 0; i + k < frames; ++k) {
+            lanePeak[k] = std::max(lanePeak[k], std::fabs(in[i + k]));
+            laneSquares[k] += in[i + k] * in[i + k];
+        }
+        for (std::size_t k = 0; k < 8; ++k) {
+            peak = std::max(peak, lanePeak[k]);
+            squares += laneSquares[k];
+        }
+    }
+};
+
+/// @brief Kernels specialized for a fixed block and hop. Full blocks run
+/// loops with constant trip counts that the compiler unrolls and vectorizes
+/// without remainder handling; shorter blocks fall back to the generic code.
+/// @tparam Block Number of frames in one block.
+/// @tparam Hop Number of frames between consecutive blocks.
+template <std::size_t Block, std::size_t Hop>
+struct FixedKernels
+{
+    static_assert(Hop > 0 && Hop <= Block, "Hop must be in (0, Block]");
+    static_assert(Block % 8 == 0, "Block must be a multiple of 8");
+
+    static void gate(const float* in, float* out, float threshold,
+                     std::size_t frames)
+    {
+        if (frames != Block) {
+            GenericKernels::gate(in, out, threshold, frames);
+            return;
+        }
+        for (std::size_t i = 0; i < Block; ++i) {
+            out[i] = std::fabs(in[i]) > threshold ? in[i] : 0.0f;
+        }
+    }
+
+    static void copy(const float* in, float* out, std::size_t frames)
+    {
+        if (frames != Block) {
+            GenericKernels::copy(in, out, frames);
+            return;
+        }
+        // a constant-size memmove beats any hand-written loop
+        std::copy(in, in + Block, out);
+    }
+
+    static void overlapAdd(float* accumulator, const float* block,
+                           std::size_t blockLen, std::size_t hop, float scale)
+    {
+        if (blockLen != Block || hop != Hop) {
+            GenericKernels::overlapAdd(accumulator, block, blockLen, hop,
+                                       scale);
+            return;
+        }
+        for (std::size_t i = 0; i < Block - Hop; ++i) {
+            accumulator[i] = (accumulator[i + Hop] + block[i]) * scale;
+        }
+        for (std::size_t i = Block - Hop; i < Block; ++i) {
+            accumulator[i] = block[i] * scale;
+        }
+    }
+
+    static void meter(const float* in, std::size_t frames, float& peak,
+                      float& squares)
+    {
+        if (frames != Block) {
+            GenericKernels::meter(in, frames, peak, squares);
+            return;
+        }
+        float lanePeak[8] = {};
+        float laneSquares[8] = {};
+        for (std::size_t i = 0; i < Block; i += 8) {
+            for (std::size_t k = 0; k < 8; ++k) {
+                lanePeak[k] = std::max(lanePeak[k], std::fabs(in[i + k]));
+                laneSquares[k] += in[i + k] * in[i + k];
+            }
+        }
+        for (std::size_t k = 0; k < 8; ++k) {
+            peak = std::max(peak, lanePeak[k]);
+            squares += laneSquares[k];
+        }
+    }
+};
+
+/// @brief Returns the generic kernels, the baseline the specializations are
+/// measured against.
+/// @param block Number of frames in one block.
+/// @param hop Number of frames between consecutive blocks. Defaults to the
+/// block length, which means no overlap.
+/// @return The generic table.
+KernelTable genericKernels(std::size_t block, std::size_t hop = 0);
+
+/// @brief Picks the kernels for a stream configuration.
+/// @param block Number of frames in one block.
+/// @param hop Number of frames between consecutive blocks. Defaults to the
+/// block length, which means no overlap.
+/// @return The specialized table if one matches, the generic one otherwise.
+KernelTable selectKernels(std::size_t block, std::size_t hop = 0);
+
+#endif // KERNELS_H
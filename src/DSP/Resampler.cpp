@@ -0,0 +1,156 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+/// @brief Stopband rejection of the filter in dB.
+constexpr double kRejectionDb = 60;
+
+/// @brief Modified Bessel function of the first kind and order zero.
+/// @param x The argument.
+/// @return I0(x).
+double besselI0(double x)
+{
+    double sum = 1;
+    double term = 1;
+    for (int k = 1; k < 500; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-17) {
+            break;
+        }
+    }
+    return sum;
+}
+} // namespace
+
+Resampler::Resampler(int fromRate, int toRate)
+{
+    auto divisor = static_cast<std::size_t>(std::gcd(fromRate, toRate));
+    mUp = static_cast<std::size_t>(toRate) / divisor;
+    mDown = static_cast<std::size_t>(fromRate) / divisor;
+
+    // Kaiser-windowed sinc with the length and shape Octave picks
+    const double pi = std::acos(-1.0);
+    double cutoff = 1.0 / (2.0 * std::max(mUp, mDown));
+    double rollOff = cutoff / 10;
+    mHalf = static_cast<std::size_t>(
+        std::ceil((kRejectionDb - 8) / (28.714 * rollOff)));
+    double beta = 0.1102 * (kRejectionDb - 8.7);
+
+    std::size_t length = 2 * mHalf + 1;
+    std::vector<double> filter(length);
+    for (std::size_t n = 0; n < length; ++n) {
+        double t = static_cast<double>(n) - static_cast<double>(mHalf);
+        double x = 2 * cutoff * t;
+        double sinc = x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+        double position = 2.0 * n / (length - 1) - 1;
+        double window =
+            besselI0(beta * std::sqrt(std::max(0.0, 1 - position * position))) /
+            besselI0(beta);
+        filter[n] = sinc * window;
+    }
+    // unit gain at DC for every phase, as pystoi normalizes it
+    double gain = std::accumulate(filter.begin(), filter.end(), 0.0);
+    for (double& tap : filter) {
+        tap *= static_cast<double>(mUp) / gain;
+    }
+
+    // row r holds the taps r, r + up, ... reversed to run in input order
+    mTaps = (length + mUp - 1) / mUp;
+    mPhases.assign(mUp * mTaps, 0.0f);
+    for (std::size_t r = 0; r < mUp; ++r) {
+        for (std::size_t k = 0; k < mTaps; ++k) {
+            std::size_t index = r + k * mUp;
+            if (index < length) {
+                mPhases[r * mTaps + mTaps - 1 - k] =
+                    static_cast<float>(filter[index]);
+            }
+        }
+    }
+
+    reset();
+}
+
+void Resampler::reset()
+{
+    // zeros before the signal, so that every row sees a full history
+    mInput.assign(mTaps - 1, 0.0f);
+    mBase = -static_cast<std::int64_t>(mTaps - 1);
+    mPushed = 0;
+    mNext = 0;
+}
+
+void Resampler::process(const float* in, std::size_t frames,
+                        std::vector<float>& out)
+{
+    mInput.insert(mInput.end(), in, in + frames);
+    mPushed += frames;
+    produce(mPushed, out);
+}
+
+void Resampler::flush(std::vector<float>& out)
+{
+    std::uint64_t total = (mPushed * mUp + mDown - 1) / mDown;
+    if (mNext >= total) {
+        return;
+    }
+
+    // the taps after the end of the signal see silence
+    std::uint64_t last = ((total - 1) * mDown + mHalf) / mUp;
+    auto end = static_cast<std::int64_t>(last + 1);
+    std::int64_t buffered = mBase + static_cast<std::int64_t>(mInput.size());
+    if (end > buffered) {
+        mInput.resize(mInput.size() + static_cast<std::size_t>(end - buffered),
+                      0.0f);
+    }
+    produce(last + 1, out);
+    mNext = total;
+}
+
+void Resampler::produce(std::uint64_t available, std::vector<float>& out)
+{
+    std::uint64_t total = (mPushed * mUp + mDown - 1) / mDown;
+    while (mNext < total) {
+        std::uint64_t position = mNext * mDown + mHalf;
+        std::uint64_t newest = position / mUp;
+        if (newest >= available) {
+            break;
+        }
+
+        const float* row = &mPhases[(position % mUp) * mTaps];
+        const float* x = &mInput[static_cast<std::size_t>(
+            static_cast<std::int64_t>(newest) -
+            static_cast<std::int64_t>(mTaps - 1) - mBase)];
+        // eight independent lanes keep the dot product vectorizable
+        float lanes[8] = {};
+        std::size_t k = 0;
+        for (; k + 8 <= mTaps; k += 8) {
+            for (std::size_t lane = 0; lane < 8; ++lane) {
+                lanes[lane] += x[k + lane] * row[k + lane];
+            }
+        }
+        for (std::size_t lane = 0; k + lane < mTaps; ++lane) {
+            lanes[lane] += x[k + lane] * row[k + lane];
+        }
+        float sum = 0;
+        for (float lane : lanes) {
+            sum += lane;
+        }
+        out.push_back(sum);
+        ++mNext;
+    }
+
+    // drop the input no later output reaches
+    auto oldest = static_cast<std::int64_t>((mNext * mDown + mHalf) / mUp) -
+                  static_cast<std::int64_t>(mTaps - 1);
+    if (oldest > mBase) {
+        auto drop = std::min(static_cast<std::size_t>(oldest - mBase),
+                             mInput.size());
+        mInput.erase(mInput.begin(), mInput.begin() + drop);
+        mBase += static_cast<std::int64_t>(drop);
+    }
+}
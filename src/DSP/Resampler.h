@@ -0,0 +1,63 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Streaming rational resampler. The anti-aliasing filter is the
+/// Kaiser-windowed sinc of Octave's resample (60 dB rejection, a transition
+/// band of a tenth of the cutoff), which pystoi uses as well, and it is
+/// applied zero-phase like scipy's resample_poly: output n is the filtered
+/// input at n * from / to. Fed in chunks of any size it returns the same
+/// samples as one call on the whole signal.
+class Resampler
+{
+  private:
+    /// @brief Upsampling factor.
+    std::size_t mUp;
+    /// @brief Downsampling factor.
+    std::size_t mDown;
+    /// @brief Half length of the filter in upsampled samples.
+    std::size_t mHalf;
+    /// @brief Taps of each polyphase row, longest row length.
+    std::size_t mTaps;
+    /// @brief Polyphase rows, mUp rows of mTaps taps in input order, padded
+    /// with zeros in front.
+    std::vector<float> mPhases;
+    /// @brief Input not yet consumed, mTaps - 1 frames of history included.
+    std::vector<float> mInput;
+    /// @brief Absolute index of mInput[0], negative for the zero history.
+    std::int64_t mBase;
+    /// @brief Number of input frames pushed.
+    std::uint64_t mPushed;
+    /// @brief Index of the next output frame.
+    std::uint64_t mNext;
+
+    /// @brief Computes every output whose input is complete.
+    /// @param available Number of input frames that can be used.
+    /// @param out Receives the outputs.
+    void produce(std::uint64_t available, std::vector<float>& out);
+
+  public:
+    /// @brief Constructor for the Resampler class.
+    /// @param fromRate Input sample rate.
+    /// @param toRate Output sample rate.
+    Resampler(int fromRate, int toRate);
+
+    /// @brief Feeds input and appends every output that is complete.
+    /// @param in Input frames.
+    /// @param frames Number of input frames.
+    /// @param out Receives the outputs.
+    void process(const float* in, std::size_t frames, std::vector<float>& out);
+
+    /// @brief Ends the signal with silence and appends the remaining outputs,
+    /// ceil(frames * to / from) in total.
+    /// @param out Receives the outputs.
+    void flush(std::vector<float>& out);
+
+    /// @brief Forgets the signal, for the next one.
+    void reset();
+};
+
+#endif // RESAMPLER_H
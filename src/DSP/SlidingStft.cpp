@@ -0,0 +1,122 @@
+#include "SlidingStft.h"
+
+#include <cmath>
+#include <stdexcept>
+
+SlidingStft::SlidingStft(std::size_t frameLen, std::size_t hop) :
+    mFrameLen(frameLen), mHop(hop), mBins(frameLen / 2 + 1), mFft(frameLen)
+{
+    if (hop == 0 || frameLen % hop != 0 || frameLen / hop < 2) {
+        throw std::invalid_argument(
+            "STFT hop must divide the frame at least twice");
+    }
+
+    // sqrt-Hann on both sides sums to frameLen / (2 hop) at this overlap
+    const double pi = std::acos(-1.0);
+    float scale = 2.0f * hop / frameLen;
+    mWindow.resize(frameLen);
+    mSynthesisWindow.resize(frameLen);
+    for (std::size_t i = 0; i < frameLen; ++i) {
+        double hann = 0.5 - 0.5 * std::cos(2 * pi * i / frameLen);
+        mWindow[i] = static_cast<float>(std::sqrt(hann));
+        mSynthesisWindow[i] = mWindow[i] * scale;
+    }
+
+    mHistory.resize(frameLen);
+    mFrame.resize(frameLen);
+    mSpectrum.resize(mBins);
+    mPower.resize(mBins);
+    mFiltered.resize(mBins);
+    mOverlap.resize(frameLen);
+    mReady.resize(hop);
+    reset();
+}
+
+std::size_t SlidingStft::frameLen() const
+{
+    return mFrameLen;
+}
+
+std::size_t SlidingStft::hop() const
+{
+    return mHop;
+}
+
+std::size_t SlidingStft::bins() const
+{
+    return mBins;
+}
+
+std::size_t SlidingStft::latency() const
+{
+    return mFrameLen;
+}
+
+const std::complex<float>* SlidingStft::spectrum() const
+{
+    return mSpectrum.data();
+}
+
+const float* SlidingStft::power() const
+{
+    return mPower.data();
+}
+
+std::uint64_t SlidingStft::frameCount() const
+{
+    return mFrameCount;
+}
+
+void SlidingStft::reset()
+{
+    std::fill(mHistory.begin(), mHistory.end(), 0.0f);
+    mHead = mFrameLen - mHop;
+    mFill = 0;
+    std::fill(mSpectrum.begin(), mSpectrum.end(), std::complex<float>());
+    std::fill(mPower.begin(), mPower.end(), 0.0f);
+    mFrameCount = 0;
+
+    std::fill(mOverlap.begin(), mOverlap.end(), 0.0f);
+    mOverlapHead = 0;
+    std::fill(mReady.begin(), mReady.end(), 0.0f);
+}
+
+void SlidingStft::analyzeFrame()
+{
+    // the oldest sample follows the hop just written, the ring wraps once
+    std::size_t start = (mHead + mHop) % mFrameLen;
+    std::size_t first = mFrameLen - start;
+    for (std::size_t i = 0; i < first; ++i) {
+        mFrame[i] = mHistory[start + i] * mWindow[i];
+    }
+    for (std::size_t i = first; i < mFrameLen; ++i) {
+        mFrame[i] = mHistory[i - first] * mWindow[i];
+    }
+    mHead = start;
+    mFill = 0;
+
+    mFft.forwardReal(mFrame.data(), mSpectrum.data());
+    for (std::size_t k = 0; k < mBins; ++k) {
+        mPower[k] = std::norm(mSpectrum[k]);
+    }
+    ++mFrameCount;
+}
+
+void SlidingStft::synthesizeFrame()
+{
+    mFft.inverseReal(mFiltered.data(), mFrame.data());
+
+    // add the frame from the oldest hop on, which it completes
+    std::size_t first = mFrameLen - mOverlapHead;
+    for (std::size_t i = 0; i < first; ++i) {
+        mOverlap[mOverlapHead + i] += mFrame[i] * mSynthesisWindow[i];
+    }
+    for (std::size_t i = first; i < mFrameLen; ++i) {
+        mOverlap[i - first] += mFrame[i] * mSynthesisWindow[i];
+    }
+
+    auto oldest = mOverlap.begin() + mOverlapHead;
+    std::copy(oldest, oldest + mHop, mReady.begin());
+    std::fill(oldest, oldest + mHop, 0.0f);
+    mOverlapHead = (mOverlapHead + mHop) % mFrameLen;
+}
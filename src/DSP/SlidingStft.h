@@ -0,0 +1,169 @@
+#ifndef SLIDING_STFT_H
+#define SLIDING_STFT_H
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Fft.h"
+
+/// @brief Streaming short-time Fourier transform over frames of 1536
+/// samples sliding by 384, the framing of the model windows. The input
+/// history and the overlap-add are rings, so a hop costs one windowing pass,
+/// one transform with the plan built by the constructor and, when the signal
+/// is resynthesized, one inverse transform; nothing is shifted or allocated.
+/// The spectrum and the power of the newest frame stay readable until the
+/// next frame, so any number of consumers share one transform per hop. Use
+/// an instance either for analysis or for filtering, not both.
+class SlidingStft
+{
+  private:
+    /// @brief Number of samples per frame.
+    std::size_t mFrameLen;
+    /// @brief Number of samples the frame slides per step.
+    std::size_t mHop;
+    /// @brief Number of non-negative frequency bins.
+    std::size_t mBins;
+    /// @brief Transform of one frame.
+    Fft mFft;
+    /// @brief Square root of a periodic Hann window, for analysis.
+    std::vector<float> mWindow;
+    /// @brief Analysis window scaled so that the overlap-add is exact.
+    std::vector<float> mSynthesisWindow;
+
+    /// @brief The last mFrameLen input samples, as a ring.
+    std::vector<float> mHistory;
+    /// @brief Ring position the current hop is written to.
+    std::size_t mHead;
+    /// @brief Number of samples collected for the current hop.
+    std::size_t mFill;
+    /// @brief Windowed frame, then the resynthesized frame.
+    std::vector<float> mFrame;
+    /// @brief Spectrum of the newest frame.
+    std::vector<std::complex<float>> mSpectrum;
+    /// @brief Power of every bin of the newest frame.
+    std::vector<float> mPower;
+    /// @brief Number of frames transformed.
+    std::uint64_t mFrameCount;
+
+    /// @brief Spectrum handed to the filter and resynthesized.
+    std::vector<std::complex<float>> mFiltered;
+    /// @brief Overlap-add of the resynthesized frames, as a ring.
+    std::vector<float> mOverlap;
+    /// @brief Ring position of the oldest hop of the overlap-add.
+    std::size_t mOverlapHead;
+    /// @brief Finished hop, emitted while the next hop is collected.
+    std::vector<float> mReady;
+
+    /// @brief Transforms the frame in the history and advances the ring.
+    void analyzeFrame();
+    /// @brief Adds the inverse of mFiltered to the overlap-add and moves the
+    /// completed hop to mReady.
+    void synthesizeFrame();
+
+  public:
+    /// @brief Constructor for the SlidingStft class.
+    /// @param frameLen Number of samples per frame, a product of 2, 3 and 5.
+    /// Defaults to 1536.
+    /// @param hop Number of samples the frame slides per step, dividing the
+    /// frame at least twice. Defaults to 384.
+    /// @throws std::invalid_argument If the frame length cannot be
+    /// transformed or the hop does not divide it at least twice.
+    SlidingStft(std::size_t frameLen = 1536, std::size_t hop = 384);
+
+    /// @brief Returns the number of samples per frame.
+    /// @return The frame length.
+    std::size_t frameLen() const;
+
+    /// @brief Returns the number of samples between frames.
+    /// @return The hop.
+    std::size_t hop() const;
+
+    /// @brief Returns the number of non-negative frequency bins.
+    /// @return frameLen / 2 + 1.
+    std::size_t bins() const;
+
+    /// @brief Returns the delay of a filtered signal.
+    /// @return The latency in samples, one frame.
+    std::size_t latency() const;
+
+    /// @brief Returns the spectrum of the newest frame.
+    /// @return bins() values, valid until the next frame.
+    const std::complex<float>* spectrum() const;
+
+    /// @brief Returns the power of the newest frame.
+    /// @return bins() values, valid until the next frame.
+    const float* power() const;
+
+    /// @brief Returns the number of frames transformed since the last reset,
+    /// for consumers that poll for new frames.
+    /// @return The frame count.
+    std::uint64_t frameCount() const;
+
+    /// @brief Clears the history and the overlap-add.
+    void reset();
+
+    /// @brief Feeds samples and calls the consumer for every completed frame.
+    /// @param in Pointer to the input samples.
+    /// @param frames Number of samples.
+    /// @param onFrame Callable invoked as onFrame(const std::complex<float>*
+    /// spectrum, const float* power) for every frame.
+    template <typename OnFrame>
+    void analyze(const float* in, std::size_t frames, OnFrame&& onFrame);
+
+    /// @brief Filters samples in the frequency domain, delayed by one frame.
+    /// @param in Pointer to the input samples.
+    /// @param out Pointer to the output samples, may equal the input.
+    /// @param frames Number of samples.
+    /// @param processFrame Callable invoked as processFrame(
+    /// std::complex<float>* spectrum) for every frame. The spectrum holds a
+    /// copy of spectrum() to be modified in place; power() is readable.
+    template <typename ProcessFrame>
+    void process(const float* in, float* out, std::size_t frames,
+                 ProcessFrame&& processFrame);
+};
+
+template <typename OnFrame>
+void SlidingStft::analyze(const float* in, std::size_t frames,
+                          OnFrame&& onFrame)
+{
+    while (frames > 0) {
+        std::size_t chunk = std::min(frames, mHop - mFill);
+        std::copy(in, in + chunk, mHistory.begin() + mHead + mFill);
+        mFill += chunk;
+        in += chunk;
+        frames -= chunk;
+
+        if (mFill == mHop) {
+            analyzeFrame();
+            onFrame(mSpectrum.data(), mPower.data());
+        }
+    }
+}
+
+template <typename ProcessFrame>
+void SlidingStft::process(const float* in, float* out, std::size_t frames,
+                          ProcessFrame&& processFrame)
+{
+    while (frames > 0) {
+        // the free hop space always equals the unread finished hop
+        std::size_t chunk = std::min(frames, mHop - mFill);
+        std::copy(in, in + chunk, mHistory.begin() + mHead + mFill);
+        std::copy(mReady.begin() + mFill, mReady.begin() + mFill + chunk, out);
+        mFill += chunk;
+        in += chunk;
+        out += chunk;
+        frames -= chunk;
+
+        if (mFill == mHop) {
+            analyzeFrame();
+            std::copy(mSpectrum.begin(), mSpectrum.end(), mFiltered.begin());
+            processFrame(mFiltered.data());
+            synthesizeFrame();
+        }
+    }
+}
+
+#endif // SLIDING_STFT_H
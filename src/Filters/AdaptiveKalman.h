@@ -1,3 +1,6 @@
+#ifndef ADAPTIVE_KALMAN_H
+#define ADAPTIVE_KALMAN_H
+
 class AdaptiveKalmanFilter
 {
   private:
@@ -37,3 +40,5 @@ class AdaptiveKalmanFilter
         return m_x;
     }
 };
+
+#endif // ADAPTIVE_KALMAN_H
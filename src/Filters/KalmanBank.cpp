@@ -0,0 +1,126 @@
+#include "KalmanBank.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RTNR_KALMAN_AVX
+#endif
+
+namespace
+{
+/// @brief Error variance of a tracker that has not seen a measurement, far
+/// above any measurement noise so the first measurement is taken as is.
+constexpr float kUnknownVariance = 1e30f;
+/// @brief Number of trackers per block, see KalmanBank::kLanes.
+constexpr std::size_t kLanes = KalmanBank::kLanes;
+
+/// @brief Feeds one measurement to padded trackers. Inlined into each build
+/// of update, so every build vectorizes it for its own instruction set.
+/// @param padded Number of trackers, a multiple of kLanes.
+/// @param forgetting Forgetting factor of the process noise estimate.
+/// @param z Measurement of every tracker.
+/// @param r Measurement noise variance of every tracker.
+/// @param states State estimate of every tracker, updated.
+/// @param variances Error variance of every tracker, updated.
+/// @param noises Process noise variance of every tracker, updated.
+/// @param x Receives the state estimate of every tracker.
+#if defined(__GNUC__)
+__attribute__((always_inline))
+#endif
+inline void updateLanes(std::size_t padded, float forgetting, const float* z,
+                        const float* r, float* states, float* variances,
+                        float* noises, float* x)
+{
+    // one block of kLanes trackers at a time into local lanes, which cannot
+    // alias the arguments, so the lane loop becomes one vector per value
+    for (std::size_t k = 0; k < padded; k += kLanes) {
+        float state[kLanes];
+        float variance[kLanes];
+        float process[kLanes];
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            std::size_t i = k + lane;
+            // the innovation exceeds what the error and the measurement
+            // noise explain by the process noise, averaged and kept positive
+            float innovation = z[i] - states[i];
+            float excess = innovation * innovation - variances[i] - r[i];
+            process[lane] = std::max(
+                forgetting * noises[i] + (1 - forgetting) * excess, 0.0f);
+
+            // predict, then correct; gain * r is (1 - gain) * predicted
+            // without the cancellation for a new tracker
+            float predicted = variances[i] + process[lane];
+            float gain = predicted / (predicted + r[i]);
+            state[lane] = states[i] + gain * innovation;
+            variance[lane] = gain * r[i];
+        }
+        std::copy(state, state + kLanes, states + k);
+        std::copy(variance, variance + kLanes, variances + k);
+        std::copy(process, process + kLanes, noises + k);
+        std::copy(state, state + kLanes, x + k);
+    }
+}
+
+/// @brief Build of updateLanes for the baseline instruction set.
+void updateDefault(std::size_t padded, float forgetting, const float* z,
+                   const float* r, float* states, float* variances,
+                   float* noises, float* x)
+{
+    updateLanes(padded, forgetting, z, r, states, variances, noises, x);
+}
+
+#if defined(RTNR_KALMAN_AVX)
+/// @brief Build of updateLanes for AVX, 8 trackers per instruction. FMA is
+/// left out so the results match the baseline build bit for bit.
+__attribute__((target("avx"))) void
+updateAvx(std::size_t padded, float forgetting, const float* z, const float* r,
+          float* states, float* variances, float* noises, float* x)
+{
+    updateLanes(padded, forgetting, z, r, states, variances, noises, x);
+}
+#endif
+} // namespace
+
+KalmanBank::KalmanBank(std::size_t size, float forgetting) :
+    mPadded((size + kLanes - 1) / kLanes * kLanes), mForgetting(forgetting),
+    mX(mPadded), mP(mPadded), mQ(mPadded), mAvx(false)
+{
+    setAvx(true);
+    reset();
+}
+
+std::size_t KalmanBank::padded() const
+{
+    return mPadded;
+}
+
+void KalmanBank::reset()
+{
+    std::fill(mX.begin(), mX.end(), 0.0f);
+    std::fill(mP.begin(), mP.end(), kUnknownVariance);
+    std::fill(mQ.begin(), mQ.end(), 0.0f);
+}
+
+bool KalmanBank::setAvx(bool enabled)
+{
+    mAvx = false;
+#if defined(RTNR_KALMAN_AVX)
+    // also checks that the operating system saves the AVX registers
+    mAvx = enabled && __builtin_cpu_supports("avx");
+#else
+    (void)enabled;
+#endif
+    return mAvx;
+}
+
+void KalmanBank::update(const float* z, const float* r, float* x)
+{
+#if defined(RTNR_KALMAN_AVX)
+    if (mAvx) {
+        updateAvx(mPadded, mForgetting, z, r, mX.data(), mP.data(), mQ.data(),
+                  x);
+        return;
+    }
+#endif
+    updateDefault(mPadded, mForgetting, z, r, mX.data(), mP.data(),
+                  mQ.data(), x);
+}
@@ -0,0 +1,65 @@
+#ifndef KALMAN_BANK_H
+#define KALMAN_BANK_H
+
+#include <cstddef>
+#include <vector>
+
+/// @brief The KalmanBank class runs many independent scalar Kalman trackers
+/// in lockstep, one per frequency bin. The states are stored as a structure
+/// of arrays and the count is padded to a multiple of kLanes, so one update
+/// is a single branch-free loop the compiler turns into vector code without a
+/// remainder. With GCC and Clang on x86 the loop is also built for AVX, as
+/// 8-wide vectors, and that build runs when the processor supports it; both
+/// give the same results. Each tracker follows a random walk
+/// whose process noise is estimated from its innovations, in the manner of
+/// AdaptiveKalmanFilter: it smooths hard while the measurement only wanders
+/// within its noise and follows at once when it jumps away.
+class KalmanBank
+{
+  private:
+    /// @brief Number of trackers, including the padding.
+    std::size_t mPadded;
+    /// @brief Forgetting factor of the process noise estimate.
+    float mForgetting;
+    /// @brief State estimate of every tracker.
+    std::vector<float> mX;
+    /// @brief Error variance of every tracker.
+    std::vector<float> mP;
+    /// @brief Process noise variance of every tracker.
+    std::vector<float> mQ;
+    /// @brief Flag to run the AVX build of update.
+    bool mAvx;
+
+  public:
+    /// @brief Number of trackers updated per vector instruction on AVX.
+    static constexpr std::size_t kLanes = 8;
+
+    /// @brief Constructor for the KalmanBank class.
+    /// @param size Number of trackers.
+    /// @param forgetting Forgetting factor of the process noise estimate, in
+    /// [0, 1). Defaults to 0.9.
+    KalmanBank(std::size_t size, float forgetting = 0.9f);
+
+    /// @brief Returns the number of trackers including the padding, the
+    /// length of the arrays passed to update.
+    /// @return The padded size, a multiple of kLanes.
+    std::size_t padded() const;
+
+    /// @brief Starts all trackers from zero with an unknown state.
+    void reset();
+
+    /// @brief Picks the build of update, to compare the two.
+    /// @param enabled True for the AVX build, false for the baseline build.
+    /// @return True if the AVX build runs, which needs processor support.
+    bool setAvx(bool enabled);
+
+    /// @brief Feeds one measurement to every tracker.
+    /// @param z Measurement of every tracker, padded() values.
+    /// @param r Measurement noise variance of every tracker, padded() values
+    /// greater than zero.
+    /// @param x Receives the state estimate of every tracker, padded()
+    /// values. May equal z.
+    void update(const float* z, const float* r, float* x);
+};
+
+#endif // KALMAN_BANK_H
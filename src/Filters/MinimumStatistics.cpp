@@ -0,0 +1,83 @@
+#include "MinimumStatistics.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+/// @brief Time constant of the power smoothing in seconds.
+constexpr double kSmoothingSeconds = 0.05;
+/// @brief Span of the minimum search in seconds, longer than a word.
+constexpr double kMinimumSeconds = 1.5;
+/// @brief Number of sub-windows the minimum search is split into.
+constexpr std::size_t kSubWindows = 8;
+/// @brief Mean noise power over the minimum of its smoothed power.
+constexpr float kBias = 2.0f;
+/// @brief Smallest noise power, keeps the ratios finite in silence.
+constexpr float kNoiseFloor = 1e-12f;
+} // namespace
+
+MinimumStatistics::MinimumStatistics(std::size_t bins, double hopSeconds) :
+    mBins(bins),
+    mSmoothing(static_cast<float>(std::exp(-hopSeconds / kSmoothingSeconds))),
+    mSubWindowFrames(std::max<std::size_t>(
+        1, static_cast<std::size_t>(
+               std::lround(kMinimumSeconds / kSubWindows / hopSeconds)))),
+    mSmoothed(bins), mSubMinimum(bins), mMinima(kSubWindows * bins),
+    mSpanMinimum(bins), mNoise(bins)
+{
+    reset();
+}
+
+void MinimumStatistics::reset()
+{
+    std::fill(mSmoothed.begin(), mSmoothed.end(), 0.0f);
+    std::fill(mSubMinimum.begin(), mSubMinimum.end(), FLT_MAX);
+    std::fill(mMinima.begin(), mMinima.end(), FLT_MAX);
+    std::fill(mSpanMinimum.begin(), mSpanMinimum.end(), FLT_MAX);
+    std::fill(mNoise.begin(), mNoise.end(), kNoiseFloor);
+    mSubWindowFill = 0;
+    mSubWindowIndex = 0;
+    mFirstFrame = true;
+}
+
+void MinimumStatistics::update(const float* power)
+{
+    const float smoothing = mFirstFrame ? 0.0f : mSmoothing;
+    mFirstFrame = false;
+    for (std::size_t k = 0; k < mBins; ++k) {
+        mSmoothed[k] = smoothing * mSmoothed[k] + (1 - smoothing) * power[k];
+        mSubMinimum[k] = std::min(mSubMinimum[k], mSmoothed[k]);
+    }
+
+    // a completed sub-window replaces the oldest one in the search span
+    if (++mSubWindowFill == mSubWindowFrames) {
+        std::copy(mSubMinimum.begin(), mSubMinimum.end(),
+                  mMinima.begin() + mSubWindowIndex * mBins);
+        std::fill(mSubMinimum.begin(), mSubMinimum.end(), FLT_MAX);
+        mSubWindowIndex = (mSubWindowIndex + 1) % kSubWindows;
+        mSubWindowFill = 0;
+
+        std::copy(mMinima.begin(), mMinima.begin() + mBins,
+                  mSpanMinimum.begin());
+        for (std::size_t row = 1; row < kSubWindows; ++row) {
+            const float* minima = &mMinima[row * mBins];
+            for (std::size_t k = 0; k < mBins; ++k) {
+                mSpanMinimum[k] = std::min(mSpanMinimum[k], minima[k]);
+            }
+        }
+    }
+
+    // the running sub-window counts too, so a falling floor is followed at
+    // once; sub-windows not filled yet hold FLT_MAX and drop out
+    for (std::size_t k = 0; k < mBins; ++k) {
+        float minimum = std::min(mSpanMinimum[k], mSubMinimum[k]);
+        mNoise[k] = std::max(minimum * kBias, kNoiseFloor);
+    }
+}
+
+const float* MinimumStatistics::noise() const
+{
+    return mNoise.data();
+}
@@ -0,0 +1,59 @@
+#ifndef MINIMUM_STATISTICS_H
+#define MINIMUM_STATISTICS_H
+
+#include <cstddef>
+#include <vector>
+
+/// @brief The MinimumStatistics class estimates the noise power of every
+/// frequency bin without a voice activity detector. The smoothed power of a
+/// bin drops to the noise floor between words, so its minimum over a span
+/// longer than a word, scaled by a fixed bias, tracks the noise floor. The
+/// span is split into sub-windows so that a rising floor is followed after
+/// one sub-window. All loops run over plain float arrays without branches.
+class MinimumStatistics
+{
+  private:
+    /// @brief Number of bins.
+    std::size_t mBins;
+    /// @brief Smoothing factor of the power spectrum.
+    float mSmoothing;
+    /// @brief Frames per sub-window.
+    std::size_t mSubWindowFrames;
+
+    /// @brief Smoothed power of every bin.
+    std::vector<float> mSmoothed;
+    /// @brief Minimum of the smoothed power in the current sub-window.
+    std::vector<float> mSubMinimum;
+    /// @brief Minima of the last completed sub-windows, one row each.
+    std::vector<float> mMinima;
+    /// @brief Minimum over the rows of mMinima.
+    std::vector<float> mSpanMinimum;
+    /// @brief Estimated noise power of every bin.
+    std::vector<float> mNoise;
+    /// @brief Frames seen in the current sub-window.
+    std::size_t mSubWindowFill;
+    /// @brief Row of mMinima the next completed sub-window goes to.
+    std::size_t mSubWindowIndex;
+    /// @brief Flag to indicate that no frame was seen yet.
+    bool mFirstFrame;
+
+  public:
+    /// @brief Constructor for the MinimumStatistics class.
+    /// @param bins Number of frequency bins.
+    /// @param hopSeconds Time between two frames in seconds, sets the time
+    /// constants.
+    MinimumStatistics(std::size_t bins, double hopSeconds);
+
+    /// @brief Forgets the noise estimate.
+    void reset();
+
+    /// @brief Adds the power spectrum of the next frame.
+    /// @param power Power of every bin.
+    void update(const float* power);
+
+    /// @brief Returns the noise estimate after the last update.
+    /// @return Noise power of every bin, never zero.
+    const float* noise() const;
+};
+
+#endif // MINIMUM_STATISTICS_H
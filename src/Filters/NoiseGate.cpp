@@ -1,26 +1,26 @@
 #include "NoiseGate.h"
 
-NoiseGate::NoiseGate(float threshold) : mThreshold(threshold) {}
+#include "../DSP/Kernels.h"
+
+NoiseGate::NoiseGate(float threshold) :
+    mThreshold(threshold), mLinearThreshold(std::pow(10.0f, threshold / 20))
+{}
 
 void NoiseGate::process(const float* in, float* out,
                         unsigned long framesPerBuffer)
 {
-    for (int i = 0; i < framesPerBuffer; ++i) {
-        if (20 * log10(in[i]) > mThreshold) {
-            out[i] = in[i];
-        } else {
-            out[i] = 0;
-        }
-    }
+    // |x| > 10^(t/20) is the same test as 20*log10(|x|) > t
+    GenericKernels::gate(in, out, mLinearThreshold, framesPerBuffer);
 }
 
 void NoiseGate::process(std::vector<float>& buffer)
 {
-    for (auto value : buffer) {
-        if (20 * log10(value) < mThreshold) {
-            value = 0;
-        }
-    }
+    process(buffer.data(), buffer.data(), buffer.size());
+}
+
+float NoiseGate::getLinearThreshold() const
+{
+    return mLinearThreshold;
 }
 
 int NoiseGate::getThreshold()
@@ -31,4 +31,5 @@ int NoiseGate::getThreshold()
 void NoiseGate::setThreshold(int threshold)
 {
     mThreshold = threshold;
+    mLinearThreshold = std::pow(10.0f, mThreshold / 20);
 }
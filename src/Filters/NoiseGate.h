@@ -17,6 +17,9 @@ class NoiseGate : public QObject
     /// @brief A private member variable that stores the threshold value in dB
     /// used to gate the audio signal.
     float mThreshold;
+    /// @brief The threshold as linear amplitude, so the gate compares
+    /// magnitudes instead of taking a logarithm per sample.
+    float mLinearThreshold;
 
   public:
     /// @brief The class constructor that takes a threshold value as input in db
@@ -28,7 +31,8 @@ class NoiseGate : public QObject
     /// @brief The method loops through the audio frames and applies the gating
     /// effect. If a sample value in dB from the input buffer is greater than
     /// the thresholdvalue, it is written to the corresponding sample in the
-    /// output buffer.Otherwise, the sample is set to 0.
+    /// output buffer.Otherwise, the sample is set to 0. The buffers may be the
+    /// same to gate in place.
     /// @param in A pointer to the input audio buffer.
     /// @param out A pointer to the output audio buffer.
     /// @param framesPerBuffer The number of frames in the audio buffer.
@@ -40,6 +44,10 @@ class NoiseGate : public QObject
     /// @param buffer A vector of floats with amplitude values.
     void process(std::vector<float>& buffer);
 
+    /// @brief Returns the threshold as linear amplitude.
+    /// @return The amplitude a sample magnitude must exceed to pass.
+    float getLinearThreshold() const;
+
     /// @brief Returns the threshold value used by the class.
     /// @return An integer representing the threshold value.
     int getThreshold();
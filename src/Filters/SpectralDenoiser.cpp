@@ -0,0 +1,63 @@
+#include "SpectralDenoiser.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// @brief Weight of the previous frame in the a priori SNR.
+constexpr float kDecisionDirected = 0.98f;
+} // namespace
+
+SpectralDenoiser::SpectralDenoiser(int sampleRate, std::size_t frameLen,
+                                   std::size_t hop, float gainFloor) :
+    mStft(frameLen, hop), mBins(mStft.bins()),
+    mNoise(mBins, static_cast<double>(hop) / sampleRate),
+    mGainFloor(std::pow(10.0f, gainFloor / 20))
+{
+    mClean.resize(mBins);
+    mGain.resize(mBins);
+    reset();
+}
+
+std::size_t SpectralDenoiser::latency() const
+{
+    return mStft.latency();
+}
+
+void SpectralDenoiser::reset()
+{
+    mStft.reset();
+    mNoise.reset();
+    std::fill(mClean.begin(), mClean.end(), 0.0f);
+}
+
+void SpectralDenoiser::process(const float* in, float* out,
+                               std::size_t frames)
+{
+    mStft.process(in, out, frames, [this](std::complex<float>* spectrum) {
+        processFrame(spectrum);
+    });
+}
+
+void SpectralDenoiser::processFrame(std::complex<float>* spectrum)
+{
+    const float* power = mStft.power();
+    mNoise.update(power);
+
+    // decision-directed a priori SNR and the Wiener gain, floored
+    const float weight = kDecisionDirected;
+    const float* noise = mNoise.noise();
+    for (std::size_t k = 0; k < mBins; ++k) {
+        float inverseNoise = 1.0f / noise[k];
+        float posterior = power[k] * inverseNoise;
+        float prior = weight * mClean[k] * inverseNoise +
+                      (1 - weight) * std::max(posterior - 1, 0.0f);
+        float gain = std::max(prior / (1 + prior), mGainFloor);
+        mGain[k] = gain;
+        mClean[k] = gain * gain * power[k];
+    }
+    for (std::size_t k = 0; k < mBins; ++k) {
+        spectrum[k] *= mGain[k];
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef SPECTRAL_DENOISER_H
+#define SPECTRAL_DENOISER_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "../DSP/SlidingStft.h"
+#include "MinimumStatistics.h"
+
+/// @brief The SpectralDenoiser class is a short-time Fourier transform Wiener
+/// filter, the cheap alternative to the neural model. Frames
+/// of 1536 samples slide by 384 like the model windows, the noise floor of
+/// every bin is tracked with minimum statistics, so no noise-only segment is
+/// needed, and the decision-directed gain is floored to keep the residual
+/// noise from turning musical. All buffers are allocated by the constructor
+/// and the per-bin loops run over plain float arrays without branches, so the
+/// compiler vectorizes them and process can run on the audio thread.
+class SpectralDenoiser
+{
+  private:
+    /// @brief Frames, transforms and resynthesizes the signal.
+    SlidingStft mStft;
+    /// @brief Number of non-negative frequency bins.
+    std::size_t mBins;
+
+    /// @brief Noise estimate of every bin.
+    MinimumStatistics mNoise;
+    /// @brief Lowest gain of a bin, linear.
+    float mGainFloor;
+
+    /// @brief Estimated clean power of every bin in the previous frame.
+    std::vector<float> mClean;
+    /// @brief Gain of every bin in the current frame.
+    std::vector<float> mGain;
+
+    /// @brief Applies the gain to the spectrum of the newest frame.
+    /// @param spectrum The spectrum, filtered in place.
+    void processFrame(std::complex<float>* spectrum);
+
+  public:
+    /// @brief Constructor for the SpectralDenoiser class.
+    /// @param sampleRate Sample rate, sets the time constants. Defaults to
+    /// 48000.
+    /// @param frameLen Number of samples per frame, a product of 2, 3 and 5.
+    /// Defaults to 1536.
+    /// @param hop Number of samples the frame slides per step, dividing the
+    /// frame at least twice. Defaults to 384.
+    /// @param gainFloor Lowest gain of a bin in dB. Defaults to -20.
+    /// @throws std::invalid_argument If the frame length cannot be
+    /// transformed or the hop does not divide it at least twice.
+    SpectralDenoiser(int sampleRate = 48000, std::size_t frameLen = 1536,
+                     std::size_t hop = 384, float gainFloor = -20);
+
+    /// @brief Returns the delay between input and output.
+    /// @return The latency in samples, one frame.
+    std::size_t latency() const;
+
+    /// @brief Clears the signal and the noise estimate.
+    void reset();
+
+    /// @brief Filters any number of samples.
+    /// @param in Pointer to the input samples.
+    /// @param out Pointer to the output samples, may equal the input.
+    /// @param frames Number of samples.
+    void process(const float* in, float* out, std::size_t frames);
+};
+
+#endif // SPECTRAL_DENOISER_H
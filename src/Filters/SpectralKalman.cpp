@@ -0,0 +1,71 @@
+#include "SpectralKalman.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// @brief Mean magnitude of Rayleigh noise over the square root of its
+/// power, sqrt(pi / 4).
+constexpr float kRayleighMean = 0.886227f;
+/// @brief Variance of the magnitude of Rayleigh noise over its power,
+/// 1 - pi / 4.
+constexpr float kRayleighVariance = 0.214602f;
+/// @brief Smallest magnitude a gain is computed for.
+constexpr float kMagnitudeFloor = 1e-9f;
+} // namespace
+
+SpectralKalman::SpectralKalman(int sampleRate, std::size_t frameLen,
+                               std::size_t hop, float gainFloor) :
+    mStft(frameLen, hop), mBins(mStft.bins()),
+    mNoise(mBins, static_cast<double>(hop) / sampleRate), mBank(mBins),
+    mGainFloor(std::pow(10.0f, gainFloor / 20))
+{
+    // the padding bins stay zero with a unit variance, their trackers idle
+    mMagnitude.assign(mBank.padded(), 0.0f);
+    mTracked.assign(mBank.padded(), 0.0f);
+    mVariance.assign(mBank.padded(), 1.0f);
+    reset();
+}
+
+std::size_t SpectralKalman::latency() const
+{
+    return mStft.latency();
+}
+
+void SpectralKalman::reset()
+{
+    mStft.reset();
+    mNoise.reset();
+    mBank.reset();
+}
+
+void SpectralKalman::process(const float* in, float* out, std::size_t frames)
+{
+    mStft.process(in, out, frames, [this](std::complex<float>* spectrum) {
+        processFrame(spectrum);
+    });
+}
+
+void SpectralKalman::processFrame(std::complex<float>* spectrum)
+{
+    const float* power = mStft.power();
+    for (std::size_t k = 0; k < mBins; ++k) {
+        mMagnitude[k] = std::sqrt(power[k]);
+    }
+    mNoise.update(power);
+
+    // the noise adds its mean to the magnitude and its spread as the
+    // measurement noise
+    const float* noise = mNoise.noise();
+    for (std::size_t k = 0; k < mBins; ++k) {
+        mTracked[k] = mMagnitude[k] - kRayleighMean * std::sqrt(noise[k]);
+        mVariance[k] = kRayleighVariance * noise[k];
+    }
+    mBank.update(mTracked.data(), mVariance.data(), mTracked.data());
+
+    for (std::size_t k = 0; k < mBins; ++k) {
+        float gain = mTracked[k] / std::max(mMagnitude[k], kMagnitudeFloor);
+        spectrum[k] *= std::min(std::max(gain, mGainFloor), 1.0f);
+    }
+}
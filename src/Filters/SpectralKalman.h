@@ -0,0 +1,74 @@
+#ifndef SPECTRAL_KALMAN_H
+#define SPECTRAL_KALMAN_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "../DSP/SlidingStft.h"
+#include "KalmanBank.h"
+#include "MinimumStatistics.h"
+
+/// @brief The SpectralKalman class tracks the clean magnitude of every STFT
+/// bin with a KalmanBank, one tracker per bin (769 for 1536 sample frames).
+/// The measurement is the noisy magnitude minus the mean magnitude of the
+/// noise, whose variance is the measurement noise; both follow from the
+/// minimum statistics noise power under a Rayleigh model. The tracked
+/// magnitude over the noisy one is applied as a gain, between a floor and
+/// one, so the filter can run before or after the model without adding
+/// energy. Framing and latency are those of SpectralDenoiser.
+class SpectralKalman
+{
+  private:
+    /// @brief Frames, transforms and resynthesizes the signal.
+    SlidingStft mStft;
+    /// @brief Number of non-negative frequency bins.
+    std::size_t mBins;
+
+    /// @brief Noise estimate of every bin.
+    MinimumStatistics mNoise;
+    /// @brief Magnitude tracker of every bin.
+    KalmanBank mBank;
+    /// @brief Lowest gain of a bin, linear.
+    float mGainFloor;
+
+    /// @brief Magnitude of every bin, padded for the bank.
+    std::vector<float> mMagnitude;
+    /// @brief Measurement of every bin, then its tracked magnitude.
+    std::vector<float> mTracked;
+    /// @brief Measurement noise variance of every bin.
+    std::vector<float> mVariance;
+
+    /// @brief Applies the gain to the spectrum of the newest frame.
+    /// @param spectrum The spectrum, filtered in place.
+    void processFrame(std::complex<float>* spectrum);
+
+  public:
+    /// @brief Constructor for the SpectralKalman class.
+    /// @param sampleRate Sample rate, sets the time constants. Defaults to
+    /// 48000.
+    /// @param frameLen Number of samples per frame, a product of 2, 3 and 5.
+    /// Defaults to 1536.
+    /// @param hop Number of samples the frame slides per step, dividing the
+    /// frame at least twice. Defaults to 384.
+    /// @param gainFloor Lowest gain of a bin in dB. Defaults to -20.
+    /// @throws std::invalid_argument If the frame length cannot be
+    /// transformed or the hop does not divide it at least twice.
+    SpectralKalman(int sampleRate = 48000, std::size_t frameLen = 1536,
+                   std::size_t hop = 384, float gainFloor = -20);
+
+    /// @brief Returns the delay between input and output.
+    /// @return The latency in samples, one frame.
+    std::size_t latency() const;
+
+    /// @brief Clears the signal, the noise estimate and the trackers.
+    void reset();
+
+    /// @brief Filters any number of samples.
+    /// @param in Pointer to the input samples.
+    /// @param out Pointer to the output samples, may equal the input.
+    /// @param frames Number of samples.
+    void process(const float* in, float* out, std::size_t frames);
+};
+
+#endif // SPECTRAL_KALMAN_H
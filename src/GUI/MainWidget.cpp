@@ -1,6 +1,16 @@
 #include "MainWidget.h"
 
-MainWidget::MainWidget(QWidget* parent) : QWidget(parent)
+namespace
+{
+/// @brief Interval of the GUI poll in milliseconds, fast enough for the
+/// level meter.
+constexpr int kPollIntervalMs = 50;
+/// @brief Number of polls between two refreshes of the performance panel.
+constexpr int kPanelPolls = 5;
+} // namespace
+
+MainWidget::MainWidget(QWidget* parent, const std::string& modelFilepath) :
+    QWidget(parent)
 {
     // init class members
     mAppNameText = new TextLabel("Real-time\nNoise Reduction",
@@ -22,9 +32,22 @@ MainWidget::MainWidget(QWidget* parent) : QWidget(parent)
 
     mAudioChart = new AudioChart(this);
 
+    mPerformanceText =
+        new TextLabel("Performance:", QFont("Arial", 12), Qt::AlignLeft, this);
+    mPerformancePanel = new PerformancePanel(this);
+    // the GUI polls the stream, the audio thread never posts events to it
+    mPerformanceTimer = new QTimer(this);
+    mPerformanceTimer->setInterval(kPollIntervalMs);
+    mWorstStall = 0;
+    mPolls = 0;
+
     mLayout = new QVBoxLayout(this);
 
-    mAudioStream = std::make_unique<AudioStream>();
+    mAudioStream = std::make_unique<AudioStream>(modelFilepath);
+    mStreamController = std::make_unique<StreamController>(*mAudioStream);
+    // the spectrogram reads the tap of the stream, so it comes after it
+    mSpectrogram = new Spectrogram(mAudioStream->getSpectrumTap(),
+                                   mAudioStream->getSampleRate(), this);
     mCurMicIndex = 0;
 
     // Initialize system tray and its menu
@@ -43,6 +66,12 @@ MainWidget::MainWidget(QWidget* parent) : QWidget(parent)
     connectAll();
 }
 
+MainWidget::~MainWidget()
+{
+    // child widgets outlive the members, the worker must stop first
+    delete mSpectrogram;
+}
+
 void MainWidget::addAllMicToList()
 {
     mMicDropDownList->addItem("--Nothing selected--");
@@ -79,12 +108,19 @@ void MainWidget::construct()
 
     mAudioChartLayout = new QVBoxLayout();
     mAudioChartLayout->addWidget(mAudioChart);
+    mAudioChartLayout->addWidget(mSpectrogram);
+
+    mPerformanceLayout = new QVBoxLayout();
+    mPerformanceLayout->addWidget(mPerformanceText);
+    mPerformanceLayout->addWidget(mPerformancePanel);
+    mPerformanceLayout->setContentsMargins(0, 20, 0, 0);
 
     mLayout->addLayout(mLogoNameLayout);
     mLayout->addLayout(mMicDropDownLayout);
     mLayout->addLayout(mMicNoiseToggleLayout);
     mLayout->addLayout(mNoiseGateLayout);
     mLayout->addLayout(mAudioChartLayout);
+    mLayout->addLayout(mPerformanceLayout);
 
     setLayout(mLayout);
 }
@@ -100,6 +136,7 @@ void MainWidget::adjustWindowSettings()
     mMicDropDownList->setMaximumWidth(320);
     mAudioChart->setMaximumHeight(200);
     mGateText->setMinimumHeight(20);
+    mPerformanceText->setMinimumHeight(20);
 
     // set window size
     this->setMinimumWidth(320);
@@ -150,40 +187,78 @@ void MainWidget::connectAll()
     connect(mGateSlider->getSlider(), &QSlider::valueChanged,
             mAudioStream.get()->mNoiseGate.get(), &NoiseGate::setThreshold);
 
-    // set volume bar value on receipt of a sound signal
-    connect(mAudioStream.get(), &AudioStream::tick, mGateSlider->getVolumeBar(),
-            &QProgressBar::setValue);
-
-    // update audio chart on receipt of a sound signal
-    connect(mAudioStream.get(), &AudioStream::tickGated, mAudioChart,
-            &AudioChart::appendData);
+    // results of the device commands arrive queued on the GUI thread
+    connect(mStreamController.get(), &StreamController::streamOpened, this,
+            &MainWidget::streamOpened);
+    connect(mStreamController.get(), &StreamController::streamClosed, this,
+            &MainWidget::streamClosed);
+
+    // poll the output levels and the performance counters of the stream
+    connect(mPerformanceTimer, &QTimer::timeout, this,
+            &MainWidget::updatePerformance);
+    mPerformanceTimer->start();
+    mStallClock.start();
 }
 
 void MainWidget::getMicDeviceIndex()
 {
+    // the toggle waits for the stream, the command runs off the GUI thread
+    mMicNoiseToggleButton->setEnabled(false);
+
     if (mMicDropDownList->currentIndex() != 0) {
         mCurMicIndex = mMicDropDownList->currentIndex() - 1;
         printf("Current mic index: %d\n", mCurMicIndex);
 
-        // enable toggle button
-        mMicNoiseToggleButton->setEnabled(true);
-
         // open stream to selected microphone
-        mAudioStream.get()->openStream(mCurMicIndex);
+        mStreamController->openStream(mCurMicIndex);
     } else {
         printf("Current mic: nothing selected\n");
 
-        // disable toggle button
-        mMicNoiseToggleButton->setEnabled(false);
-
         // set volume leveler value to zero
         mGateSlider->getVolumeBar()->setValue(-100);
 
         // close stream
-        mAudioStream.get()->closeStream();
+        mStreamController->closeStream();
     }
 }
 
+void MainWidget::streamOpened(int deviceId, bool opened)
+{
+    if (!opened) {
+        printf("Cannot open mic index: %d\n", deviceId);
+        return;
+    }
+
+    // enable toggle button
+    mMicNoiseToggleButton->setEnabled(true);
+}
+
+void MainWidget::streamClosed()
+{
+    // a poll before the close may have moved the leveler
+    mGateSlider->getVolumeBar()->setValue(-100);
+}
+
+void MainWidget::setRealTimeMode(bool status)
+{
+    mStreamController->setRealTimeMode(status);
+}
+
+void MainWidget::setSpectralKalman(StagePlacement placement)
+{
+    mStreamController->setSpectralKalman(placement);
+}
+
+void MainWidget::openSharedSink(const std::string& name)
+{
+    mStreamController->openSharedSink(name);
+}
+
+void MainWidget::startRecording(const RecorderOptions& options)
+{
+    mStreamController->startRecording(options);
+}
+
 void MainWidget::reduceNoise()
 {
     // if the toggle button that enables/disables noise cancellation is checked
@@ -192,13 +267,13 @@ void MainWidget::reduceNoise()
         mMicDropDownList->setDisabled(true);
 
         // activate noise reduction
-        mAudioStream.get()->setReduceNoise(true);
+        mStreamController->setReduceNoise(true);
     } else {
         // enable drop-down list
         mMicDropDownList->setDisabled(false);
 
         // disable noise reduction
-        mAudioStream.get()->setReduceNoise(false);
+        mStreamController->setReduceNoise(false);
     }
 }
 
@@ -237,3 +312,34 @@ void MainWidget::onExitAction()
 {
     QApplication::quit();
 }
+
+void MainWidget::updatePerformance()
+{
+    // the poll is late by as long as the event loop was blocked
+    double elapsed = mStallClock.restart() / 1000.0;
+    double stall = elapsed - mPerformanceTimer->interval() / 1000.0;
+    mWorstStall = std::max(mWorstStall, stall);
+    mPerformancePanel->setUiStall(mWorstStall);
+
+    // the audio thread publishes the levels of its last block in atomics
+    OutputLevels levels;
+    if (mStreamController->isStreamOpen()) {
+        levels = mAudioStream->getOutputLevels();
+    }
+    mGateSlider->getVolumeBar()->setValue(
+        OutputStage::toDecibels(levels.peak));
+    mAudioChart->appendData(levels.peak);
+
+    // the counters change slowly, the panel is refreshed every few polls
+    if (++mPolls % kPanelPolls != 0) {
+        return;
+    }
+
+    // while a device command runs the last values stay
+    PerformanceStats stats;
+    if (mStreamController->tryGetPerformanceStats(stats)) {
+        mPerformancePanel->setStats(stats);
+    } else if (!mStreamController->isStreamOpen()) {
+        mPerformancePanel->clear();
+    }
+}
@@ -2,22 +2,27 @@
 #define MAIN_WIDGET_H
 
 #include <QAction>
+#include <QElapsedTimer>
 #include <QApplication>
 #include <QEvent>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMenu>
 #include <QSystemTrayIcon>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 #include <memory>
 
 #include "../Stream/AudioStream.h"
+#include "../Stream/StreamController.h"
 #include "AudioChart/AudioChart.h"
 #include "DropDownList/DropDownList.h"
 #include "GateSlider/GateSlider.h"
 #include "Icon/Icon.h"
 #include "Logo/Logo.h"
+#include "PerformancePanel/PerformancePanel.h"
+#include "Spectrogram/Spectrogram.h"
 #include "TextLabel/TextLabel.h"
 #include "ToggleButton/ToggleButton.h"
 
@@ -53,6 +58,22 @@ class MainWidget : public QWidget
 
     /// @brief The real-time audio chart widget.
     AudioChart* mAudioChart;
+    /// @brief The scrolling spectrograms of the input and the output.
+    Spectrogram* mSpectrogram;
+
+    /// @brief The label that displays the "Performance:" text before the
+    /// performance panel.
+    TextLabel* mPerformanceText;
+    /// @brief The live performance counters of the stream.
+    PerformancePanel* mPerformancePanel;
+    /// @brief Timer polling the output levels and the performance counters.
+    QTimer* mPerformanceTimer;
+    /// @brief Number of polls so far.
+    int mPolls;
+    /// @brief Time since the last poll, its lateness is a GUI stall.
+    QElapsedTimer mStallClock;
+    /// @brief Longest GUI stall in seconds.
+    double mWorstStall;
 
     /// @brief The main vertical layout of the widget.
     QVBoxLayout* mLayout;
@@ -73,11 +94,19 @@ class MainWidget : public QWidget
     /// leveler and gate slider for it.
     QVBoxLayout* mNoiseGateLayout;
 
-    /// @brief The vertical layout that contains real-time audio chart.
+    /// @brief The vertical layout that contains real-time audio chart and the
+    /// spectrograms.
     QVBoxLayout* mAudioChartLayout;
 
+    /// @brief The vertical layout that contains "Performance:" label and the
+    /// performance panel.
+    QVBoxLayout* mPerformanceLayout;
+
     /// @brief Audio stream manager class smart pointer.
     std::unique_ptr<AudioStream> mAudioStream;
+    /// @brief Runs the device commands of the stream off the GUI thread.
+    /// Declared after the stream, so it stops before the stream goes.
+    std::unique_ptr<StreamController> mStreamController;
     /// @brief Current microphone index selected for noise reduction
     int mCurMicIndex;
 
@@ -109,7 +138,31 @@ class MainWidget : public QWidget
   public:
     /// @brief Constructs a new MainWidget object.
     /// @param parent The parent widget.
-    MainWidget(QWidget* parent = nullptr);
+    /// @param modelFilepath Path to the noise reduction model directory or to
+    /// a manifest of model variants.
+    MainWidget(QWidget* parent = nullptr,
+               const std::string& modelFilepath = "./model");
+    /// @brief Destroys the spectrogram before the stream whose tap it reads.
+    ~MainWidget();
+
+    /// @brief Requests real-time scheduling, memory locking and denormal
+    /// protection for the audio stream. Takes effect on the next stream open.
+    /// @param status Boolean to set.
+    void setRealTimeMode(bool status);
+
+    /// @brief Runs the per-bin Kalman filter before or after the model.
+    /// Takes effect on the next stream open.
+    /// @param placement Where the filter runs, Off to remove it.
+    void setSpectralKalman(StagePlacement placement);
+
+    /// @brief Publishes the processed audio to a shared memory ring that
+    /// other local processes read. Takes effect on the next stream open.
+    /// @param name Name of the shared memory.
+    void openSharedSink(const std::string& name);
+
+    /// @brief Records the input and the processed output to disk.
+    /// @param options File, rotation and buffer settings.
+    void startRecording(const RecorderOptions& options);
 
   public slots:
     /// @brief Slot function for retrieving microphone device system index after
@@ -123,6 +176,17 @@ class MainWidget : public QWidget
     void trayIconActivated(QSystemTrayIcon::ActivationReason reason);
     /// @brief Slot function to exit app on tray menu exit option click.
     void onExitAction();
+    /// @brief Slot function to refresh the level meter and the chart from the
+    /// stream levels, every few polls the performance panel from the stream
+    /// counters, and to measure how late the GUI thread served the poll.
+    void updatePerformance();
+    /// @brief Slot function to enable noise reduction once the selected
+    /// microphone is open.
+    /// @param deviceId The device ID.
+    /// @param opened Flag to indicate that the stream is running.
+    void streamOpened(int deviceId, bool opened);
+    /// @brief Slot function to reset the controls once the stream is closed.
+    void streamClosed();
 };
 
 #endif // MAIN_WIDGET_H
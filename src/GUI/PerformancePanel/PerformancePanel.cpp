@@ -0,0 +1,110 @@
+#include "PerformancePanel.h"
+
+namespace
+{
+/// @brief Load over which the stream is close to dropping audio.
+constexpr double kLoadWarning = 0.8;
+/// @brief GUI stall over which frames are visibly dropped, three at 60 Hz.
+constexpr double kStallWarning = 0.05;
+/// @brief Names of the processing tiers, indexed by ProcessingTier.
+const char* kTierNames[] = {"model", "gate + Kalman", "gate"};
+} // namespace
+
+PerformancePanel::PerformancePanel(QWidget* parent) : QWidget(parent)
+{
+    mLayout = new QGridLayout(this);
+    mLayout->setContentsMargins(0, 0, 0, 0);
+
+    mLoadValue = addRow(0, "DSP load:");
+    mBlockTimeValue = addRow(1, "Block p50 / p99:");
+    mRealTimeFactorValue = addRow(2, "Real-time factor:");
+    mXrunsValue = addRow(3, "Dropouts:");
+    mLatencyValue = addRow(4, "Latency:");
+    mTierValue = addRow(5, "Processing tier:");
+    mSinkValue = addRow(6, "Shared sink:");
+    mRecordingValue = addRow(7, "Recording:");
+    mUiStallValue = addRow(8, "GUI stall (worst):");
+
+    setLayout(mLayout);
+    clear();
+    setUiStall(0);
+}
+
+QLabel* PerformancePanel::addRow(int row, const QString& name)
+{
+    QLabel* nameLabel = new QLabel(name, this);
+    nameLabel->setFont(QFont("Arial", 10));
+    QLabel* valueLabel = new QLabel(this);
+    valueLabel->setFont(QFont("Arial", 10));
+    valueLabel->setAlignment(Qt::AlignRight);
+
+    mLayout->addWidget(nameLabel, row, 0);
+    mLayout->addWidget(valueLabel, row, 1);
+    return valueLabel;
+}
+
+void PerformancePanel::setWarning(QLabel* label, bool warning)
+{
+    label->setStyleSheet(warning ? "color: red;" : "");
+}
+
+void PerformancePanel::setStats(const PerformanceStats& stats)
+{
+    mLoadValue->setText(QString("%1 % (peak %2 %)")
+                            .arg(stats.callbackLoad * 100, 0, 'f', 0)
+                            .arg(stats.callbackPeakLoad * 100, 0, 'f', 0));
+    setWarning(mLoadValue, stats.callbackPeakLoad > kLoadWarning);
+
+    mBlockTimeValue->setText(QString("%1 / %2 ms")
+                                 .arg(stats.blockP50 * 1000, 0, 'f', 1)
+                                 .arg(stats.blockP99 * 1000, 0, 'f', 1));
+
+    mRealTimeFactorValue->setText(
+        QString::number(stats.realTimeFactor, 'f', 2));
+    setWarning(mRealTimeFactorValue, stats.realTimeFactor > kLoadWarning);
+
+    mXrunsValue->setText(QString::number(stats.xruns));
+    setWarning(mXrunsValue, stats.xruns > 0);
+
+    mLatencyValue->setText(
+        QString("%1 ms").arg(stats.latency * 1000, 0, 'f', 1));
+
+    // a cheaper tier means the model could not keep up
+    mTierValue->setText(kTierNames[stats.tier]);
+    setWarning(mTierValue, stats.tier != 0);
+
+    if (stats.sinkOpen) {
+        mSinkValue->setText(QString("%1 readers, lag %2, overruns %3")
+                                .arg(stats.sinkReaders)
+                                .arg(stats.sinkReaderLag)
+                                .arg(stats.sinkOverruns));
+    } else {
+        mSinkValue->setText("off");
+    }
+    setWarning(mSinkValue, stats.sinkOverruns > 0);
+
+    if (stats.recording) {
+        mRecordingValue->setText(QString("%1 blocks, %2 dropped")
+                                     .arg(stats.recordedBlocks)
+                                     .arg(stats.recordDropped));
+    } else {
+        mRecordingValue->setText("off");
+    }
+    setWarning(mRecordingValue, stats.recordDropped > 0);
+}
+
+void PerformancePanel::clear()
+{
+    for (QLabel* label : {mLoadValue, mBlockTimeValue, mRealTimeFactorValue,
+                          mXrunsValue, mLatencyValue, mTierValue, mSinkValue,
+                          mRecordingValue}) {
+        label->setText("-");
+        setWarning(label, false);
+    }
+}
+
+void PerformancePanel::setUiStall(double seconds)
+{
+    mUiStallValue->setText(QString("%1 ms").arg(seconds * 1000, 0, 'f', 0));
+    setWarning(mUiStallValue, seconds > kStallWarning);
+}
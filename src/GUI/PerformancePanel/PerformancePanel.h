@@ -0,0 +1,69 @@
+#ifndef PERFORMANCE_PANEL_H
+#define PERFORMANCE_PANEL_H
+
+#include <QFont>
+#include <QGridLayout>
+#include <QLabel>
+#include <QWidget>
+
+#include "../../Stream/PerformanceMonitor.h"
+
+/// @brief The PerformancePanel class is a custom QWidget that displays the
+/// live performance counters of the audio stream: callback load, block
+/// processing percentiles, xruns, end-to-end latency, the real-time factor
+/// and the processing tier. Values close to their limits are highlighted.
+class PerformancePanel : public QWidget
+{
+    Q_OBJECT
+
+  private:
+    /// @brief The grid of name and value labels.
+    QGridLayout* mLayout;
+    /// @brief The label that displays the callback load.
+    QLabel* mLoadValue;
+    /// @brief The label that displays the block processing percentiles.
+    QLabel* mBlockTimeValue;
+    /// @brief The label that displays the real-time factor.
+    QLabel* mRealTimeFactorValue;
+    /// @brief The label that displays the xrun count.
+    QLabel* mXrunsValue;
+    /// @brief The label that displays the end-to-end latency.
+    QLabel* mLatencyValue;
+    /// @brief The label that displays the processing tier.
+    QLabel* mTierValue;
+    /// @brief Value of the shared memory sink row.
+    QLabel* mSinkValue;
+    /// @brief Value of the recording row.
+    QLabel* mRecordingValue;
+    /// @brief Value of the GUI stall row.
+    QLabel* mUiStallValue;
+
+    /// @brief Private helper function to add one row to the grid.
+    /// @param row The row index.
+    /// @param name The text of the name label.
+    /// @return The value label of the row.
+    QLabel* addRow(int row, const QString& name);
+
+    /// @brief Private helper function to highlight a value over its limit.
+    /// @param label The value label.
+    /// @param warning Flag to indicate that the value is over its limit.
+    void setWarning(QLabel* label, bool warning);
+
+  public:
+    /// @brief Constructor for the PerformancePanel class.
+    /// @param parent The parent widget. Default is nullptr.
+    PerformancePanel(QWidget* parent = nullptr);
+
+  public slots:
+    /// @brief Slot function to display a new snapshot.
+    /// @param stats The performance counters.
+    void setStats(const PerformanceStats& stats);
+    /// @brief Slot function to show that no stream is open.
+    void clear();
+    /// @brief Slot function to display the longest GUI thread stall, which
+    /// does not depend on the stream.
+    /// @param seconds The stall in seconds.
+    void setUiStall(double seconds);
+};
+
+#endif // PERFORMANCE_PANEL_H
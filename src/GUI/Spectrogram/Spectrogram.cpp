@@ -0,0 +1,244 @@
+#include "Spectrogram.h"
+
+#include <QPainter>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "../../Util/Trace.h"
+
+namespace
+{
+/// @brief Interval between two passes of the worker.
+constexpr std::chrono::milliseconds kAnalysisInterval(10);
+/// @brief Interval between two display frames, about 60 per second.
+constexpr int kFrameInterval = 16;
+/// @brief Number of finished columns the worker can queue ahead.
+constexpr std::size_t kColumnQueue = 64;
+/// @brief Number of samples read from the tap at once.
+constexpr std::size_t kReadFrames = 4096;
+/// @brief Frequency of the lowest row.
+constexpr double kLowestFrequency = 60;
+/// @brief Level shown as the darkest colour, in dB below full scale.
+constexpr float kFloorDb = -100;
+/// @brief Height of the gap between the panes, in pixels.
+constexpr int kGap = 4;
+
+/// @brief Colour stops of the palette, dark to bright.
+constexpr int kStops[][3] = {{0, 0, 4},
+                             {87, 16, 110},
+                             {188, 55, 84},
+                             {249, 142, 9},
+                             {252, 255, 164}};
+} // namespace
+
+Spectrogram::Spectrogram(SpectrumTap& tap, int sampleRate, QWidget* parent) :
+    QWidget(parent), mTap(tap), mInput(kReadFrames), mOutput(kReadFrames),
+    mColumns(kColumnQueue), mWriteColumn(0), mStop(false)
+{
+    // log-spaced rows from the lowest frequency to Nyquist, at least one bin
+    std::size_t bins = mInputStft.bins();
+    double binWidth = static_cast<double>(sampleRate) / mInputStft.frameLen();
+    double ratio = sampleRate / 2 / kLowestFrequency;
+    mRowBins.resize(kRows + 1);
+    mRowBins[0] = static_cast<std::size_t>(kLowestFrequency / binWidth);
+    for (int row = 1; row <= kRows; ++row) {
+        double exponent = static_cast<double>(row) / kRows;
+        double frequency = kLowestFrequency * std::pow(ratio, exponent);
+        auto bin = static_cast<std::size_t>(std::lround(frequency / binWidth));
+        mRowBins[row] = std::min(std::max(bin, mRowBins[row - 1] + 1), bins);
+    }
+
+    const int stops = sizeof(kStops) / sizeof(kStops[0]);
+    for (int i = 0; i < 256; ++i) {
+        double position = i / 255.0 * (stops - 1);
+        int stop = std::min(static_cast<int>(position), stops - 2);
+        double t = position - stop;
+        int channel[3];
+        for (int c = 0; c < 3; ++c) {
+            channel[c] = static_cast<int>(std::lround(
+                kStops[stop][c] + t * (kStops[stop + 1][c] - kStops[stop][c])));
+        }
+        mPalette[i] = qRgb(channel[0], channel[1], channel[2]);
+    }
+
+    setFixedHeight(2 * kRows + kGap);
+    setMinimumWidth(160);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    resetImage();
+
+    mFrameTimer = new QTimer(this);
+    mFrameTimer->setInterval(kFrameInterval);
+    mFrameTimer->setTimerType(Qt::PreciseTimer);
+    connect(mFrameTimer, &QTimer::timeout, this, &Spectrogram::refresh);
+}
+
+Spectrogram::~Spectrogram()
+{
+    stop();
+}
+
+void Spectrogram::start()
+{
+    if (mWorker.joinable()) {
+        return;
+    }
+
+    // the worker is idle, so its state can be cleared here
+    mInputStft.reset();
+    mOutputStft.reset();
+    Column column;
+    while (mColumns.pop(column)) {
+    }
+    mTap.attach();
+
+    mStop = false;
+    mWorker = std::thread(&Spectrogram::work, this);
+    mFrameTimer->start();
+}
+
+void Spectrogram::stop()
+{
+    if (!mWorker.joinable()) {
+        return;
+    }
+
+    mFrameTimer->stop();
+    mTap.detach();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mWorker.join();
+}
+
+void Spectrogram::work()
+{
+    RTNR_TRACE_THREAD("spectrogram");
+    bool stopping = false;
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait_for(lock, kAnalysisInterval, [this]() { return mStop; });
+            stopping = mStop;
+        }
+        analyze();
+    }
+}
+
+void Spectrogram::analyze()
+{
+    RTNR_TRACE_SCOPE("spectrogram_analyze");
+    std::size_t hop = mInputStft.hop();
+    std::size_t frames;
+    while ((frames = mTap.read(mInput.data(), mOutput.data(), kReadFrames)) >
+           0) {
+        // both transforms see the same samples, so they finish a frame in
+        // the same chunk of at most one hop
+        for (std::size_t offset = 0; offset < frames; offset += hop) {
+            std::size_t chunk = std::min(hop, frames - offset);
+            mInputStft.analyze(
+                &mInput[offset], chunk,
+                [this](const std::complex<float>*, const float* power) {
+                    mapRows(power, mColumn.data());
+                });
+            mOutputStft.analyze(
+                &mOutput[offset], chunk,
+                [this](const std::complex<float>*, const float* power) {
+                    mapRows(power, mColumn.data() + kRows);
+                    // a full queue means the display is stalled, skip
+                    mColumns.push(mColumn);
+                });
+        }
+    }
+}
+
+void Spectrogram::mapRows(const float* power, QRgb* pixels) const
+{
+    // a full scale sine peaks at (frameLen / pi)^2 through the sqrt-Hann
+    const double pi = std::acos(-1.0);
+    const float fullScale = static_cast<float>(
+        pi * pi / (static_cast<double>(mInputStft.frameLen()) *
+                   mInputStft.frameLen()));
+    const float scale = 255 / -kFloorDb;
+
+    for (int row = 0; row < kRows; ++row) {
+        float peak = *std::max_element(power + mRowBins[row],
+                                       power + mRowBins[row + 1]);
+        float level = 10 * std::log10(peak * fullScale + 1e-12f);
+        float step = std::min(std::max((level - kFloorDb) * scale, 0.0f),
+                              255.0f);
+        pixels[row] = mPalette[static_cast<int>(step)];
+    }
+}
+
+void Spectrogram::resetImage()
+{
+    mImage = QImage(std::max(width(), 1), height(), QImage::Format_RGB32);
+    mImage.fill(mPalette[0]);
+    // the gap between the panes stays in the background colour
+    for (int y = kRows; y < kRows + kGap; ++y) {
+        auto* line = reinterpret_cast<QRgb*>(mImage.scanLine(y));
+        std::fill(line, line + mImage.width(), qRgb(255, 255, 255));
+    }
+    mWriteColumn = 0;
+}
+
+void Spectrogram::refresh()
+{
+    Column column;
+    bool changed = false;
+    while (mColumns.pop(column)) {
+        // the newest column overwrites the oldest, the rows run upwards
+        for (int row = 0; row < kRows; ++row) {
+            auto* input =
+                reinterpret_cast<QRgb*>(mImage.scanLine(kRows - 1 - row));
+            auto* output = reinterpret_cast<QRgb*>(
+                mImage.scanLine(2 * kRows + kGap - 1 - row));
+            input[mWriteColumn] = column[row];
+            output[mWriteColumn] = column[kRows + row];
+        }
+        mWriteColumn = (mWriteColumn + 1) % mImage.width();
+        changed = true;
+    }
+
+    if (changed) {
+        update();
+    }
+}
+
+void Spectrogram::paintEvent(QPaintEvent* e)
+{
+    // the oldest column is the next one to be written, it goes left
+    QPainter painter(this);
+    int width = mImage.width();
+    int height = mImage.height();
+    painter.drawImage(QPoint(0, 0), mImage,
+                      QRect(mWriteColumn, 0, width - mWriteColumn, height));
+    painter.drawImage(QPoint(width - mWriteColumn, 0), mImage,
+                      QRect(0, 0, mWriteColumn, height));
+
+    painter.setPen(Qt::white);
+    painter.setFont(QFont("Arial", 8));
+    painter.drawText(4, 12, "Input");
+    painter.drawText(4, kRows + kGap + 12, "Output");
+}
+
+void Spectrogram::resizeEvent(QResizeEvent* e)
+{
+    resetImage();
+    QWidget::resizeEvent(e);
+}
+
+void Spectrogram::showEvent(QShowEvent* e)
+{
+    start();
+    QWidget::showEvent(e);
+}
+
+void Spectrogram::hideEvent(QHideEvent* e)
+{
+    stop();
+    QWidget::hideEvent(e);
+}
@@ -0,0 +1,111 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <QImage>
+#include <QTimer>
+#include <QWidget>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../../DSP/SlidingStft.h"
+#include "../../Stream/SpectrumTap.h"
+#include "../../Util/SpscRing.h"
+
+/// @brief The Spectrogram class is a custom QWidget that scrolls the
+/// spectrograms of the input and the processed output, one above the other,
+/// so the noise the model removes is visible. A worker thread drains the
+/// SpectrumTap of the stream, transforms both signals with a SlidingStft,
+/// pools the bins into log-spaced rows and colour-maps them. The GUI thread
+/// only copies the finished columns into a ring image at display rate and
+/// paints it in two unscaled blits, so nothing is scrolled or rescaled and
+/// the audio thread does no more than copy samples into the tap. The worker
+/// and the tap run only while the widget is visible.
+class Spectrogram : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    /// @brief Number of frequency rows of each pane.
+    static constexpr int kRows = 96;
+
+  private:
+    /// @brief One colour-mapped column, the input rows then the output rows,
+    /// lowest frequency first.
+    using Column = std::array<QRgb, 2 * kRows>;
+
+    /// @brief Source of the samples, owned by the stream.
+    SpectrumTap& mTap;
+    /// @brief Transform of the input.
+    SlidingStft mInputStft;
+    /// @brief Transform of the output.
+    SlidingStft mOutputStft;
+    /// @brief First bin of every row, and the end of the last row.
+    std::vector<std::size_t> mRowBins;
+    /// @brief Colour of every level step, from the floor to full scale.
+    std::array<QRgb, 256> mPalette;
+    /// @brief Input samples read from the tap.
+    std::vector<float> mInput;
+    /// @brief Output samples read from the tap.
+    std::vector<float> mOutput;
+    /// @brief Column being filled by the worker.
+    Column mColumn;
+
+    /// @brief Finished columns, from the worker to the GUI thread.
+    SpscRing<Column> mColumns;
+    /// @brief Image of both panes, written column by column as a ring.
+    QImage mImage;
+    /// @brief Image column the next column is written to.
+    int mWriteColumn;
+    /// @brief Timer that moves the finished columns into the image.
+    QTimer* mFrameTimer;
+
+    /// @brief Thread that analyzes the tapped samples.
+    std::thread mWorker;
+    /// @brief Guards mStop for the worker wake-up.
+    std::mutex mMutex;
+    /// @brief Wakes the worker early on stop.
+    std::condition_variable mWake;
+    /// @brief Flag to tell the worker to finish.
+    bool mStop;
+
+    /// @brief Starts the worker and attaches the tap.
+    void start();
+    /// @brief Detaches the tap and joins the worker.
+    void stop();
+    /// @brief Body of the worker thread.
+    void work();
+    /// @brief Transforms every queued sample and queues the columns.
+    void analyze();
+    /// @brief Pools a power spectrum into rows and colour-maps them.
+    /// @param power Power of every bin.
+    /// @param pixels Receives kRows colours, lowest frequency first.
+    void mapRows(const float* power, QRgb* pixels) const;
+    /// @brief Allocates the image for the current width and clears it.
+    void resetImage();
+
+  protected:
+    virtual void paintEvent(QPaintEvent* e) override;
+    virtual void resizeEvent(QResizeEvent* e) override;
+    virtual void showEvent(QShowEvent* e) override;
+    virtual void hideEvent(QHideEvent* e) override;
+
+  public:
+    /// @brief Constructor for the Spectrogram class.
+    /// @param tap The tap of the stream, must outlive the widget.
+    /// @param sampleRate Sample rate of the stream. Defaults to 48000.
+    /// @param parent The parent widget. Default is nullptr.
+    Spectrogram(SpectrumTap& tap, int sampleRate = 48000,
+                QWidget* parent = nullptr);
+    /// @brief Destructor for the Spectrogram class, stops the worker.
+    ~Spectrogram();
+
+  public slots:
+    /// @brief Slot function to copy the finished columns into the image and
+    /// schedule a repaint if there were any.
+    void refresh();
+};
+
+#endif // SPECTROGRAM_H
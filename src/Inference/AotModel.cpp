@@ -0,0 +1,60 @@
+#include "AotModel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "../Util/Trace.h"
+
+AotModel::AotModel() :
+    mState(rtnr_aot::kStateCount, rtnr_aot::kStateSize)
+{
+    if (mFunction.num_args() != 1 + static_cast<int>(rtnr_aot::kStateCount)) {
+        throw std::runtime_error("Compiled model does not match its config");
+    }
+
+    // the states are read straight from the carried buffers
+    for (std::size_t i = 0; i < rtnr_aot::kStateCount; ++i) {
+        mFunction.set_arg_data(1 + i, mState.data(i));
+    }
+}
+
+LstmState* AotModel::lstmState()
+{
+    return &mState;
+}
+
+const char* AotModel::name() const
+{
+    return "aot";
+}
+
+std::size_t AotModel::blockSize() const
+{
+    return rtnr_aot::kBlockLen;
+}
+
+const float* AotModel::infer(const float* in, std::size_t frames)
+{
+    (void)frames;
+
+    // the block is read in place
+    mFunction.set_arg_data(0, in);
+    bool ok;
+    {
+        RTNR_TRACE_SCOPE("inference");
+        ok = mFunction.Run();
+    }
+    if (!ok) {
+        // keep the stream going unprocessed rather than output garbage
+        return in;
+    }
+
+    // carry the new states over to the next call
+    for (std::size_t i = 0; i < rtnr_aot::kStateCount; ++i) {
+        const float* state =
+            static_cast<const float*>(mFunction.result_data(1 + i));
+        std::copy(state, state + rtnr_aot::kStateSize, mState.data(i));
+    }
+
+    return static_cast<const float*>(mFunction.result_data(0));
+}
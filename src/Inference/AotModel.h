@@ -0,0 +1,35 @@
+#ifndef AOT_MODEL_H
+#define AOT_MODEL_H
+
+#include "noise_reduction_aot.h"
+#include "noise_reduction_aot_config.h"
+
+#include "InferenceModel.h"
+
+/// @brief Model backend calling the graph compiled ahead of time by
+/// tfcompile (see Model/ExportAot.py). The function is linked into the
+/// binary, so there is no runtime to load and no per-op dispatch. The graph
+/// is the stateless twin of the network: the LSTM states are extra inputs
+/// and outputs, and this class carries them from one call to the next.
+/// Only built with the RTNR_AOT_MODEL CMake option.
+class AotModel : public InferenceModel
+{
+  private:
+    /// @brief The compiled function with its argument and result buffers.
+    rtnr_aot::NoiseReductionAot mFunction;
+    /// @brief LSTM states fed to the next call, in graph input order.
+    LstmState mState;
+
+  protected:
+    LstmState* lstmState() override;
+
+  public:
+    /// @brief Constructor for the AotModel class, starts from zero states.
+    AotModel();
+
+    const char* name() const override;
+    std::size_t blockSize() const override;
+    const float* infer(const float* in, std::size_t frames) override;
+};
+
+#endif // AOT_MODEL_H
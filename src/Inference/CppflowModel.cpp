@@ -0,0 +1,115 @@
+#include "CppflowModel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <tuple>
+
+#include "../Util/Trace.h"
+
+namespace
+{
+/// @brief Input operation of the block in the serving signature.
+const char* kBlockInput = "serving_default_main_input:0";
+/// @brief Prefix of the state inputs of a stateless model, followed by the
+/// two digit state index.
+const char* kStateInputPrefix = "serving_default_state_";
+/// @brief Output operation of the serving signature.
+const char* kOutput = "StatefulPartitionedCall";
+
+/// @brief Deallocator for tensors wrapping memory the caller keeps owning.
+void keepCallerMemory(void* data, std::size_t len, void* arg)
+{
+    (void)data;
+    (void)len;
+    (void)arg;
+}
+
+/// @brief Wraps caller memory as a [1, size] tensor without copying it.
+cppflow::tensor wrap(const float* data, std::size_t size)
+{
+    // TensorFlow only reads it
+    int64_t dims[2] = {1, static_cast<int64_t>(size)};
+    return cppflow::tensor(TF_NewTensor(TF_FLOAT, dims, 2,
+                                        const_cast<float*>(data),
+                                        size * sizeof(float),
+                                        keepCallerMemory, nullptr));
+}
+
+/// @brief Returns the name of a state input.
+std::string stateInputName(std::size_t index)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%02zu", kStateInputPrefix, index);
+    return name;
+}
+} // namespace
+
+CppflowModel::CppflowModel(const std::string& modelFilepath,
+                           std::size_t blockLen) :
+    mModel(modelFilepath), mBlockLen(blockLen)
+{
+    mInputs.emplace_back(kBlockInput, cppflow::tensor());
+    mOutputNames.push_back(std::string(kOutput) + ":0");
+
+    // count the state inputs, the outputs follow the same order
+    std::vector<std::string> operations = mModel.get_operations();
+    std::size_t stateCount = 0;
+    while (std::find(operations.begin(), operations.end(),
+                     stateInputName(stateCount)) != operations.end()) {
+        ++stateCount;
+    }
+    if (stateCount == 0) {
+        return;
+    }
+
+    std::vector<int64_t> shape =
+        mModel.get_operation_shape(stateInputName(0));
+    mState = LstmState(stateCount, shape.empty() ? 0 : shape.back());
+    for (std::size_t i = 0; i < stateCount; ++i) {
+        mInputs.emplace_back(stateInputName(i) + ":0", cppflow::tensor());
+        mOutputNames.push_back(std::string(kOutput) + ":" +
+                               std::to_string(1 + i));
+    }
+}
+
+LstmState* CppflowModel::lstmState()
+{
+    return mState.count() > 0 ? &mState : nullptr;
+}
+
+const char* CppflowModel::name() const
+{
+    return "cppflow";
+}
+
+std::size_t CppflowModel::blockSize() const
+{
+    return mBlockLen;
+}
+
+const float* CppflowModel::infer(const float* in, std::size_t frames)
+{
+    // the block and the states are fed as [1, n] tensors, expanded to match
+    // the model inputs
+    std::get<1>(mInputs[0]) = wrap(in, frames);
+    for (std::size_t i = 0; i < mState.count(); ++i) {
+        std::get<1>(mInputs[1 + i]) = wrap(mState.data(i), mState.size());
+    }
+
+    // predict results using model
+    {
+        RTNR_TRACE_SCOPE("inference");
+        mOutputs = mModel(mInputs, mOutputNames);
+    }
+
+    // carry the new states over to the next call
+    for (std::size_t i = 0; i < mState.count(); ++i) {
+        const float* state = static_cast<const float*>(
+            TF_TensorData(mOutputs[1 + i].get_tensor().get()));
+        std::copy(state, state + mState.size(), mState.data(i));
+    }
+
+    // map the [1, 1, frames] output tensor without squeezing or copying it
+    return static_cast<const float*>(
+        TF_TensorData(mOutputs[0].get_tensor().get()));
+}
@@ -0,0 +1,53 @@
+#ifndef CPPFLOW_MODEL_H
+#define CPPFLOW_MODEL_H
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <cppflow/cppflow.h>
+
+#include "InferenceModel.h"
+
+/// @brief Model backend running the exported SavedModel through cppflow and
+/// the TensorFlow runtime. The input block is wrapped as a tensor without a
+/// copy and the output tensor is mapped in place. The input and output lists
+/// are built once, a call only rewraps the tensors.
+///
+/// A model saved with Model.save_stateless_model takes its LSTM states as
+/// extra inputs and returns the new states as extra outputs. This class
+/// detects such a model on load, feeds the states from its own buffer and
+/// copies the new ones back after every call, so the state can be reset,
+/// snapshotted and restored. A model saved with stateful LSTM layers keeps
+/// its state hidden in the runtime.
+class CppflowModel : public InferenceModel
+{
+  private:
+    /// @brief The loaded SavedModel.
+    cppflow::model mModel;
+    /// @brief Number of frames in one model block.
+    std::size_t mBlockLen;
+    /// @brief Explicit LSTM states, empty for a stateful model.
+    LstmState mState;
+    /// @brief Inputs by operation name, the block followed by the states.
+    std::vector<std::tuple<std::string, cppflow::tensor>> mInputs;
+    /// @brief Output tensor names, the block followed by the states.
+    std::vector<std::string> mOutputNames;
+    /// @brief Outputs of the last call, keep the mapped data alive.
+    std::vector<cppflow::tensor> mOutputs;
+
+  protected:
+    LstmState* lstmState() override;
+
+  public:
+    /// @brief Constructor for the CppflowModel class, loads the model.
+    /// @param modelFilepath Path to the SavedModel directory.
+    /// @param blockLen Number of frames in one model block.
+    CppflowModel(const std::string& modelFilepath, std::size_t blockLen);
+
+    const char* name() const override;
+    std::size_t blockSize() const override;
+    const float* infer(const float* in, std::size_t frames) override;
+};
+
+#endif // CPPFLOW_MODEL_H
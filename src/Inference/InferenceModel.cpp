@@ -0,0 +1,56 @@
+#include "InferenceModel.h"
+
+#include <algorithm>
+
+#include "../Util/Arena.h"
+
+void InferenceModel::warmUp(std::size_t blocks)
+{
+    Arena arena(Arena::bytesFor<float>(blockSize()));
+    float* silence = arena.allocate<float>(blockSize());
+    std::fill(silence, silence + blockSize(), 0.0f);
+    for (std::size_t i = 0; i < blocks; ++i) {
+        infer(silence, blockSize());
+    }
+    // start the real signal from the same state as a fresh model
+    resetState();
+}
+
+std::size_t InferenceModel::latencyBlocks() const
+{
+    return 0;
+}
+
+void InferenceModel::setRealTimeMode(bool status, RealTimePolicy policy,
+                                     int priority)
+{
+    (void)status;
+    (void)policy;
+    (void)priority;
+}
+
+LstmState* InferenceModel::lstmState()
+{
+    return nullptr;
+}
+
+const LstmState* InferenceModel::state() const
+{
+    return const_cast<InferenceModel*>(this)->lstmState();
+}
+
+bool InferenceModel::resetState()
+{
+    LstmState* state = lstmState();
+    if (state == nullptr) {
+        return false;
+    }
+    state->reset();
+    return true;
+}
+
+bool InferenceModel::restoreState(const LstmState& snapshot)
+{
+    LstmState* state = lstmState();
+    return state != nullptr && state->restore(snapshot);
+}
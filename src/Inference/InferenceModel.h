@@ -0,0 +1,75 @@
+#ifndef INFERENCE_MODEL_H
+#define INFERENCE_MODEL_H
+
+#include <cstddef>
+
+#include "../Util/RealTime.h"
+#include "LstmState.h"
+
+/// @brief Interface of a noise reduction model that processes one block at a
+/// time. The stream and the offline tools only talk to this interface, so
+/// model backends can be exchanged without touching the pipeline.
+class InferenceModel
+{
+  protected:
+    /// @brief Returns the LSTM state the backend carries between calls.
+    /// @return Pointer to the state, null if the runtime keeps it hidden.
+    virtual LstmState* lstmState();
+
+  public:
+    virtual ~InferenceModel() = default;
+
+    /// @brief Returns the backend name used in reports.
+    /// @return The backend name.
+    virtual const char* name() const = 0;
+
+    /// @brief Returns the number of frames the model takes per call.
+    /// @return The block size.
+    virtual std::size_t blockSize() const = 0;
+
+    /// @brief Returns the number of blocks the output lags behind the
+    /// input: the result of a call belongs to the input of that many calls
+    /// before.
+    /// @return The latency in blocks, 0 for a model answering every call.
+    virtual std::size_t latencyBlocks() const;
+
+    /// @brief Runs the model over one block.
+    /// @param in Pointer to the input frames. Aligned to Arena::kAlignment
+    /// whenever possible, so backends can wrap it without a copy.
+    /// @param frames Number of frames, equal to the block size.
+    /// @return Pointer to the processed frames, owned by the model and valid
+    /// until its next call.
+    virtual const float* infer(const float* in, std::size_t frames) = 0;
+
+    /// @brief Applies the real-time mode of the stream to the threads the
+    /// model runs on its own, they pick it up before their next block.
+    /// Thread-safe.
+    /// @param status Flag to enable the real-time mode.
+    /// @param policy The scheduling policy.
+    /// @param priority The scheduling priority.
+    virtual void setRealTimeMode(bool status, RealTimePolicy policy,
+                                 int priority);
+
+    /// @brief Runs blocks of silence through the model so that the first
+    /// real block does not pay for lazy initialization.
+    /// @param blocks Number of blocks to run.
+    void warmUp(std::size_t blocks);
+
+    /// @brief Returns the LSTM state carried between calls, to be copied as
+    /// a snapshot. Must not be called while another thread runs the model.
+    /// @return Pointer to the state, null if the runtime keeps it hidden.
+    virtual const LstmState* state() const;
+
+    /// @brief Sets the LSTM state to zero, as after loading the model.
+    /// @return False if the runtime keeps the state hidden.
+    virtual bool resetState();
+
+    /// @brief Continues from a snapshot of this or another model with the
+    /// same layout.
+    /// @param snapshot The snapshot.
+    /// @return False if the runtime keeps the state hidden or the layout
+    /// differs.
+    virtual bool restoreState(const LstmState& snapshot);
+};
+
+#endif // INFERENCE_MODEL_H
@@ -0,0 +1,43 @@
+#include "LstmState.h"
+
+#include <algorithm>
+
+LstmState::LstmState(std::size_t count, std::size_t size) :
+    mCount(count), mSize(size), mValues(count * size, 0.0f)
+{}
+
+std::size_t LstmState::count() const
+{
+    return mCount;
+}
+
+std::size_t LstmState::size() const
+{
+    return mSize;
+}
+
+float* LstmState::data(std::size_t index)
+{
+    return mValues.data() + index * mSize;
+}
+
+const float* LstmState::data(std::size_t index) const
+{
+    return mValues.data() + index * mSize;
+}
+
+void LstmState::reset()
+{
+    std::fill(mValues.begin(), mValues.end(), 0.0f);
+}
+
+bool LstmState::restore(const LstmState& snapshot)
+{
+    if (snapshot.mCount != mCount || snapshot.mSize != mSize) {
+        return false;
+    }
+    // copy in place, the model keeps pointers into the buffer
+    std::copy(snapshot.mValues.begin(), snapshot.mValues.end(),
+              mValues.begin());
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef LSTM_STATE_H
+#define LSTM_STATE_H
+
+#include <cstddef>
+#include <vector>
+
+/// @brief The LstmState class holds the h and c states of every LSTM layer
+/// of a model exported with explicit states, as one contiguous buffer of
+/// equally sized states in graph input order. Copies are snapshots: they can
+/// be stored, restored into the same model later or into another model with
+/// the same layout, for example on another worker thread.
+class LstmState
+{
+  private:
+    /// @brief Number of states.
+    std::size_t mCount;
+    /// @brief Number of values in one state.
+    std::size_t mSize;
+    /// @brief The state values, state after state.
+    std::vector<float> mValues;
+
+  public:
+    /// @brief Constructor for the LstmState class, starts from zero states.
+    /// @param count Number of states. Defaults to 0.
+    /// @param size Number of values in one state. Defaults to 0.
+    LstmState(std::size_t count = 0, std::size_t size = 0);
+
+    /// @brief Returns the number of states.
+    /// @return The state count.
+    std::size_t count() const;
+
+    /// @brief Returns the number of values in one state.
+    /// @return The state size.
+    std::size_t size() const;
+
+    /// @brief Returns one state. The pointer stays valid for the lifetime of
+    /// the object, restore copies into the same buffer.
+    /// @param index Index of the state in graph input order.
+    /// @return Pointer to the state values.
+    float* data(std::size_t index);
+    /// @brief Returns one state.
+    /// @param index Index of the state in graph input order.
+    /// @return Pointer to the state values.
+    const float* data(std::size_t index) const;
+
+    /// @brief Sets every state to zero, as after loading the model.
+    void reset();
+
+    /// @brief Copies the values of a snapshot into this state.
+    /// @param snapshot The snapshot.
+    /// @return False if the snapshot has a different layout, the state is
+    /// left unchanged then.
+    bool restore(const LstmState& snapshot);
+};
+
+#endif // LSTM_STATE_H
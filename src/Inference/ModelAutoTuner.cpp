@@ -0,0 +1,229 @@
+#include "ModelAutoTuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "../Util/Arena.h"
+#include "../Util/Log.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define RTNR_HAS_CPUID
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define RTNR_HAS_CPUID
+#endif
+
+namespace
+{
+/// @brief Suffix of the stored choice next to the manifest.
+const char* kChoiceSuffix = ".tuned";
+/// @brief Silent blocks run before timing a variant.
+constexpr std::size_t kWarmUpBlocks = 4;
+
+/// @brief Returns the FNV-1a hash of a string, stable across builds.
+std::uint64_t stableHash(const std::string& text)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// @brief Returns the CPU brand string, or "unknown cpu".
+std::string cpuBrand()
+{
+#if defined(RTNR_HAS_CPUID)
+    unsigned int regs[12] = {};
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0x80000000);
+    if (static_cast<unsigned int>(info[0]) < 0x80000004) {
+        return "unknown cpu";
+    }
+    for (int i = 0; i < 3; ++i) {
+        __cpuid(info, 0x80000002 + i);
+        std::memcpy(regs + 4 * i, info, sizeof(info));
+    }
+#else
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004) {
+        return "unknown cpu";
+    }
+    for (unsigned int i = 0; i < 3; ++i) {
+        __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1],
+                    &regs[4 * i + 2], &regs[4 * i + 3]);
+    }
+#endif
+    char brand[sizeof(regs) + 1] = {};
+    std::memcpy(brand, regs, sizeof(regs));
+    std::string text(brand);
+    text.erase(0, text.find_first_not_of(' '));
+    return text;
+#else
+    return "unknown cpu";
+#endif
+}
+} // namespace
+
+ModelAutoTuner::ModelAutoTuner(int sampleRate, double targetRealTimeFactor,
+                               double maxLatency,
+                               std::size_t benchmarkBlocks) :
+    mSampleRate(sampleRate), mTargetRealTimeFactor(targetRealTimeFactor),
+    mMaxLatency(maxLatency), mBenchmarkBlocks(benchmarkBlocks)
+{}
+
+std::vector<ModelVariant> ModelAutoTuner::loadManifest(
+    const std::string& manifestPath)
+{
+    std::ifstream file(manifestPath);
+    if (!file) {
+        throw std::runtime_error("Cannot read model manifest " +
+                                 manifestPath);
+    }
+
+    std::vector<ModelVariant> variants;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        ModelVariant variant;
+        if (fields >> variant.name >> variant.path >> variant.blockLen &&
+            variant.blockLen > 0) {
+            variants.push_back(variant);
+        }
+    }
+
+    if (variants.empty()) {
+        throw std::runtime_error("No model variant in manifest " +
+                                 manifestPath);
+    }
+    return variants;
+}
+
+std::string ModelAutoTuner::hardwareFingerprint()
+{
+    return cpuBrand() + ", " +
+           std::to_string(std::thread::hardware_concurrency()) + " threads";
+}
+
+VariantBenchmark ModelAutoTuner::benchmark(InferenceModel& model,
+                                           const ModelVariant& variant) const
+{
+    VariantBenchmark result;
+    result.variant = variant;
+    // a pipelined model returns each block latencyBlocks calls later
+    result.latency = static_cast<double>((1 + model.latencyBlocks()) *
+                                         variant.blockLen) /
+                     mSampleRate;
+
+    model.warmUp(kWarmUpBlocks);
+
+    // time blocks of low-level noise, the model cost does not depend on it
+    Arena arena(Arena::bytesFor<float>(variant.blockLen));
+    float* block = arena.allocate<float>(variant.blockLen);
+    std::uint32_t seed = 1;
+    for (std::size_t i = 0; i < variant.blockLen; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        block[i] = static_cast<float>(seed >> 8) / (1u << 24) * 0.02f - 0.01f;
+    }
+
+    std::vector<double> times(mBenchmarkBlocks);
+    for (auto& time : times) {
+        auto start = std::chrono::steady_clock::now();
+        model.infer(block, variant.blockLen);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        time = elapsed.count();
+    }
+
+    std::size_t index = times.size() * 9 / 10;
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+    result.realTimeFactor = times[index] / result.latency;
+    result.fits = result.realTimeFactor <= mTargetRealTimeFactor &&
+                  result.latency <= mMaxLatency;
+    return result;
+}
+
+std::string ModelAutoTuner::readChoice(const std::string& cachePath,
+                                       const std::string& fingerprint)
+{
+    std::ifstream file(cachePath);
+    std::string storedFingerprint;
+    std::string name;
+    if (!std::getline(file, storedFingerprint) || !std::getline(file, name) ||
+        storedFingerprint != fingerprint) {
+        return "";
+    }
+    return name;
+}
+
+void ModelAutoTuner::writeChoice(const std::string& cachePath,
+                                 const std::string& fingerprint,
+                                 const std::string& name)
+{
+    std::ofstream file(cachePath);
+    file << fingerprint << "\n" << name << "\n";
+    if (!file) {
+        Log::write(LogLevel::Error, "Cannot store model choice in %s",
+                   cachePath);
+    }
+}
+
+ModelVariant ModelAutoTuner::select(const std::string& manifestPath,
+                                    const Factory& factory) const
+{
+    std::vector<ModelVariant> variants = loadManifest(manifestPath);
+
+    // the choice depends on the hardware, the manifest and the targets
+    std::ifstream manifest(manifestPath);
+    std::stringstream contents;
+    contents << manifest.rdbuf() << mSampleRate << " "
+             << mTargetRealTimeFactor << " " << mMaxLatency;
+    std::string fingerprint = hardwareFingerprint() + ", manifest " +
+                              std::to_string(stableHash(contents.str()));
+
+    std::string cachePath = manifestPath + kChoiceSuffix;
+    std::string stored = readChoice(cachePath, fingerprint);
+    for (const auto& variant : variants) {
+        if (variant.name == stored) {
+            Log::write(LogLevel::Info, "Model variant: %s (stored)",
+                       variant.name);
+            return variant;
+        }
+    }
+
+    // the cheapest variant is the fallback when nothing fits
+    ModelVariant chosen = variants.front();
+    for (const auto& variant : variants) {
+        std::unique_ptr<InferenceModel> model;
+        try {
+            model = factory(variant);
+        } catch (const std::exception& e) {
+            Log::write(LogLevel::Error, "Model variant %s failed to load: %s",
+                       variant.name, e.what());
+            continue;
+        }
+
+        VariantBenchmark result = benchmark(*model, variant);
+        Log::write(LogLevel::Info,
+                   "Model variant %s: real-time factor %.3f, latency %.1f "
+                   "ms%s",
+                   variant.name, result.realTimeFactor,
+                   result.latency * 1000, result.fits ? "" : " (too slow)");
+        if (result.fits) {
+            chosen = variant;
+        }
+    }
+
+    writeChoice(cachePath, fingerprint, chosen.name);
+    Log::write(LogLevel::Info, "Model variant: %s", chosen.name);
+    return chosen;
+}
@@ -0,0 +1,118 @@
+#ifndef MODEL_AUTO_TUNER_H
+#define MODEL_AUTO_TUNER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "InferenceModel.h"
+
+/// @brief One model variant listed in a manifest.
+struct ModelVariant
+{
+    /// @brief Variant name, such as small, medium or large.
+    std::string name;
+    /// @brief Path to the exported model.
+    std::string path;
+    /// @brief Number of frames in one model block.
+    std::size_t blockLen = 0;
+};
+
+/// @brief Benchmark result of one variant on this host.
+struct VariantBenchmark
+{
+    /// @brief The variant.
+    ModelVariant variant;
+    /// @brief 90th percentile block time divided by the block duration.
+    double realTimeFactor = 0;
+    /// @brief Algorithmic latency in seconds: one block plus the blocks a
+    /// pipelined model holds back.
+    double latency = 0;
+    /// @brief Flag to indicate that the variant meets the targets.
+    bool fits = false;
+};
+
+/// @brief The ModelAutoTuner class picks the best model variant the host can
+/// sustain. The manifest lists the variants from the cheapest to the best,
+/// one per line as "name path block_len", with # starting a comment. Every
+/// variant is benchmarked on the actual host and the last one that meets the
+/// real-time factor and latency targets wins. The choice is stored next to
+/// the manifest with a fingerprint of the hardware and the manifest, so the
+/// benchmark only runs again when either changes.
+class ModelAutoTuner
+{
+  public:
+    /// @brief Function creating the model of a variant.
+    using Factory =
+        std::function<std::unique_ptr<InferenceModel>(const ModelVariant&)>;
+
+  private:
+    /// @brief Sample rate the variants run at.
+    int mSampleRate;
+    /// @brief Highest acceptable real-time factor.
+    double mTargetRealTimeFactor;
+    /// @brief Highest acceptable algorithmic latency in seconds.
+    double mMaxLatency;
+    /// @brief Number of timed blocks per variant.
+    std::size_t mBenchmarkBlocks;
+
+    /// @brief Reads a stored choice if it matches the fingerprint.
+    /// @param cachePath Path of the stored choice.
+    /// @param fingerprint The current fingerprint.
+    /// @return The variant name, empty if there is no valid choice.
+    static std::string readChoice(const std::string& cachePath,
+                                  const std::string& fingerprint);
+
+    /// @brief Stores a choice with its fingerprint.
+    /// @param cachePath Path of the stored choice.
+    /// @param fingerprint The current fingerprint.
+    /// @param name The chosen variant name.
+    static void writeChoice(const std::string& cachePath,
+                            const std::string& fingerprint,
+                            const std::string& name);
+
+  public:
+    /// @brief Constructor for the ModelAutoTuner class.
+    /// @param sampleRate Sample rate. Defaults to 48000.
+    /// @param targetRealTimeFactor Highest acceptable real-time factor.
+    /// Defaults to 0.5, leaving headroom below the degradation governor.
+    /// @param maxLatency Highest acceptable algorithmic latency in seconds.
+    /// Defaults to 0.05.
+    /// @param benchmarkBlocks Number of timed blocks per variant. Defaults to
+    /// 32.
+    ModelAutoTuner(int sampleRate = 48000, double targetRealTimeFactor = 0.5,
+                   double maxLatency = 0.05, std::size_t benchmarkBlocks = 32);
+
+    /// @brief Reads a manifest.
+    /// @param manifestPath Path to the manifest.
+    /// @return The variants in manifest order.
+    /// @throws std::runtime_error If the manifest cannot be read or has no
+    /// valid entry.
+    static std::vector<ModelVariant> loadManifest(
+        const std::string& manifestPath);
+
+    /// @brief Returns a description of the host hardware, stable across
+    /// runs.
+    /// @return The CPU brand and the number of hardware threads.
+    static std::string hardwareFingerprint();
+
+    /// @brief Benchmarks one variant.
+    /// @param model The loaded model of the variant.
+    /// @param variant The variant.
+    /// @return The benchmark result.
+    VariantBenchmark benchmark(InferenceModel& model,
+                               const ModelVariant& variant) const;
+
+    /// @brief Picks the variant for this host, from the stored choice when
+    /// it is still valid, by benchmarking every variant otherwise.
+    /// @param manifestPath Path to the manifest.
+    /// @param factory Function creating the model of a variant.
+    /// @return The chosen variant.
+    /// @throws std::runtime_error If the manifest cannot be read.
+    ModelVariant select(const std::string& manifestPath,
+                        const Factory& factory) const;
+};
+
+#endif // MODEL_AUTO_TUNER_H
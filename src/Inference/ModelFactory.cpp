@@ -0,0 +1,47 @@
+#include "ModelFactory.h"
+
+#include <filesystem>
+#include <stdexcept>
+
+#include "CppflowModel.h"
+#include "ParallelModel.h"
+#include "SpectralModel.h"
+
+#ifdef RTNR_AOT_MODEL
+#include "AotModel.h"
+#endif
+
+std::unique_ptr<InferenceModel> createModel(const std::string& modelFilepath,
+                                            std::size_t blockLen)
+{
+    if (modelFilepath == kSpectralModelPath) {
+        return std::make_unique<SpectralModel>(blockLen);
+    }
+
+    // a split model, see Model.save_split_model
+    std::filesystem::path stages(modelFilepath);
+    if (std::filesystem::is_directory(stages / "stage_1")) {
+        return std::make_unique<ParallelModel>(
+            std::make_unique<CppflowModel>((stages / "stage_1").string(),
+                                           blockLen),
+            std::make_unique<CppflowModel>((stages / "stage_2").string(),
+                                           blockLen));
+    }
+
+    if (modelFilepath != kAotModelPath) {
+        return std::make_unique<CppflowModel>(modelFilepath, blockLen);
+    }
+
+#ifdef RTNR_AOT_MODEL
+    auto model = std::make_unique<AotModel>();
+    if (model->blockSize() != blockLen) {
+        throw std::runtime_error("Compiled model takes blocks of " +
+                                 std::to_string(model->blockSize()) +
+                                 " frames, not " + std::to_string(blockLen));
+    }
+    return model;
+#else
+    throw std::runtime_error("Built without the compiled model, configure "
+                             "with -DRTNR_AOT_MODEL=ON");
+#endif
+}
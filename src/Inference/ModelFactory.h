@@ -0,0 +1,29 @@
+#ifndef MODEL_FACTORY_H
+#define MODEL_FACTORY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "InferenceModel.h"
+
+/// @brief Model path selecting the model compiled into the binary.
+constexpr const char* kAotModelPath = "aot";
+/// @brief Model path selecting the spectral Wiener filter instead of a
+/// network.
+constexpr const char* kSpectralModelPath = "spectral";
+
+/// @brief Creates the model backend for a model path: the spectral filter
+/// for kSpectralModelPath, the ahead-of-time compiled model for
+/// kAotModelPath, the two stages run pipelined for a directory with stage_1
+/// and stage_2 SavedModels, a SavedModel through cppflow otherwise.
+/// @param modelFilepath Path to the SavedModel directory, to the directory
+/// of a split model, kSpectralModelPath or kAotModelPath.
+/// @param blockLen Number of frames in one model block.
+/// @return The loaded model.
+/// @throws std::runtime_error If the compiled model is requested but the
+/// binary was built without it, or does not take blocks of blockLen.
+std::unique_ptr<InferenceModel> createModel(const std::string& modelFilepath,
+                                            std::size_t blockLen);
+
+#endif // MODEL_FACTORY_H
@@ -0,0 +1,90 @@
+#include "ModelProbe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "../Util/Arena.h"
+#include "ModelFactory.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+std::string ModelProbeReport::toString() const
+{
+    std::ostringstream report;
+    report << model << " (" << backend << "): cold start "
+           << coldStartSeconds * 1000 << " ms, resident +"
+           << residentBytes / (1024 * 1024) << " MiB, block p50 "
+           << blockP50 * 1000 << " ms, p99 " << blockP99 * 1000 << " ms, "
+           << channelLoad * 100 << "% of a core per channel";
+    return report.str();
+}
+
+long long ModelProbe::residentBytes()
+{
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long long pages = 0;
+    long long resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+    return 0;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                             sizeof(counters))) {
+        return static_cast<long long>(counters.WorkingSetSize);
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+ModelProbeReport ModelProbe::run(const std::string& modelFilepath,
+                                 std::size_t blockLen, std::size_t blocks,
+                                 int sampleRate)
+{
+    ModelProbeReport report;
+    report.model = modelFilepath;
+
+    Arena arena(Arena::bytesFor<float>(blockLen));
+    float* block = arena.allocate<float>(blockLen);
+    std::fill(block, block + blockLen, 0.0f);
+
+    // cold start covers loading and the lazy work of the first call
+    long long residentBefore = residentBytes();
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<InferenceModel> model =
+        createModel(modelFilepath, blockLen);
+    model->infer(block, blockLen);
+    std::chrono::duration<double> coldStart =
+        std::chrono::steady_clock::now() - start;
+    report.coldStartSeconds = coldStart.count();
+    report.residentBytes = residentBytes() - residentBefore;
+    report.backend = model->name();
+
+    std::vector<double> times(std::max<std::size_t>(blocks, 1));
+    for (auto& time : times) {
+        auto blockStart = std::chrono::steady_clock::now();
+        model->infer(block, blockLen);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - blockStart;
+        time = elapsed.count();
+    }
+    std::sort(times.begin(), times.end());
+    report.blockP50 = times[(times.size() - 1) / 2];
+    report.blockP99 = times[(times.size() - 1) * 99 / 100];
+    report.channelLoad =
+        report.blockP50 / (static_cast<double>(blockLen) / sampleRate);
+
+    return report;
+}
@@ -0,0 +1,56 @@
+#ifndef MODEL_PROBE_H
+#define MODEL_PROBE_H
+
+#include <cstddef>
+#include <string>
+
+/// @brief Startup and run-time cost of one model backend.
+struct ModelProbeReport
+{
+    /// @brief Model path the backend was created from.
+    std::string model;
+    /// @brief Backend name.
+    std::string backend;
+    /// @brief Time to create the model and run the first block in seconds.
+    double coldStartSeconds = 0;
+    /// @brief Growth of the resident set size while loading, in bytes.
+    long long residentBytes = 0;
+    /// @brief Median block time in seconds.
+    double blockP50 = 0;
+    /// @brief 99th percentile block time in seconds.
+    double blockP99 = 0;
+    /// @brief Median block time divided by the block duration, the share of
+    /// one core a mono channel takes.
+    double channelLoad = 0;
+
+    /// @brief Function to format the report.
+    /// @return The report as a human readable line.
+    std::string toString() const;
+};
+
+/// @brief The ModelProbe class measures what a model backend costs: the cold
+/// start until the first block is processed, the memory it takes and the
+/// per-block latency. Probe one backend per process for cold start numbers,
+/// a second backend in the same process starts with warm caches.
+class ModelProbe
+{
+  public:
+    /// @brief Returns the resident set size of the process.
+    /// @return The size in bytes, 0 where it cannot be read.
+    static long long residentBytes();
+
+    /// @brief Loads a model and measures it.
+    /// @param modelFilepath Path to the model, as taken by createModel.
+    /// @param blockLen Number of frames in one model block.
+    /// @param blocks Number of timed blocks. Defaults to 200.
+    /// @param sampleRate Sample rate the block duration is based on.
+    /// Defaults to 48000.
+    /// @return The report.
+    /// @throws std::runtime_error If the model cannot be created.
+    static ModelProbeReport run(const std::string& modelFilepath,
+                                std::size_t blockLen,
+                                std::size_t blocks = 200,
+                                int sampleRate = 48000);
+};
+
+#endif // MODEL_PROBE_H
@@ -0,0 +1,171 @@
+#include "ModelSwitcher.h"
+
+#include <chrono>
+#include <exception>
+#include "../Util/Log.h"
+#include "../Util/Trace.h"
+
+namespace
+{
+/// @brief Polling interval of the worker waiting for the audio thread.
+constexpr std::chrono::milliseconds kRetirePoll(2);
+} // namespace
+
+ModelSwitcher::ModelSwitcher() :
+    mActive(nullptr), mLatencyBlocks(0), mPending(nullptr),
+    mRetired(nullptr), mBusy(false), mStop(false), mRealTimeMode(false),
+    mRealTimePolicy(RealTimePolicy::Fifo), mRealTimePriority(0),
+    mPublishedAt(0), mSwaps(0), mLoadSeconds(0), mAdoptSeconds(0),
+    mBoundaryStep(0)
+{}
+
+ModelSwitcher::~ModelSwitcher()
+{
+    joinWorker();
+    delete mActive;
+}
+
+void ModelSwitcher::joinWorker()
+{
+    mStop = true;
+    if (mWorker.joinable()) {
+        mWorker.join();
+    }
+    mStop = false;
+
+    // a swap never adopted, or adopted after the worker gave up
+    delete mPending.exchange(nullptr);
+    delete mRetired.exchange(nullptr);
+    mBusy = false;
+}
+
+void ModelSwitcher::setModel(std::unique_ptr<InferenceModel> model)
+{
+    joinWorker();
+    delete mActive;
+    mActive = model.release();
+    mLatencyBlocks = mActive != nullptr ? mActive->latencyBlocks() : 0;
+    if (mActive != nullptr) {
+        mActive->setRealTimeMode(mRealTimeMode, mRealTimePolicy,
+                                 mRealTimePriority);
+    }
+}
+
+void ModelSwitcher::setRealTimeMode(bool status, RealTimePolicy policy,
+                                    int priority)
+{
+    mRealTimeMode = status;
+    mRealTimePolicy = policy;
+    mRealTimePriority = priority;
+    if (mActive != nullptr) {
+        mActive->setRealTimeMode(status, policy, priority);
+    }
+}
+
+bool ModelSwitcher::swapAsync(Loader loader, std::size_t warmUpBlocks)
+{
+    if (mBusy.exchange(true)) {
+        return false;
+    }
+    // the previous worker has finished, its thread only needs a join
+    if (mWorker.joinable()) {
+        mWorker.join();
+    }
+
+    mWorker = std::thread([this, loader, warmUpBlocks]() {
+        RTNR_TRACE_THREAD("model_loader");
+        auto loadStart = std::chrono::steady_clock::now();
+        std::unique_ptr<InferenceModel> model;
+        try {
+            RTNR_TRACE_SCOPE("model_load");
+            model = loader();
+            if (model) {
+                model->warmUp(warmUpBlocks);
+            }
+        } catch (const std::exception& e) {
+            Log::write(LogLevel::Error, "Model swap failed: %s", e.what());
+            model.reset();
+        }
+        if (model && model->latencyBlocks() != mLatencyBlocks) {
+            Log::write(LogLevel::Error,
+                       "Model swap rejected: latency of %zu blocks, the "
+                       "stream is built for %zu",
+                       model->latencyBlocks(), mLatencyBlocks);
+            model.reset();
+        }
+        if (!model) {
+            mBusy = false;
+            return;
+        }
+        model->setRealTimeMode(mRealTimeMode, mRealTimePolicy,
+                               mRealTimePriority);
+        std::chrono::duration<double> loadTime =
+            std::chrono::steady_clock::now() - loadStart;
+        mLoadSeconds = loadTime.count();
+
+        mPublishedAt = Trace::now();
+        mPending.store(model.release(), std::memory_order_release);
+
+        // free the old model here once the audio thread let go of it
+        InferenceModel* retired = nullptr;
+        while (!mStop &&
+               (retired = mRetired.exchange(nullptr,
+                                            std::memory_order_acquire)) ==
+                   nullptr) {
+            std::this_thread::sleep_for(kRetirePoll);
+        }
+        if (retired == nullptr) {
+            return;
+        }
+        delete retired;
+
+        Log::write(LogLevel::Info,
+                   "Model swap: loaded in %.1f ms, adopted after %.1f ms, "
+                   "boundary step %g",
+                   mLoadSeconds * 1000, mAdoptSeconds * 1000,
+                   mBoundaryStep.load());
+        mBusy = false;
+    });
+
+    return true;
+}
+
+InferenceModel* ModelSwitcher::active() const
+{
+    return mActive;
+}
+
+InferenceModel* ModelSwitcher::adoptPending()
+{
+    if (mPending.load(std::memory_order_relaxed) == nullptr) {
+        return nullptr;
+    }
+    InferenceModel* next =
+        mPending.exchange(nullptr, std::memory_order_acquire);
+    if (next == nullptr) {
+        return nullptr;
+    }
+
+    InferenceModel* previous = mActive;
+    mActive = next;
+    mAdoptSeconds = (Trace::now() - mPublishedAt) * 1e-9;
+    return previous;
+}
+
+void ModelSwitcher::retire(InferenceModel* model, double boundaryStep)
+{
+    mBoundaryStep = boundaryStep;
+    mSwaps.fetch_add(1, std::memory_order_relaxed);
+    mRetired.store(model, std::memory_order_release);
+}
+
+ModelSwapStats ModelSwitcher::getStats() const
+{
+    ModelSwapStats stats;
+    stats.swaps = mSwaps.load(std::memory_order_relaxed);
+    stats.busy = mBusy;
+    stats.loadSeconds = mLoadSeconds;
+    stats.adoptSeconds = mAdoptSeconds;
+    stats.boundaryStep = mBoundaryStep;
+    return stats;
+}
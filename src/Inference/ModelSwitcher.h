@@ -0,0 +1,131 @@
+#ifndef MODEL_SWITCHER_H
+#define MODEL_SWITCHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "InferenceModel.h"
+
+/// @brief Snapshot of the model swap counters.
+struct ModelSwapStats
+{
+    /// @brief Number of completed swaps.
+    std::uint64_t swaps = 0;
+    /// @brief Flag to indicate that a swap is loading or waiting for the
+    /// audio thread.
+    bool busy = false;
+    /// @brief Time spent loading and warming the last model in seconds.
+    double loadSeconds = 0;
+    /// @brief Time from publishing the last model to its adoption at a block
+    /// boundary in seconds.
+    double adoptSeconds = 0;
+    /// @brief Absolute step between the last sample before the last swap and
+    /// the first sample after it, to compare with the signal level.
+    double boundaryStep = 0;
+};
+
+/// @brief The ModelSwitcher class owns the active model of a stream and
+/// replaces it without stopping the stream. A new model is loaded and warmed
+/// on a worker thread and published through an atomic slot. The audio thread
+/// adopts it at the next block boundary and hands the old model back through
+/// a second slot; the worker frees it, so the audio thread never loads or
+/// destroys a model.
+class ModelSwitcher
+{
+  public:
+    /// @brief Function creating a model on the worker thread.
+    using Loader = std::function<std::unique_ptr<InferenceModel>()>;
+
+  private:
+    /// @brief The model in use, touched by the audio thread only while a
+    /// stream runs.
+    InferenceModel* mActive;
+    /// @brief Latency of the model set by setModel in blocks. The stream
+    /// sizes its delays from it, so every swapped model must match it.
+    std::size_t mLatencyBlocks;
+    /// @brief Model published by the worker, waiting for adoption.
+    std::atomic<InferenceModel*> mPending;
+    /// @brief Model handed back by the audio thread, waiting to be freed.
+    std::atomic<InferenceModel*> mRetired;
+    /// @brief The worker thread of the current swap.
+    std::thread mWorker;
+    /// @brief Flag to indicate that a swap is in progress.
+    std::atomic<bool> mBusy;
+    /// @brief Flag to stop a worker waiting for adoption.
+    std::atomic<bool> mStop;
+    /// @brief Real-time mode passed to every model, see setRealTimeMode.
+    std::atomic<bool> mRealTimeMode;
+    /// @brief Scheduling policy passed with the real-time mode.
+    std::atomic<RealTimePolicy> mRealTimePolicy;
+    /// @brief Scheduling priority passed with the real-time mode.
+    std::atomic<int> mRealTimePriority;
+
+    /// @brief Trace clock value when the pending model was published.
+    std::atomic<std::int64_t> mPublishedAt;
+    /// @brief Number of completed swaps.
+    std::atomic<std::uint64_t> mSwaps;
+    /// @brief Load and warm-up time of the last model.
+    std::atomic<double> mLoadSeconds;
+    /// @brief Adoption delay of the last model.
+    std::atomic<double> mAdoptSeconds;
+    /// @brief Boundary step of the last swap.
+    std::atomic<double> mBoundaryStep;
+
+    /// @brief Joins the worker of the previous swap and frees leftovers.
+    void joinWorker();
+
+  public:
+    /// @brief Constructor for the ModelSwitcher class.
+    ModelSwitcher();
+    /// @brief Destructor, stops the worker and frees all models.
+    ~ModelSwitcher();
+
+    ModelSwitcher(const ModelSwitcher&) = delete;
+    ModelSwitcher& operator=(const ModelSwitcher&) = delete;
+
+    /// @brief Sets the model directly. Must not be called while a stream
+    /// runs.
+    /// @param model The model.
+    void setModel(std::unique_ptr<InferenceModel> model);
+
+    /// @brief Passes the real-time mode of the stream to the model in use
+    /// and to every model loaded later. Must not be called while a stream
+    /// runs.
+    /// @param status Flag to enable the real-time mode.
+    /// @param policy The scheduling policy.
+    /// @param priority The scheduling priority.
+    void setRealTimeMode(bool status, RealTimePolicy policy, int priority);
+
+    /// @brief Starts loading a new model in the background. A model whose
+    /// latency differs from the one set by setModel is freed instead of
+    /// published, the delays around it could not follow.
+    /// @param loader Function creating the model, called on the worker.
+    /// @param warmUpBlocks Number of silent blocks run before publishing.
+    /// @return False if a swap is already in progress.
+    bool swapAsync(Loader loader, std::size_t warmUpBlocks = 4);
+
+    /// @brief Returns the model in use. Audio thread only while a stream
+    /// runs.
+    /// @return Pointer to the model, null if none is set.
+    InferenceModel* active() const;
+
+    /// @brief Makes a published model active. Audio thread only, lock-free.
+    /// @return The previous model if a swap happened, null otherwise. It must
+    /// be passed to retire once it is no longer used.
+    InferenceModel* adoptPending();
+
+    /// @brief Hands a replaced model back to the worker. Audio thread only,
+    /// lock-free.
+    /// @param model The model returned by adoptPending.
+    /// @param boundaryStep Output step across the swap boundary.
+    void retire(InferenceModel* model, double boundaryStep);
+
+    /// @brief Returns the swap counters.
+    /// @return Snapshot of the counters.
+    ModelSwapStats getStats() const;
+};
+
+#endif // MODEL_SWITCHER_H
@@ -0,0 +1,204 @@
+#include "ParallelModel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#define RTNR_HAS_PAUSE
+#endif
+
+#include "../Util/Log.h"
+#include "../Util/Trace.h"
+
+namespace
+{
+/// @brief Polls of the worker before it starts sleeping between polls, a
+/// few microseconds to catch a block handed over right away.
+constexpr int kSpinPolls = 64;
+/// @brief Sleep between polls of an idle worker, short against a block.
+constexpr std::chrono::microseconds kIdlePoll(50);
+
+/// @brief Tells the core that the thread is busy waiting.
+inline void relax()
+{
+#if defined(RTNR_HAS_PAUSE)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+} // namespace
+
+ParallelModel::ParallelModel(std::unique_ptr<InferenceModel> first,
+                             std::unique_ptr<InferenceModel> second) :
+    mFirst(std::move(first)), mSecond(std::move(second)),
+    mBlockLen(mFirst->blockSize()),
+    mArena(3 * Arena::bytesFor<float>(mBlockLen)), mSubmitted(0),
+    mCompleted(0), mStop(false), mRealTimeChanges(0), mRealTimeMode(false),
+    mRealTimePolicy(RealTimePolicy::Fifo), mRealTimePriority(0)
+{
+    if (mSecond->blockSize() != mBlockLen) {
+        throw std::runtime_error("Model stages differ in block size");
+    }
+
+    mHandoff = mArena.allocate<float>(mBlockLen);
+    mResults[0] = mArena.allocate<float>(mBlockLen);
+    mResults[1] = mArena.allocate<float>(mBlockLen);
+    std::fill(mResults[0], mResults[0] + mBlockLen, 0.0f);
+    std::fill(mResults[1], mResults[1] + mBlockLen, 0.0f);
+
+    mWorker = std::thread(&ParallelModel::work, this);
+}
+
+ParallelModel::~ParallelModel()
+{
+    mStop = true;
+    mWorker.join();
+}
+
+void ParallelModel::work()
+{
+    RTNR_TRACE_THREAD("model_stage_2");
+    std::uint64_t done = 0;
+    std::uint32_t changes = 0;
+    while (true) {
+        // spin while blocks arrive back to back, then poll at a low rate
+        int polls = 0;
+        while (mSubmitted.load(std::memory_order_acquire) == done) {
+            if (mStop) {
+                return;
+            }
+            if (++polls < kSpinPolls) {
+                relax();
+            } else {
+                std::this_thread::sleep_for(kIdlePoll);
+            }
+        }
+
+        std::uint32_t requested = mRealTimeChanges.load();
+        if (requested != changes) {
+            changes = requested;
+            applyRealTimeMode();
+        }
+
+        ++done;
+        const float* result = mSecond->infer(mHandoff, mBlockLen);
+        std::copy(result, result + mBlockLen, mResults[done % 2]);
+        mCompleted.store(done, std::memory_order_release);
+    }
+}
+
+void ParallelModel::applyRealTimeMode()
+{
+    if (!mRealTimeMode) {
+        return;
+    }
+    bool denormalsOff = RealTime::disableDenormals();
+    bool priority =
+        RealTime::setThreadPriority(mRealTimePolicy, mRealTimePriority);
+    Log::write(LogLevel::Info, "Model worker: priority %s, FTZ/DAZ %s",
+               priority ? "yes" : "no", denormalsOff ? "yes" : "no");
+}
+
+void ParallelModel::waitIdle() const
+{
+    std::uint64_t submitted = mSubmitted.load(std::memory_order_relaxed);
+    while (mCompleted.load(std::memory_order_acquire) != submitted) {
+        relax();
+    }
+}
+
+const char* ParallelModel::name() const
+{
+    return "parallel";
+}
+
+std::size_t ParallelModel::blockSize() const
+{
+    return mBlockLen;
+}
+
+std::size_t ParallelModel::latencyBlocks() const
+{
+    return 1;
+}
+
+const float* ParallelModel::infer(const float* in, std::size_t frames)
+{
+    // overlaps with the second stage of the previous block on the worker
+    const float* masked = mFirst->infer(in, frames);
+
+    {
+        RTNR_TRACE_SCOPE("stage_2_wait");
+        waitIdle();
+    }
+
+    // the worker is idle, hand over this block and return the previous one
+    std::uint64_t submitted = mSubmitted.load(std::memory_order_relaxed);
+    std::copy(masked, masked + frames, mHandoff);
+    mSubmitted.store(submitted + 1, std::memory_order_release);
+    return mResults[submitted % 2];
+}
+
+void ParallelModel::setRealTimeMode(bool status, RealTimePolicy policy,
+                                    int priority)
+{
+    mRealTimeMode = status;
+    mRealTimePolicy = policy;
+    mRealTimePriority = priority;
+    mRealTimeChanges.fetch_add(1);
+}
+
+const LstmState* ParallelModel::state() const
+{
+    waitIdle();
+    const LstmState* first = mFirst->state();
+    const LstmState* second = mSecond->state();
+    if (first == nullptr || second == nullptr ||
+        first->size() != second->size()) {
+        return nullptr;
+    }
+
+    mSnapshot = LstmState(first->count() + second->count(), first->size());
+    for (std::size_t i = 0; i < first->count(); ++i) {
+        std::copy(first->data(i), first->data(i) + first->size(),
+                  mSnapshot.data(i));
+    }
+    for (std::size_t i = 0; i < second->count(); ++i) {
+        std::copy(second->data(i), second->data(i) + second->size(),
+                  mSnapshot.data(first->count() + i));
+    }
+    return &mSnapshot;
+}
+
+bool ParallelModel::resetState()
+{
+    waitIdle();
+    std::fill(mResults[0], mResults[0] + mBlockLen, 0.0f);
+    std::fill(mResults[1], mResults[1] + mBlockLen, 0.0f);
+    bool first = mFirst->resetState();
+    bool second = mSecond->resetState();
+    return first && second;
+}
+
+bool ParallelModel::restoreState(const LstmState& snapshot)
+{
+    const LstmState* joined = state();
+    if (joined == nullptr || joined->count() != snapshot.count() ||
+        joined->size() != snapshot.size()) {
+        return false;
+    }
+
+    // split the snapshot at the state count of the first stage
+    std::size_t split = mFirst->state()->count();
+    LstmState first(split, snapshot.size());
+    LstmState second(snapshot.count() - split, snapshot.size());
+    for (std::size_t i = 0; i < snapshot.count(); ++i) {
+        float* target = i < split ? first.data(i) : second.data(i - split);
+        std::copy(snapshot.data(i), snapshot.data(i) + snapshot.size(),
+                  target);
+    }
+    return mFirst->restoreState(first) && mSecond->restoreState(second);
+}
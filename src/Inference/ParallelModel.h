@@ -0,0 +1,108 @@
+#ifndef PARALLEL_MODEL_H
+#define PARALLEL_MODEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "../Util/Arena.h"
+#include "InferenceModel.h"
+
+/// @brief Model backend running the two separation stages of the network
+/// (see Model.save_split_model) pipelined on two cores. The calling thread
+/// runs the spectral mask stage on block n while a worker thread runs the
+/// feature mask stage on block n - 1. The blocks are handed over through
+/// buffers guarded by two counters, so neither thread takes a lock. The
+/// output lags the input by exactly one block, in exchange the sustainable
+/// block rate is bound by the slower stage instead of their sum. In real-time
+/// mode the worker takes the priority and floating point mode of the audio
+/// thread, and between blocks it spins briefly before it sleeps.
+class ParallelModel : public InferenceModel
+{
+  private:
+    /// @brief The spectral mask stage, run by the caller.
+    std::unique_ptr<InferenceModel> mFirst;
+    /// @brief The feature mask stage, run by the worker.
+    std::unique_ptr<InferenceModel> mSecond;
+    /// @brief Number of frames in one model block.
+    std::size_t mBlockLen;
+
+    /// @brief Storage of the handoff and result blocks.
+    Arena mArena;
+    /// @brief Output of the first stage waiting for the worker.
+    float* mHandoff;
+    /// @brief Results of the worker, indexed by the parity of the block.
+    float* mResults[2];
+
+    /// @brief Number of blocks handed to the worker.
+    alignas(64) std::atomic<std::uint64_t> mSubmitted;
+    /// @brief Number of blocks finished by the worker.
+    alignas(64) std::atomic<std::uint64_t> mCompleted;
+    /// @brief Flag to stop the worker.
+    std::atomic<bool> mStop;
+    /// @brief Number of real-time mode changes, the worker applies the mode
+    /// when it differs from the count it has seen.
+    std::atomic<std::uint32_t> mRealTimeChanges;
+    /// @brief Flag to run the worker in real-time mode.
+    std::atomic<bool> mRealTimeMode;
+    /// @brief Scheduling policy of the worker in real-time mode.
+    std::atomic<RealTimePolicy> mRealTimePolicy;
+    /// @brief Scheduling priority of the worker in real-time mode.
+    std::atomic<int> mRealTimePriority;
+    /// @brief The worker thread running the second stage.
+    std::thread mWorker;
+
+    /// @brief States of both stages joined for snapshots.
+    mutable LstmState mSnapshot;
+
+    /// @brief Worker loop, runs the second stage on every handed block.
+    void work();
+    /// @brief Sets up the worker thread for the requested real-time mode.
+    /// Called on the worker.
+    void applyRealTimeMode();
+    /// @brief Waits until the worker has finished every handed block.
+    void waitIdle() const;
+
+  public:
+    /// @brief Constructor for the ParallelModel class, starts the worker.
+    /// @param first The spectral mask stage.
+    /// @param second The feature mask stage, taking blocks of the same size.
+    /// @throws std::runtime_error If the stages differ in block size.
+    ParallelModel(std::unique_ptr<InferenceModel> first,
+                  std::unique_ptr<InferenceModel> second);
+    /// @brief Destructor, stops the worker.
+    ~ParallelModel() override;
+
+    ParallelModel(const ParallelModel&) = delete;
+    ParallelModel& operator=(const ParallelModel&) = delete;
+
+    const char* name() const override;
+    std::size_t blockSize() const override;
+    std::size_t latencyBlocks() const override;
+    const float* infer(const float* in, std::size_t frames) override;
+    /// @brief Requests the real-time mode for the worker. A granted priority
+    /// stays with the worker until the model is freed.
+    /// @param status Flag to enable the real-time mode.
+    /// @param policy The scheduling policy.
+    /// @param priority The scheduling priority.
+    void setRealTimeMode(bool status, RealTimePolicy policy,
+                         int priority) override;
+
+    /// @brief Returns the states of the first stage followed by those of the
+    /// second. Blocks in flight are not part of the snapshot.
+    /// @return Pointer to the joined state, null if a stage keeps its state
+    /// hidden or the stages differ in state size.
+    const LstmState* state() const override;
+    /// @brief Resets both stages and drops the block in flight, the next
+    /// call returns silence.
+    /// @return False if a stage keeps its state hidden.
+    bool resetState() override;
+    /// @brief Restores a snapshot taken with state.
+    /// @param snapshot The joined state.
+    /// @return False if a stage keeps its state hidden or the layout
+    /// differs.
+    bool restoreState(const LstmState& snapshot) override;
+};
+
+#endif // PARALLEL_MODEL_H
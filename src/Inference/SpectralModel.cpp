@@ -0,0 +1,41 @@
+#include "SpectralModel.h"
+
+#include <algorithm>
+
+SpectralModel::SpectralModel(std::size_t blockLen, int sampleRate) :
+    mDenoiser(sampleRate), mBlockLen(blockLen)
+{
+    mLatencyBlocks = (mDenoiser.latency() + blockLen - 1) / blockLen;
+    mPadding = mLatencyBlocks * blockLen - mDenoiser.latency();
+    mOutput.assign(mPadding + blockLen, 0.0f);
+}
+
+const char* SpectralModel::name() const
+{
+    return "spectral";
+}
+
+std::size_t SpectralModel::blockSize() const
+{
+    return mBlockLen;
+}
+
+std::size_t SpectralModel::latencyBlocks() const
+{
+    return mLatencyBlocks;
+}
+
+const float* SpectralModel::infer(const float* in, std::size_t frames)
+{
+    // the tail of the last block becomes the head of this one
+    std::copy(mOutput.end() - mPadding, mOutput.end(), mOutput.begin());
+    mDenoiser.process(in, mOutput.data() + mPadding, frames);
+    return mOutput.data();
+}
+
+bool SpectralModel::resetState()
+{
+    mDenoiser.reset();
+    std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef SPECTRAL_MODEL_H
+#define SPECTRAL_MODEL_H
+
+#include <vector>
+
+#include "../Filters/SpectralDenoiser.h"
+#include "InferenceModel.h"
+
+/// @brief Model backend running the SpectralDenoiser instead of a network,
+/// the low-cost tier for hosts that cannot afford the model. As a backend it
+/// plugs into everything that takes a model: the governed stream, model
+/// swaps and ModelProbe benchmarks. The denoiser delays by one 1536 sample
+/// frame; for other block sizes the output is delayed further to a whole
+/// number of blocks.
+class SpectralModel : public InferenceModel
+{
+  private:
+    /// @brief The denoiser.
+    SpectralDenoiser mDenoiser;
+    /// @brief Number of frames in one model block.
+    std::size_t mBlockLen;
+    /// @brief Number of blocks the output lags behind.
+    std::size_t mLatencyBlocks;
+    /// @brief Frames of extra delay to round the latency up to whole blocks.
+    std::size_t mPadding;
+    /// @brief The padding delay followed by the output block.
+    std::vector<float> mOutput;
+
+  public:
+    /// @brief Constructor for the SpectralModel class.
+    /// @param blockLen Number of frames in one model block.
+    /// @param sampleRate Sample rate. Defaults to 48000.
+    SpectralModel(std::size_t blockLen, int sampleRate = 48000);
+
+    const char* name() const override;
+    std::size_t blockSize() const override;
+    std::size_t latencyBlocks() const override;
+    const float* infer(const float* in, std::size_t frames) override;
+    bool resetState() override;
+};
+
+#endif // SPECTRAL_MODEL_H
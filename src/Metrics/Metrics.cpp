@@ -0,0 +1,453 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <limits>
+#include <thread>
+
+#include "sndfile.h"
+
+#include "../DSP/Fft.h"
+#include "../Util/Log.h"
+
+namespace
+{
+/// @brief Guard against division by zero, numpy's float eps.
+constexpr double kEps = DBL_EPSILON;
+/// @brief Frames read from each file at a time.
+constexpr std::size_t kChunkFrames = 1 << 16;
+
+/// @brief Segmental SNR frame length in seconds.
+constexpr double kSegSeconds = 0.03;
+/// @brief Lowest frame SNR counted by the segmental SNR.
+constexpr double kSegMinDb = -10;
+/// @brief Highest frame SNR counted by the segmental SNR.
+constexpr double kSegMaxDb = 35;
+
+/// @brief Sample rate STOI works at.
+constexpr int kStoiRate = 10000;
+/// @brief STOI frame length, 25.6 ms.
+constexpr std::size_t kStoiFrame = 256;
+/// @brief STOI frame hop.
+constexpr std::size_t kStoiHop = kStoiFrame / 2;
+/// @brief STOI FFT size.
+constexpr std::size_t kStoiFft = 512;
+/// @brief Number of one-third octave bands.
+constexpr std::size_t kStoiBands = 15;
+/// @brief Center frequency of the lowest band.
+constexpr double kStoiMinFreq = 150;
+/// @brief Frames per intermediate intelligibility segment, 384 ms.
+constexpr std::size_t kStoiSegment = 30;
+/// @brief Lower bound of the signal-to-distortion ratio in dB.
+constexpr double kStoiBeta = -15;
+/// @brief Range below the loudest frame that counts as speech, in dB.
+constexpr double kStoiDynamicRange = 40;
+
+/// @brief Returns 10 log10 of an energy ratio.
+double decibels(double signal, double noise)
+{
+    return 10 * std::log10((signal + kEps) / (noise + kEps));
+}
+
+/// @brief Returns the Hann window numpy.hanning(length + 2)[1:-1], which
+/// matches MATLAB's hanning(length).
+std::vector<double> hanning(std::size_t length)
+{
+    const double pi = std::acos(-1.0);
+    std::vector<double> window(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        window[i] = 0.5 - 0.5 * std::cos(2 * pi * (i + 1) / (length + 1));
+    }
+    return window;
+}
+
+/// @brief Removes the frames more than the dynamic range below the loudest
+/// reference frame from both signals and overlap-adds the rest.
+void removeSilentFrames(const std::vector<float>& x,
+                        const std::vector<float>& y, std::size_t length,
+                        std::vector<double>& xOut, std::vector<double>& yOut)
+{
+    std::vector<double> window = hanning(kStoiFrame);
+    std::vector<std::size_t> starts;
+    std::vector<double> energies;
+    for (std::size_t start = 0; start + kStoiFrame < length;
+         start += kStoiHop) {
+        double energy = 0;
+        for (std::size_t i = 0; i < kStoiFrame; ++i) {
+            double sample = window[i] * x[start + i];
+            energy += sample * sample;
+        }
+        starts.push_back(start);
+        energies.push_back(20 * std::log10(std::sqrt(energy) + kEps));
+    }
+    if (starts.empty()) {
+        return;
+    }
+
+    double loudest = *std::max_element(energies.begin(), energies.end());
+    std::size_t kept = 0;
+    for (std::size_t f = 0; f < starts.size(); ++f) {
+        if (energies[f] > loudest - kStoiDynamicRange) {
+            ++kept;
+        }
+    }
+    xOut.assign((kept - 1) * kStoiHop + kStoiFrame, 0.0);
+    yOut.assign(xOut.size(), 0.0);
+
+    std::size_t position = 0;
+    for (std::size_t f = 0; f < starts.size(); ++f) {
+        if (energies[f] <= loudest - kStoiDynamicRange) {
+            continue;
+        }
+        for (std::size_t i = 0; i < kStoiFrame; ++i) {
+            xOut[position + i] += window[i] * x[starts[f] + i];
+            yOut[position + i] += window[i] * y[starts[f] + i];
+        }
+        position += kStoiHop;
+    }
+}
+
+/// @brief Computes the one-third octave band magnitudes of every frame.
+/// @param signal The signal without silent frames.
+/// @param low First FFT bin of each band.
+/// @param high One past the last FFT bin of each band.
+/// @param frames Receives the number of frames.
+/// @return The magnitudes, band-major.
+std::vector<double> thirdOctaveBands(const std::vector<double>& signal,
+                                     const std::vector<std::size_t>& low,
+                                     const std::vector<std::size_t>& high,
+                                     std::size_t& frames)
+{
+    std::vector<double> window = hanning(kStoiFrame);
+    frames = signal.size() > kStoiFrame
+                 ? (signal.size() - kStoiFrame - 1) / kStoiHop + 1
+                 : 0;
+
+    Fft fft(kStoiFft);
+    std::vector<float> padded(kStoiFft, 0.0f);
+    std::vector<std::complex<float>> spectrum(kStoiFft / 2 + 1);
+    std::vector<double> power(spectrum.size());
+    std::vector<double> bands(kStoiBands * frames);
+    for (std::size_t t = 0; t < frames; ++t) {
+        for (std::size_t i = 0; i < kStoiFrame; ++i) {
+            padded[i] = static_cast<float>(window[i] *
+                                           signal[t * kStoiHop + i]);
+        }
+        fft.forwardReal(padded.data(), spectrum.data());
+        for (std::size_t k = 0; k < spectrum.size(); ++k) {
+            power[k] = std::norm(std::complex<double>(spectrum[k]));
+        }
+        for (std::size_t b = 0; b < kStoiBands; ++b) {
+            double sum = 0;
+            for (std::size_t k = low[b]; k < high[b]; ++k) {
+                sum += power[k];
+            }
+            bands[b * frames + t] = std::sqrt(sum);
+        }
+    }
+    return bands;
+}
+
+/// @brief Returns the FFT bin closest to a frequency, the lower one on a tie.
+std::size_t nearestBin(double frequency)
+{
+    std::size_t best = 0;
+    double bestDistance = std::numeric_limits<double>::max();
+    for (std::size_t k = 0; k <= kStoiFft / 2; ++k) {
+        double distance = static_cast<double>(k) * kStoiRate / kStoiFft -
+                          frequency;
+        if (distance * distance < bestDistance) {
+            bestDistance = distance * distance;
+            best = k;
+        }
+    }
+    return best;
+}
+} // namespace
+
+const char* MetricScores::csvHeader()
+{
+    return "reference,processed,frames,snr,seg_snr,si_sdr,stoi";
+}
+
+std::string MetricScores::toCsv() const
+{
+    char scores[160];
+    std::snprintf(scores, sizeof(scores), ",%llu,%.6f,%.6f,%.6f,%.6f",
+                  static_cast<unsigned long long>(frames), snr, segSnr, siSdr,
+                  stoi);
+    return reference + "," + processed + scores;
+}
+
+MetricAccumulator::MetricAccumulator(int sampleRate) :
+    mSampleRate(sampleRate), mFrames(0), mRefSum(0), mEstSum(0),
+    mRefEnergy(0), mEstEnergy(0), mCross(0), mErrorEnergy(0),
+    mSegLength(static_cast<std::size_t>(std::lround(kSegSeconds *
+                                                    sampleRate))),
+    mSegHop(std::max<std::size_t>(mSegLength / 4, 1)), mSegOffset(0),
+    mSegSum(0), mSegCount(0), mSegPending(0), mSegHasPending(false),
+    mResample(sampleRate != kStoiRate),
+    mRefResampler(sampleRate, kStoiRate), mEstResampler(sampleRate, kStoiRate)
+{
+    // pysepm's window, zero only outside the frame
+    const double pi = std::acos(-1.0);
+    mSegWindow.resize(mSegLength);
+    for (std::size_t i = 0; i < mSegLength; ++i) {
+        mSegWindow[i] =
+            0.5 * (1 - std::cos(2 * pi * (i + 1) / (mSegLength + 1)));
+    }
+}
+
+void MetricAccumulator::push(const float* reference, const float* processed,
+                             std::size_t frames)
+{
+    // independent sums per statistic keep the loop vectorizable
+    double refSum = 0;
+    double estSum = 0;
+    double refEnergy = 0;
+    double estEnergy = 0;
+    double cross = 0;
+    double errorEnergy = 0;
+    for (std::size_t i = 0; i < frames; ++i) {
+        double r = reference[i];
+        double e = processed[i];
+        refSum += r;
+        estSum += e;
+        refEnergy += r * r;
+        estEnergy += e * e;
+        cross += r * e;
+        errorEnergy += (r - e) * (r - e);
+    }
+    mRefSum += refSum;
+    mEstSum += estSum;
+    mRefEnergy += refEnergy;
+    mEstEnergy += estEnergy;
+    mCross += cross;
+    mErrorEnergy += errorEnergy;
+    mFrames += frames;
+
+    mSegRef.insert(mSegRef.end(), reference, reference + frames);
+    mSegEst.insert(mSegEst.end(), processed, processed + frames);
+    frameSegments();
+
+    if (mResample) {
+        mRefResampler.process(reference, frames, mRefStoi);
+        mEstResampler.process(processed, frames, mEstStoi);
+    } else {
+        mRefStoi.insert(mRefStoi.end(), reference, reference + frames);
+        mEstStoi.insert(mEstStoi.end(), processed, processed + frames);
+    }
+}
+
+void MetricAccumulator::frameSegments()
+{
+    while (mSegOffset + mSegLength <= mSegRef.size()) {
+        double signal = 0;
+        double noise = 0;
+        for (std::size_t i = 0; i < mSegLength; ++i) {
+            double r = mSegWindow[i] * mSegRef[mSegOffset + i];
+            double e = mSegWindow[i] * mSegEst[mSegOffset + i];
+            signal += r * r;
+            noise += (r - e) * (r - e);
+        }
+        double snr = 10 * std::log10(signal / (noise + kEps) + kEps);
+
+        // the last frame of the signal is left out, as in pysepm
+        if (mSegHasPending) {
+            mSegSum += mSegPending;
+            ++mSegCount;
+        }
+        mSegPending = std::clamp(snr, kSegMinDb, kSegMaxDb);
+        mSegHasPending = true;
+        mSegOffset += mSegHop;
+    }
+
+    mSegRef.erase(mSegRef.begin(), mSegRef.begin() + mSegOffset);
+    mSegEst.erase(mSegEst.begin(), mSegEst.begin() + mSegOffset);
+    mSegOffset = 0;
+}
+
+MetricScores MetricAccumulator::finish()
+{
+    MetricScores scores;
+    scores.ok = true;
+    scores.frames = mFrames;
+    scores.snr = decibels(mRefEnergy, mErrorEnergy);
+    scores.segSnr = mSegCount > 0 ? mSegSum / mSegCount
+                                  : std::numeric_limits<double>::quiet_NaN();
+
+    // SI-SDR of the zero-mean signals, from the running sums
+    double n = mFrames > 0 ? static_cast<double>(mFrames) : 1;
+    double refEnergy = mRefEnergy - mRefSum * mRefSum / n;
+    double estEnergy = mEstEnergy - mEstSum * mEstSum / n;
+    double cross = mCross - mRefSum * mEstSum / n;
+    double scale = cross / (refEnergy + kEps);
+    double target = scale * scale * refEnergy;
+    double distortion =
+        std::max(estEnergy - 2 * scale * cross + target, 0.0);
+    scores.siSdr = decibels(target, distortion);
+
+    if (mResample) {
+        mRefResampler.flush(mRefStoi);
+        mEstResampler.flush(mEstStoi);
+    }
+    scores.stoi = Metrics::stoi(mRefStoi, mEstStoi);
+    return scores;
+}
+
+double Metrics::stoi(const std::vector<float>& reference,
+                     const std::vector<float>& processed)
+{
+    std::size_t length = std::min(reference.size(), processed.size());
+    std::vector<double> x;
+    std::vector<double> y;
+    removeSilentFrames(reference, processed, length, x, y);
+
+    // one-third octave bands between the FFT bins closest to their edges
+    std::vector<std::size_t> low(kStoiBands);
+    std::vector<std::size_t> high(kStoiBands);
+    for (std::size_t b = 0; b < kStoiBands; ++b) {
+        low[b] = nearestBin(kStoiMinFreq * std::pow(2.0, (2.0 * b - 1) / 6));
+        high[b] = nearestBin(kStoiMinFreq * std::pow(2.0, (2.0 * b + 1) / 6));
+    }
+
+    std::size_t frames = 0;
+    std::vector<double> xBands = thirdOctaveBands(x, low, high, frames);
+    std::vector<double> yBands = thirdOctaveBands(y, low, high, frames);
+    if (frames < kStoiSegment) {
+        Log::write(LogLevel::Warning,
+                   "Not enough STOI frames (%zu), returning 1e-5", frames);
+        return 1e-5;
+    }
+
+    // correlation of the clipped, normalized envelopes per segment and band
+    const double clip = std::pow(10.0, -kStoiBeta / 20);
+    double sum = 0;
+    double xs[kStoiSegment];
+    double ys[kStoiSegment];
+    for (std::size_t end = kStoiSegment; end <= frames; ++end) {
+        for (std::size_t b = 0; b < kStoiBands; ++b) {
+            const double* xRow = &xBands[b * frames + end - kStoiSegment];
+            const double* yRow = &yBands[b * frames + end - kStoiSegment];
+
+            double xNorm = 0;
+            double yNorm = 0;
+            for (std::size_t i = 0; i < kStoiSegment; ++i) {
+                xNorm += xRow[i] * xRow[i];
+                yNorm += yRow[i] * yRow[i];
+            }
+            double gain = std::sqrt(xNorm) / (std::sqrt(yNorm) + kEps);
+
+            double xMean = 0;
+            double yMean = 0;
+            for (std::size_t i = 0; i < kStoiSegment; ++i) {
+                xs[i] = xRow[i];
+                ys[i] = std::min(yRow[i] * gain, xRow[i] * (1 + clip));
+                xMean += xs[i];
+                yMean += ys[i];
+            }
+            xMean /= kStoiSegment;
+            yMean /= kStoiSegment;
+
+            double xx = 0;
+            double yy = 0;
+            double xy = 0;
+            for (std::size_t i = 0; i < kStoiSegment; ++i) {
+                xs[i] -= xMean;
+                ys[i] -= yMean;
+                xx += xs[i] * xs[i];
+                yy += ys[i] * ys[i];
+                xy += xs[i] * ys[i];
+            }
+            sum += xy / ((std::sqrt(xx) + kEps) * (std::sqrt(yy) + kEps));
+        }
+    }
+    return sum / (kStoiBands * (frames - kStoiSegment + 1));
+}
+
+MetricScores Metrics::scoreFiles(const std::string& reference,
+                                 const std::string& processed)
+{
+    MetricScores failed;
+    failed.reference = reference;
+    failed.processed = processed;
+
+    SF_INFO refInfo = {};
+    SF_INFO estInfo = {};
+    SNDFILE* refFile = sf_open(reference.c_str(), SFM_READ, &refInfo);
+    SNDFILE* estFile = sf_open(processed.c_str(), SFM_READ, &estInfo);
+    if (refFile == nullptr || estFile == nullptr ||
+        refInfo.samplerate != estInfo.samplerate) {
+        Log::write(LogLevel::Error, "Cannot score %s against %s", processed,
+                   reference);
+        if (refFile != nullptr) {
+            sf_close(refFile);
+        }
+        if (estFile != nullptr) {
+            sf_close(estFile);
+        }
+        return failed;
+    }
+
+    MetricAccumulator accumulator(refInfo.samplerate);
+    std::vector<float> refChunk(kChunkFrames * refInfo.channels);
+    std::vector<float> estChunk(kChunkFrames * estInfo.channels);
+    std::vector<float> refMono(kChunkFrames);
+    std::vector<float> estMono(kChunkFrames);
+    while (true) {
+        sf_count_t refRead =
+            sf_readf_float(refFile, refChunk.data(), kChunkFrames);
+        sf_count_t estRead =
+            sf_readf_float(estFile, estChunk.data(), kChunkFrames);
+        auto frames = static_cast<std::size_t>(
+            std::max<sf_count_t>(std::min(refRead, estRead), 0));
+        if (frames == 0) {
+            break;
+        }
+        for (std::size_t i = 0; i < frames; ++i) {
+            refMono[i] = refChunk[i * refInfo.channels];
+            estMono[i] = estChunk[i * estInfo.channels];
+        }
+        accumulator.push(refMono.data(), estMono.data(), frames);
+    }
+    sf_close(refFile);
+    sf_close(estFile);
+
+    MetricScores scores = accumulator.finish();
+    scores.reference = reference;
+    scores.processed = processed;
+    return scores;
+}
+
+std::vector<MetricScores> Metrics::scoreBatch(
+    const std::vector<std::pair<std::string, std::string>>& pairs,
+    std::size_t threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, pairs.size());
+
+    // every worker takes the next unscored pair until none is left
+    std::vector<MetricScores> scores(pairs.size());
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+        for (std::size_t i = next++; i < pairs.size(); i = next++) {
+            scores[i] = scoreFiles(pairs[i].first, pairs[i].second);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return scores;
+}
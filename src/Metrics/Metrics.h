@@ -0,0 +1,151 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../DSP/Resampler.h"
+
+/// @brief Objective quality scores of a processed signal against its clean
+/// reference. Each score follows the definition of its Python version in
+/// Model/Metrics.py.
+struct MetricScores
+{
+    /// @brief Reference file, empty for in-memory signals.
+    std::string reference;
+    /// @brief Processed file, empty for in-memory signals.
+    std::string processed;
+    /// @brief Flag to indicate that both signals could be read.
+    bool ok = false;
+    /// @brief Number of compared frames, the shorter signal's length.
+    std::uint64_t frames = 0;
+    /// @brief Signal-to-noise ratio in dB.
+    double snr = 0;
+    /// @brief Mean of the per-frame SNRs in dB, clamped to [-10, 35].
+    double segSnr = 0;
+    /// @brief Scale-invariant signal-to-distortion ratio in dB.
+    double siSdr = 0;
+    /// @brief Short-time objective intelligibility, 0 to 1.
+    double stoi = 0;
+
+    /// @brief Returns the column names of toCsv.
+    /// @return One CSV line without the line break.
+    static const char* csvHeader();
+    /// @brief Formats the scores as one CSV line.
+    /// @return The line without the line break.
+    std::string toCsv() const;
+};
+
+/// @brief Computes all scores in one pass over a pair of signals fed in
+/// chunks of any size. SNR, segmental SNR and SI-SDR keep running sums only;
+/// STOI keeps both signals resampled to 10 kHz, a fifth of the input at
+/// 48 kHz, because its silence removal depends on the loudest frame.
+class MetricAccumulator
+{
+  private:
+    /// @brief Sample rate of the signals.
+    int mSampleRate;
+    /// @brief Number of frames pushed.
+    std::uint64_t mFrames;
+
+    /// @brief Sum of the reference.
+    double mRefSum;
+    /// @brief Sum of the processed signal.
+    double mEstSum;
+    /// @brief Energy of the reference.
+    double mRefEnergy;
+    /// @brief Energy of the processed signal.
+    double mEstEnergy;
+    /// @brief Inner product of the two signals.
+    double mCross;
+    /// @brief Energy of the difference.
+    double mErrorEnergy;
+
+    /// @brief Frame length of the segmental SNR, 30 ms.
+    std::size_t mSegLength;
+    /// @brief Frame hop of the segmental SNR, a quarter frame.
+    std::size_t mSegHop;
+    /// @brief Hann window of the segmental SNR frames.
+    std::vector<double> mSegWindow;
+    /// @brief Reference frames not yet framed.
+    std::vector<float> mSegRef;
+    /// @brief Processed frames not yet framed.
+    std::vector<float> mSegEst;
+    /// @brief Start of the next frame in the pending frames.
+    std::size_t mSegOffset;
+    /// @brief Sum of the counted frame SNRs.
+    double mSegSum;
+    /// @brief Number of counted frames.
+    std::size_t mSegCount;
+    /// @brief SNR of the newest frame, which is only counted once another
+    /// frame follows it.
+    double mSegPending;
+    /// @brief Flag to indicate that mSegPending holds a frame.
+    bool mSegHasPending;
+
+    /// @brief Flag to indicate that STOI needs resampling.
+    bool mResample;
+    /// @brief Resampler of the reference to 10 kHz.
+    Resampler mRefResampler;
+    /// @brief Resampler of the processed signal to 10 kHz.
+    Resampler mEstResampler;
+    /// @brief Reference at 10 kHz.
+    std::vector<float> mRefStoi;
+    /// @brief Processed signal at 10 kHz.
+    std::vector<float> mEstStoi;
+
+    /// @brief Scores the complete frames of the segmental SNR.
+    void frameSegments();
+
+  public:
+    /// @brief Constructor for the MetricAccumulator class.
+    /// @param sampleRate Sample rate of the signals.
+    explicit MetricAccumulator(int sampleRate);
+
+    /// @brief Adds a chunk of both signals.
+    /// @param reference Reference frames.
+    /// @param processed Processed frames.
+    /// @param frames Number of frames.
+    void push(const float* reference, const float* processed,
+              std::size_t frames);
+
+    /// @brief Computes the scores of everything pushed.
+    /// @return The scores.
+    MetricScores finish();
+};
+
+/// @brief The Metrics class scores processed files against their references
+/// without going through Python, one file per thread for batches.
+class Metrics
+{
+  public:
+    /// @brief Computes STOI the way pystoi does, including the removal of
+    /// frames 40 dB below the loudest one.
+    /// @param reference Reference at 10 kHz.
+    /// @param processed Processed signal at 10 kHz, as long as the reference.
+    /// @return The score, 1e-5 if the signal is shorter than one segment.
+    static double stoi(const std::vector<float>& reference,
+                       const std::vector<float>& processed);
+
+    /// @brief Scores one file pair, streaming both files in chunks. The
+    /// first channel is used and the longer file is cut.
+    /// @param reference Clean reference file.
+    /// @param processed Processed file with the same sample rate.
+    /// @return The scores, not ok if a file cannot be read or the sample
+    /// rates differ.
+    static MetricScores scoreFiles(const std::string& reference,
+                                   const std::string& processed);
+
+    /// @brief Scores many file pairs in parallel.
+    /// @param pairs Reference and processed file of each pair.
+    /// @param threads Number of worker threads, 0 for one per core.
+    /// @return The scores in the order of the pairs.
+    static std::vector<MetricScores>
+    scoreBatch(const std::vector<std::pair<std::string, std::string>>& pairs,
+               std::size_t threads = 0);
+};
+
+#endif // METRICS_H
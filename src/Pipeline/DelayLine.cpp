@@ -0,0 +1,52 @@
+#include "DelayLine.h"
+
+#include <algorithm>
+
+DelayLine::DelayLine() :
+    mDelay(0), mHistory(nullptr), mBlock(nullptr), mPosition(0)
+{}
+
+std::size_t DelayLine::arenaBytes(std::size_t delay, std::size_t maxFrames)
+{
+    if (delay == 0) {
+        return 0;
+    }
+    return Arena::bytesFor<float>(delay) + Arena::bytesFor<float>(maxFrames);
+}
+
+void DelayLine::prepare(std::size_t delay, std::size_t maxFrames,
+                        Arena& arena)
+{
+    mDelay = delay;
+    mHistory = nullptr;
+    mBlock = nullptr;
+    if (mDelay > 0) {
+        mHistory = arena.allocate<float>(mDelay);
+        mBlock = arena.allocate<float>(maxFrames);
+    }
+    reset();
+}
+
+void DelayLine::reset()
+{
+    if (mHistory != nullptr) {
+        std::fill(mHistory, mHistory + mDelay, 0.0f);
+    }
+    mPosition = 0;
+}
+
+const float* DelayLine::process(const float* in, std::size_t frames)
+{
+    if (mDelay == 0) {
+        return in;
+    }
+
+    for (std::size_t i = 0; i < frames; ++i) {
+        mBlock[i] = mHistory[mPosition];
+        mHistory[mPosition] = in[i];
+        if (++mPosition == mDelay) {
+            mPosition = 0;
+        }
+    }
+    return mBlock;
+}
@@ -0,0 +1,49 @@
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+#include <cstddef>
+
+#include "../Util/Arena.h"
+
+/// @brief Fixed delay of a block stream, used to keep a signal aligned with
+/// one that went through a stage with latency. Its memory comes from a
+/// pipeline arena, so it never allocates while running.
+class DelayLine
+{
+  private:
+    /// @brief Delay in frames.
+    std::size_t mDelay;
+    /// @brief The last mDelay input frames, used as a ring.
+    float* mHistory;
+    /// @brief The delayed block of the last call.
+    float* mBlock;
+    /// @brief Ring position of the oldest frame.
+    std::size_t mPosition;
+
+  public:
+    /// @brief Constructor for the DelayLine class, without delay.
+    DelayLine();
+
+    /// @brief Returns the arena memory taken by prepare.
+    /// @param delay Delay in frames.
+    /// @param maxFrames The maximum number of frames per call.
+    /// @return The size in bytes, as summed with Arena::bytesFor.
+    static std::size_t arenaBytes(std::size_t delay, std::size_t maxFrames);
+
+    /// @brief Allocates the delay memory and clears it.
+    /// @param delay Delay in frames, 0 makes process return its input.
+    /// @param maxFrames The maximum number of frames per call.
+    /// @param arena The arena to allocate from.
+    void prepare(std::size_t delay, std::size_t maxFrames, Arena& arena);
+
+    /// @brief Fills the delay with silence.
+    void reset();
+
+    /// @brief Delays one block.
+    /// @param in Pointer to the input frames.
+    /// @param frames Number of frames.
+    /// @return Pointer to the delayed frames, valid until the next call.
+    const float* process(const float* in, std::size_t frames);
+};
+
+#endif // DELAY_LINE_H
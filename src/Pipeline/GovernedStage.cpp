@@ -0,0 +1,157 @@
+#include "GovernedStage.h"
+
+#include <algorithm>
+#include <chrono>
+
+GovernedStage::GovernedStage(int sampleRate, std::unique_ptr<Stage> model,
+                             std::unique_ptr<Stage> kalman,
+                             std::unique_ptr<Stage> gate) :
+    mTiers{std::move(model), std::move(kalman), std::move(gate)},
+    mSampleRate(sampleRate), mBlockSeconds(0),
+    mFadeFromTier(ProcessingTier::Model), mPrimeFrames(0), mArena(nullptr),
+    mTierBuffer(nullptr)
+{}
+
+Stage& GovernedStage::stage(ProcessingTier tier)
+{
+    return *mTiers[static_cast<int>(tier)];
+}
+
+const float* GovernedStage::tierInput(ProcessingTier tier, const float* in,
+                                      const float* delayed) const
+{
+    return tier == ProcessingTier::Model ? in : delayed;
+}
+
+const DegradationGovernor& GovernedStage::governor() const
+{
+    return mGovernor;
+}
+
+void GovernedStage::setDeadline(double seconds)
+{
+    mGovernor.setDeadline(seconds);
+}
+
+const char* GovernedStage::name() const
+{
+    return "governed";
+}
+
+std::size_t GovernedStage::blockSize() const
+{
+    std::size_t blockSize = 0;
+    for (const auto& tier : mTiers) {
+        blockSize = std::max(blockSize, tier->blockSize());
+    }
+    return blockSize;
+}
+
+std::size_t GovernedStage::latency() const
+{
+    // tiers are crossfaded sample by sample, the cheaper ones are delayed to
+    // the latency of the model
+    return mTiers[0]->latency();
+}
+
+bool GovernedStage::inPlace() const
+{
+    // a downgrade in the block after an upgrade reads the input last
+    return false;
+}
+
+std::size_t GovernedStage::arenaBytes(std::size_t maxFrames) const
+{
+    // the tier block is kept, up to two fallback blocks live during fades
+    std::size_t bytes = 3 * Arena::bytesFor<float>(maxFrames) +
+                        DelayLine::arenaBytes(latency(), maxFrames);
+    for (const auto& tier : mTiers) {
+        bytes += tier->arenaBytes(maxFrames);
+    }
+    return bytes;
+}
+
+void GovernedStage::prepare(std::size_t maxFrames, Arena& arena)
+{
+    for (const auto& tier : mTiers) {
+        tier->prepare(maxFrames, arena);
+    }
+    mArena = &arena;
+    mTierBuffer = arena.allocate<float>(maxFrames);
+    mInputDelay.prepare(latency(), maxFrames, arena);
+    mBlockSeconds = static_cast<double>(maxFrames) / mSampleRate;
+    reset();
+}
+
+void GovernedStage::reset()
+{
+    for (const auto& tier : mTiers) {
+        tier->reset();
+    }
+    mGovernor.reset(mBlockSeconds);
+    mInputDelay.reset();
+    mFadeFromTier = ProcessingTier::Model;
+    mPrimeFrames = 0;
+}
+
+const float* GovernedStage::process(const float* in, float* out,
+                                    std::size_t frames)
+{
+    auto blockStart = std::chrono::steady_clock::now();
+    ArenaScope scope(*mArena);
+
+    // the input is read by every tier, so out is only written at the end;
+    // the delay runs every block to keep its history current
+    const float* delayed = mInputDelay.process(in, frames);
+    ProcessingTier tier = mGovernor.tier();
+    const float* processed =
+        stage(tier).process(tierInput(tier, in, delayed), mTierBuffer, frames);
+
+    // fade in the better tier after an upgrade, once it has filled its
+    // latency
+    ProcessingTier fadeFromTier = mFadeFromTier;
+    const float* previous = nullptr;
+    if (fadeFromTier != tier) {
+        float* fallback = mArena->allocate<float>(frames);
+        previous = stage(fadeFromTier)
+                       .process(tierInput(fadeFromTier, in, delayed),
+                                fallback, frames);
+        if (mPrimeFrames > 0) {
+            // the fallback block is scratch of this call, it must not be
+            // returned
+            mPrimeFrames -= std::min(mPrimeFrames, frames);
+            std::copy(previous, previous + frames, out);
+            processed = out;
+        } else {
+            DegradationGovernor::crossfade(previous, processed, out, frames);
+            processed = out;
+            mFadeFromTier = tier;
+        }
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - blockStart;
+    ProcessingTier nextTier = mGovernor.update(elapsed.count());
+
+    // fade out to the cheaper tier right away, it is cheap to run; a failed
+    // upgrade fades back to the block the upgrade faded from, a tier must
+    // not advance its state twice in one block
+    if (nextTier > tier) {
+        const float* cheaper = previous;
+        if (previous == nullptr || nextTier != fadeFromTier) {
+            float* fallback = mArena->allocate<float>(frames);
+            cheaper = stage(nextTier).process(
+                tierInput(nextTier, in, delayed), fallback, frames);
+        }
+        DegradationGovernor::crossfade(processed, cheaper, out, frames);
+        processed = out;
+        mFadeFromTier = nextTier;
+        mPrimeFrames = 0;
+    } else if (nextTier < tier) {
+        // the better tier was skipped, what it still holds is stale
+        stage(nextTier).resume();
+        mPrimeFrames = stage(nextTier).latency();
+    }
+
+    return processed;
+}
@@ -0,0 +1,88 @@
+#ifndef GOVERNED_STAGE_H
+#define GOVERNED_STAGE_H
+
+#include <array>
+#include <memory>
+
+#include "../Stream/DegradationGovernor.h"
+#include "DelayLine.h"
+#include "Stage.h"
+
+/// @brief Stage that runs one of several alternative stages, ordered from the
+/// best to the cheapest, as chosen by a DegradationGovernor. Its own
+/// processing time is reported to the governor after every block, and every
+/// switch is crossfaded over one block. The extra stage rendered for a fade
+/// is always the cheaper one: a downgrade fades within the block that
+/// triggered it, an upgrade fades in the following block. The cheaper tiers
+/// add no latency, so when the model tier does they get their input delayed
+/// by the same amount to stay aligned in the fades. Every tier runs at most
+/// once per block and the input stays intact until the last tier has read
+/// it, so the stage never runs in place. A tier coming back after an upgrade
+/// is resumed first, and while it refills its latency the cheaper tier stays
+/// in the output, the fade starts once its output is current.
+class GovernedStage : public Stage
+{
+  private:
+    /// @brief Alternative stages indexed by ProcessingTier.
+    std::array<std::unique_ptr<Stage>, kProcessingTierCount> mTiers;
+    /// @brief Governor that picks the tier for every block.
+    DegradationGovernor mGovernor;
+    /// @brief Sample rate, used to convert blocks to seconds.
+    int mSampleRate;
+    /// @brief Duration of one block in seconds.
+    double mBlockSeconds;
+    /// @brief Tier to fade from in the next block after an upgrade.
+    ProcessingTier mFadeFromTier;
+    /// @brief Frames the upgraded tier still needs before the fade.
+    std::size_t mPrimeFrames;
+    /// @brief Arena the scratch blocks come from.
+    Arena* mArena;
+    /// @brief Scratch block for the current tier.
+    float* mTierBuffer;
+    /// @brief Input delayed by the latency of the model tier, fed to the
+    /// cheaper tiers.
+    DelayLine mInputDelay;
+
+    /// @brief Returns the stage of a tier.
+    /// @param tier The tier.
+    /// @return Reference to the stage.
+    Stage& stage(ProcessingTier tier);
+
+    /// @brief Returns the input of a tier, delayed for the cheaper tiers.
+    /// @param tier The tier.
+    /// @param in The stage input.
+    /// @param delayed The delayed stage input.
+    /// @return Pointer to the input frames of the tier.
+    const float* tierInput(ProcessingTier tier, const float* in,
+                           const float* delayed) const;
+
+  public:
+    /// @brief Constructor for the GovernedStage class.
+    /// @param sampleRate Sample rate.
+    /// @param model Stage for ProcessingTier::Model.
+    /// @param kalman Stage for ProcessingTier::Kalman.
+    /// @param gate Stage for ProcessingTier::Gate.
+    GovernedStage(int sampleRate, std::unique_ptr<Stage> model,
+                  std::unique_ptr<Stage> kalman, std::unique_ptr<Stage> gate);
+
+    /// @brief Returns the governor driving the stage.
+    /// @return Reference to the governor.
+    const DegradationGovernor& governor() const;
+
+    /// @brief Sets the time a block may take, the block duration until then.
+    /// Reset by prepare and reset.
+    /// @param seconds The deadline in seconds.
+    void setDeadline(double seconds);
+
+    const char* name() const override;
+    std::size_t blockSize() const override;
+    std::size_t latency() const override;
+    bool inPlace() const override;
+    std::size_t arenaBytes(std::size_t maxFrames) const override;
+    void prepare(std::size_t maxFrames, Arena& arena) override;
+    void reset() override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+#endif // GOVERNED_STAGE_H
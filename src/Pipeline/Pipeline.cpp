@@ -0,0 +1,133 @@
+#include "Pipeline.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "../Util/Trace.h"
+
+Pipeline::Pipeline() :
+    mBlockSize(0), mBuffers{nullptr, nullptr}, mKernels(selectKernels(0))
+{}
+
+void Pipeline::clear()
+{
+    mStages.clear();
+    mArena.reserve(0);
+    mBlockSize = 0;
+    mBuffers[0] = nullptr;
+    mBuffers[1] = nullptr;
+}
+
+void Pipeline::build(std::size_t blockSize, std::size_t extraBytes)
+{
+    for (const auto& stage : mStages) {
+        if (stage->blockSize() != 0 && stage->blockSize() != blockSize) {
+            throw std::invalid_argument(
+                std::string("Stage ") + stage->name() + " needs blocks of " +
+                std::to_string(stage->blockSize()) + " frames, pipeline has " +
+                std::to_string(blockSize));
+        }
+    }
+
+    // size the arena once, nothing is allocated from the system after this
+    std::size_t bytes = 2 * Arena::bytesFor<float>(blockSize) + extraBytes;
+    for (const auto& stage : mStages) {
+        bytes += stage->arenaBytes(blockSize);
+    }
+    mArena.reserve(bytes);
+
+    mBlockSize = blockSize;
+    mBuffers[0] = mArena.allocate<float>(blockSize);
+    mBuffers[1] = mArena.allocate<float>(blockSize);
+    std::fill(mBuffers[0], mBuffers[0] + blockSize, 0.0f);
+    std::fill(mBuffers[1], mBuffers[1] + blockSize, 0.0f);
+    mKernels = selectKernels(blockSize);
+
+    for (const auto& stage : mStages) {
+        stage->prepare(blockSize, mArena);
+    }
+}
+
+void Pipeline::reset()
+{
+    for (const auto& stage : mStages) {
+        stage->reset();
+    }
+}
+
+std::size_t Pipeline::blockSize() const
+{
+    return mBlockSize;
+}
+
+std::size_t Pipeline::latency() const
+{
+    std::size_t latency = 0;
+    for (const auto& stage : mStages) {
+        latency += stage->latency();
+    }
+    return latency;
+}
+
+std::size_t Pipeline::prefault()
+{
+    return mArena.prefault();
+}
+
+Arena& Pipeline::arena()
+{
+    return mArena;
+}
+
+const Arena& Pipeline::arena() const
+{
+    return mArena;
+}
+
+std::size_t Pipeline::size() const
+{
+    return mStages.size();
+}
+
+const float* Pipeline::run(const float* in, std::size_t frames)
+{
+    // scratch taken by the stages is only needed for this run
+    ArenaScope scope(mArena);
+
+    const float* current = in;
+    // index of the ping-pong buffer holding the current data, -1 if none
+    int owned = -1;
+
+    for (const auto& stage : mStages) {
+        RTNR_TRACE_SCOPE(stage->name());
+
+        float* out;
+        if (stage->inPlace() && owned >= 0) {
+            out = mBuffers[owned];
+        } else {
+            owned = owned == 0 ? 1 : 0;
+            out = mBuffers[owned];
+        }
+
+        current = stage->process(current, out, frames);
+
+        // a stage may hand back its input or its own memory
+        if (current != mBuffers[0] && current != mBuffers[1]) {
+            owned = -1;
+        } else {
+            owned = current == mBuffers[0] ? 0 : 1;
+        }
+    }
+
+    return current;
+}
+
+void Pipeline::run(const float* in, float* out, std::size_t frames)
+{
+    const float* result = run(in, frames);
+    if (result != out) {
+        RTNR_TRACE_SCOPE("copy_out");
+        mKernels.copy(result, out, frames);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../DSP/Kernels.h"
+#include "../Util/Arena.h"
+#include "Stage.h"
+
+/// @brief The Pipeline class runs an ordered list of stages over blocks of
+/// audio. It is built once for a block size: the stage requirements are
+/// checked and a single arena is sized for the two ping-pong buffers and the
+/// scratch memory of every stage. Stages that work in place reuse the buffer
+/// holding their input, stages that return their input or their own memory
+/// cost no copy at all, and per-block scratch is released by rewinding the
+/// arena after each run. The same pipeline type drives the live stream and
+/// the offline file processing.
+class Pipeline
+{
+  private:
+    /// @brief The stages in processing order.
+    std::vector<std::unique_ptr<Stage>> mStages;
+    /// @brief Maximum number of frames per run.
+    std::size_t mBlockSize;
+    /// @brief Arena holding the ping-pong buffers and all stage scratch.
+    Arena mArena;
+    /// @brief The ping-pong buffers inside the arena.
+    float* mBuffers[2];
+    /// @brief Kernels selected for the block size.
+    KernelTable mKernels;
+
+  public:
+    /// @brief Constructor for the Pipeline class.
+    Pipeline();
+
+    /// @brief Appends a stage. Must be called before build.
+    /// @tparam StageType The stage class.
+    /// @param args The stage constructor arguments.
+    /// @return Reference to the new stage.
+    template <typename StageType, typename... Args>
+    StageType& add(Args&&... args);
+
+    /// @brief Removes all stages and buffers.
+    void clear();
+
+    /// @brief Checks the stage block sizes, sizes the arena and allocates the
+    /// buffers.
+    /// @param blockSize The maximum number of frames per run.
+    /// @param extraBytes Arena space reserved for the owner of the pipeline,
+    /// to be allocated right after the build. Defaults to 0.
+    /// @throws std::invalid_argument If a stage needs another block size.
+    void build(std::size_t blockSize, std::size_t extraBytes = 0);
+
+    /// @brief Resets the state of all stages.
+    void reset();
+
+    /// @brief Returns the maximum number of frames per run.
+    /// @return The block size.
+    std::size_t blockSize() const;
+
+    /// @brief Returns the sum of the stage latencies.
+    /// @return The latency in frames.
+    std::size_t latency() const;
+
+    /// @brief Touches the arena so the first run does not page fault.
+    /// @return Number of bytes touched.
+    std::size_t prefault();
+
+    /// @brief Returns the arena the pipeline memory comes from.
+    /// @return Reference to the arena.
+    Arena& arena();
+
+    /// @brief Returns the arena the pipeline memory comes from.
+    /// @return Const reference to the arena.
+    const Arena& arena() const;
+
+    /// @brief Returns the number of stages.
+    /// @return The stage count.
+    std::size_t size() const;
+
+    /// @brief Runs all stages over one block.
+    /// @param in Pointer to the input frames, never written.
+    /// @param frames Number of frames, at most the block size.
+    /// @return Pointer to the processed frames, valid until the next run.
+    const float* run(const float* in, std::size_t frames);
+
+    /// @brief Runs all stages over one block and stores the result.
+    /// @param in Pointer to the input frames, never written.
+    /// @param out Pointer to the output frames.
+    /// @param frames Number of frames, at most the block size.
+    void run(const float* in, float* out, std::size_t frames);
+};
+
+template <typename StageType, typename... Args>
+StageType& Pipeline::add(Args&&... args)
+{
+    auto stage = std::make_unique<StageType>(std::forward<Args>(args)...);
+    StageType& reference = *stage;
+    mStages.push_back(std::move(stage));
+    return reference;
+}
+
+#endif // PIPELINE_H
@@ -0,0 +1,75 @@
+#ifndef STAGE_H
+#define STAGE_H
+
+#include <cstddef>
+
+#include "../Util/Arena.h"
+
+/// @brief Base class of one processing stage in a Pipeline. A stage declares
+/// the block size it needs, the latency it adds, whether it can work in place
+/// and how much arena memory it takes, so the pipeline can plan its buffers
+/// once when it is built and never copy or allocate while running.
+class Stage
+{
+  public:
+    virtual ~Stage() = default;
+
+    /// @brief Returns the stage name used in reports and traces.
+    /// @return The stage name.
+    virtual const char* name() const = 0;
+
+    /// @brief Returns the exact number of frames the stage needs per call.
+    /// @return The block size, or 0 if the stage accepts any size.
+    virtual std::size_t blockSize() const { return 0; }
+
+    /// @brief Returns the delay the stage adds to the signal.
+    /// @return The latency in frames.
+    virtual std::size_t latency() const { return 0; }
+
+    /// @brief Returns whether the output may be written over the input.
+    /// @return True if the stage can process in place.
+    virtual bool inPlace() const { return true; }
+
+    /// @brief Returns the arena memory the stage takes for blocks of up to
+    /// the given size: everything it allocates in prepare plus the most it
+    /// allocates during one call to process.
+    /// @param maxFrames The maximum number of frames per call.
+    /// @return The size in bytes, as summed with Arena::bytesFor.
+    virtual std::size_t arenaBytes(std::size_t maxFrames) const
+    {
+        (void)maxFrames;
+        return 0;
+    }
+
+    /// @brief Allocates everything the stage needs for blocks of up to the
+    /// given size. Called once when the pipeline is built.
+    /// @param maxFrames The maximum number of frames per call.
+    /// @param arena The pipeline arena. Memory allocated here lives until the
+    /// next build; memory allocated during process is freed after the run.
+    virtual void prepare(std::size_t maxFrames, Arena& arena)
+    {
+        (void)maxFrames;
+        (void)arena;
+    }
+
+    /// @brief Clears the stage state before a new stream or file.
+    virtual void reset() {}
+
+    /// @brief Drops what the stage holds from before a stretch of blocks it
+    /// was skipped for, so its output continues from the current input.
+    /// Called on the audio thread before the stage runs again.
+    virtual void resume() {}
+
+    /// @brief Processes one block.
+    /// @param in Pointer to the input frames.
+    /// @param out Pointer to a buffer the stage may write its output to. It
+    /// equals the input for in-place calls.
+    /// @param frames Number of frames.
+    /// @return Pointer to the processed frames. This is usually the output
+    /// buffer, but a stage may return its input or memory it owns to avoid a
+    /// copy; the pointer stays valid until the next call.
+    virtual const float* process(const float* in, float* out,
+                                 std::size_t frames) = 0;
+};
+
+#endif // STAGE_H
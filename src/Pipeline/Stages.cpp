@@ -0,0 +1,236 @@
+#include "Stages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "../Stream/DegradationGovernor.h"
+
+const char* PassThroughStage::name() const
+{
+    return "pass_through";
+}
+
+const float* PassThroughStage::process(const float* in, float* out,
+                                       std::size_t frames)
+{
+    (void)out;
+    (void)frames;
+    return in;
+}
+
+GateStage::GateStage(NoiseGate& gate) :
+    mGate(gate), mKernels(selectKernels(0))
+{}
+
+const char* GateStage::name() const
+{
+    return "gate";
+}
+
+void GateStage::prepare(std::size_t maxFrames, Arena& arena)
+{
+    (void)arena;
+    mKernels = selectKernels(maxFrames);
+}
+
+const float* GateStage::process(const float* in, float* out,
+                                std::size_t frames)
+{
+    mKernels.gate(in, out, mGate.getLinearThreshold(), frames);
+    return out;
+}
+
+KalmanStage::KalmanStage(double Q, double R) : mQ(Q), mR(R), mFilter(Q, R)
+{}
+
+const char* KalmanStage::name() const
+{
+    return "kalman";
+}
+
+void KalmanStage::reset()
+{
+    mFilter = Kalman(mQ, mR);
+}
+
+const float* KalmanStage::process(const float* in, float* out,
+                                  std::size_t frames)
+{
+    for (std::size_t i = 0; i < frames; ++i) {
+        out[i] = static_cast<float>(mFilter.update(in[i]));
+    }
+    return out;
+}
+
+AdaptiveKalmanStage::AdaptiveKalmanStage(float x, float P, float Q, float R,
+                                         float alpha) :
+    mInitial(x, P, Q, R, alpha), mFilter(mInitial)
+{}
+
+const char* AdaptiveKalmanStage::name() const
+{
+    return "adaptive_kalman";
+}
+
+void AdaptiveKalmanStage::reset()
+{
+    mFilter = mInitial;
+}
+
+const float* AdaptiveKalmanStage::process(const float* in, float* out,
+                                          std::size_t frames)
+{
+    for (std::size_t i = 0; i < frames; ++i) {
+        out[i] = mFilter.update(in[i]);
+    }
+    return out;
+}
+
+SpectralStage::SpectralStage(int sampleRate) : mDenoiser(sampleRate)
+{}
+
+const char* SpectralStage::name() const
+{
+    return "spectral";
+}
+
+std::size_t SpectralStage::latency() const
+{
+    return mDenoiser.latency();
+}
+
+void SpectralStage::reset()
+{
+    mDenoiser.reset();
+}
+
+const float* SpectralStage::process(const float* in, float* out,
+                                    std::size_t frames)
+{
+    mDenoiser.process(in, out, frames);
+    return out;
+}
+
+SpectralKalmanStage::SpectralKalmanStage(int sampleRate) :
+    mFilter(sampleRate)
+{}
+
+const char* SpectralKalmanStage::name() const
+{
+    return "spectral_kalman";
+}
+
+std::size_t SpectralKalmanStage::latency() const
+{
+    return mFilter.latency();
+}
+
+void SpectralKalmanStage::reset()
+{
+    mFilter.reset();
+}
+
+const float* SpectralKalmanStage::process(const float* in, float* out,
+                                          std::size_t frames)
+{
+    mFilter.process(in, out, frames);
+    return out;
+}
+
+ModelStage::ModelStage(ModelSwitcher& models, std::size_t blockLen) :
+    mModels(models), mBlockLen(blockLen),
+    mLatency(models.active()->latencyBlocks() * blockLen), mArena(nullptr),
+    mLastSample(0), mPrevious(nullptr), mPrimeBlocks(0)
+{}
+
+ModelStage::~ModelStage()
+{
+    if (mPrevious != nullptr) {
+        mModels.retire(mPrevious, 0);
+    }
+}
+
+const char* ModelStage::name() const
+{
+    return "model";
+}
+
+std::size_t ModelStage::blockSize() const
+{
+    return mBlockLen;
+}
+
+std::size_t ModelStage::latency() const
+{
+    return mLatency;
+}
+
+bool ModelStage::inPlace() const
+{
+    // the result lives in model memory, the buffer is only written by a swap
+    // crossfade after both models have read the input
+    return true;
+}
+
+void ModelStage::reset()
+{
+    mLastSample = 0;
+}
+
+void ModelStage::resume()
+{
+    mModels.active()->resetState();
+    if (mPrevious != nullptr) {
+        mPrevious->resetState();
+    }
+}
+
+std::size_t ModelStage::arenaBytes(std::size_t maxFrames) const
+{
+    return Arena::bytesFor<float>(maxFrames);
+}
+
+void ModelStage::prepare(std::size_t maxFrames, Arena& arena)
+{
+    (void)maxFrames;
+    mArena = &arena;
+}
+
+const float* ModelStage::process(const float* in, float* out,
+                                 std::size_t frames)
+{
+    // models wrap aligned blocks in place, copy others once into the arena
+    const float* input = in;
+    if (reinterpret_cast<std::uintptr_t>(in) % Arena::kAlignment != 0) {
+        float* copy = mArena->allocate<float>(frames);
+        std::copy(in, in + frames, copy);
+        input = copy;
+    }
+
+    // a new swap is only published after the last one was retired
+    InferenceModel* previous = mModels.adoptPending();
+    if (previous != nullptr) {
+        mPrevious = previous;
+        mPrimeBlocks = mModels.active()->latencyBlocks();
+    }
+    const float* result = mModels.active()->infer(input, frames);
+
+    if (mPrevious != nullptr) {
+        const float* faded = mPrevious->infer(input, frames);
+        if (mPrimeBlocks > 0) {
+            // keep the replaced model until the new one's output catches up
+            --mPrimeBlocks;
+            result = faded;
+        } else {
+            // fade from the replaced model over this block, then hand it back
+            DegradationGovernor::crossfade(faded, result, out, frames);
+            mModels.retire(mPrevious, std::fabs(out[0] - mLastSample));
+            mPrevious = nullptr;
+            result = out;
+        }
+    }
+
+    mLastSample = result[frames - 1];
+    return result;
+}
@@ -0,0 +1,192 @@
+#ifndef STAGES_H
+#define STAGES_H
+
+#include <memory>
+#include <string>
+
+#include "../DSP/Kernels.h"
+#include "../Filters/AdaptiveKalman.h"
+#include "../Filters/Kalman.h"
+#include "../Filters/NoiseGate.h"
+#include "../Filters/SpectralDenoiser.h"
+#include "../Filters/SpectralKalman.h"
+#include "../Inference/ModelSwitcher.h"
+#include "Stage.h"
+
+/// @brief Stage that returns its input untouched, without a copy.
+class PassThroughStage : public Stage
+{
+  public:
+    const char* name() const override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+/// @brief Stage adapting a NoiseGate. The gate is shared, so its threshold
+/// can be changed while the pipeline runs.
+class GateStage : public Stage
+{
+  private:
+    /// @brief The shared noise gate.
+    NoiseGate& mGate;
+    /// @brief Kernels selected for the pipeline block size.
+    KernelTable mKernels;
+
+  public:
+    /// @brief Constructor for the GateStage class.
+    /// @param gate The noise gate to apply.
+    GateStage(NoiseGate& gate);
+
+    const char* name() const override;
+    void prepare(std::size_t maxFrames, Arena& arena) override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+/// @brief Stage adapting the per-sample Kalman filter.
+class KalmanStage : public Stage
+{
+  private:
+    /// @brief Process noise covariance.
+    double mQ;
+    /// @brief Measurement noise covariance.
+    double mR;
+    /// @brief The filter.
+    Kalman mFilter;
+
+  public:
+    /// @brief Constructor for the KalmanStage class.
+    /// @param Q Process noise covariance.
+    /// @param R Measurement noise covariance.
+    KalmanStage(double Q = 0.01, double R = 0.1);
+
+    const char* name() const override;
+    void reset() override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+/// @brief Stage adapting the per-sample adaptive Kalman filter.
+class AdaptiveKalmanStage : public Stage
+{
+  private:
+    /// @brief The filter as constructed, restored on reset.
+    AdaptiveKalmanFilter mInitial;
+    /// @brief The filter.
+    AdaptiveKalmanFilter mFilter;
+
+  public:
+    /// @brief Constructor for the AdaptiveKalmanStage class.
+    /// @param x Initial state estimate.
+    /// @param P Initial error covariance estimate.
+    /// @param Q Process noise covariance.
+    /// @param R Measurement noise covariance.
+    /// @param alpha Forgetting factor for adaptive estimation.
+    AdaptiveKalmanStage(float x = 0, float P = 1, float Q = 0.01,
+                        float R = 0.1, float alpha = 0.95);
+
+    const char* name() const override;
+    void reset() override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+/// @brief Stage adapting the spectral Wiener filter. It takes blocks of any
+/// size and delays the signal by one filter frame.
+class SpectralStage : public Stage
+{
+  private:
+    /// @brief The filter.
+    SpectralDenoiser mDenoiser;
+
+  public:
+    /// @brief Constructor for the SpectralStage class.
+    /// @param sampleRate Sample rate. Defaults to 48000.
+    SpectralStage(int sampleRate = 48000);
+
+    const char* name() const override;
+    std::size_t latency() const override;
+    void reset() override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+/// @brief Where an optional stage runs relative to the model.
+enum class StagePlacement
+{
+    /// @brief The stage is not used.
+    Off = 0,
+    /// @brief The stage cleans the input of the model.
+    BeforeModel = 1,
+    /// @brief The stage cleans the output of the model.
+    AfterModel = 2
+};
+
+/// @brief Stage adapting the per-bin Kalman filter. It takes blocks of any
+/// size and delays the signal by one filter frame.
+class SpectralKalmanStage : public Stage
+{
+  private:
+    /// @brief The filter.
+    SpectralKalman mFilter;
+
+  public:
+    /// @brief Constructor for the SpectralKalmanStage class.
+    /// @param sampleRate Sample rate. Defaults to 48000.
+    SpectralKalmanStage(int sampleRate = 48000);
+
+    const char* name() const override;
+    std::size_t latency() const override;
+    void reset() override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+/// @brief Stage running one block through the active model of a
+/// ModelSwitcher. The model gets the block where it lies whenever it is
+/// aligned, otherwise the block is copied once into arena scratch, and its
+/// output is returned without a copy. A model published by the switcher is
+/// adopted at the start of a block and crossfaded in over that block.
+class ModelStage : public Stage
+{
+  private:
+    /// @brief The model owner, shared with the caller.
+    ModelSwitcher& mModels;
+    /// @brief Number of frames in one model block.
+    std::size_t mBlockLen;
+    /// @brief Latency of the model in frames, taken on construction so
+    /// other threads never touch the active model.
+    std::size_t mLatency;
+    /// @brief Arena for the input copy of unaligned blocks.
+    Arena* mArena;
+    /// @brief Last output sample, used to measure the swap boundary step.
+    float mLastSample;
+    /// @brief Replaced model still producing the output while the new one
+    /// fills its latency, null outside of a swap.
+    InferenceModel* mPrevious;
+    /// @brief Blocks the new model still needs before the fade.
+    std::size_t mPrimeBlocks;
+
+  public:
+    /// @brief Constructor for the ModelStage class.
+    /// @param models The switcher holding the model.
+    /// @param blockLen Number of frames in one model block.
+    ModelStage(ModelSwitcher& models, std::size_t blockLen);
+    /// @brief Destructor, hands back a model left from an unfinished swap.
+    ~ModelStage() override;
+
+    const char* name() const override;
+    std::size_t blockSize() const override;
+    std::size_t latency() const override;
+    bool inPlace() const override;
+    void reset() override;
+    /// @brief Resets the model state, the blocks in flight of a model with
+    /// latency are from before the gap and are dropped.
+    void resume() override;
+    std::size_t arenaBytes(std::size_t maxFrames) const override;
+    void prepare(std::size_t maxFrames, Arena& arena) override;
+    const float* process(const float* in, float* out,
+                         std::size_t frames) override;
+};
+
+#endif // STAGES_H
@@ -0,0 +1,271 @@
+#include "AudioRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "../Util/Log.h"
+#include "../Util/Trace.h"
+
+namespace
+{
+/// @brief Interval between two passes of the writer.
+constexpr std::chrono::milliseconds kWriteInterval(100);
+/// @brief Channels of the recording, the input and the output.
+constexpr int kChannels = 2;
+/// @brief Bytes of one stereo float frame on disk.
+constexpr std::uint64_t kFrameBytes = kChannels * sizeof(float);
+
+/// @brief Returns the name of a rotated file.
+/// @param path The configured path.
+/// @param index Index of the file.
+/// @return The path with the index before the extension.
+std::string rotatedPath(const std::string& path, std::size_t index)
+{
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%04zu", index);
+
+    std::size_t dot = path.find_last_of('.');
+    std::size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash)) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+} // namespace
+
+AudioRecorder::AudioRecorder() :
+    mSampleRate(0), mBlockFrames(0), mMask(0), mHead(0), mTail(0),
+    mEnabled(false), mPushing(false), mDropped(0), mRecorded(0), mFiles(0),
+    mFile(nullptr), mFileFrames(0), mReportedDrops(0), mStop(false)
+{}
+
+AudioRecorder::~AudioRecorder()
+{
+    stop();
+}
+
+bool AudioRecorder::start(const RecorderOptions& options, int sampleRate,
+                          std::size_t blockFrames)
+{
+    stop();
+
+    mOptions = options;
+    mSampleRate = sampleRate;
+    mBlockFrames = blockFrames;
+
+    // the tap is disabled and idle, so the ring can be replaced
+    auto needed = static_cast<std::size_t>(
+        std::ceil(options.bufferSeconds * sampleRate / blockFrames));
+    std::size_t slots = 2;
+    while (slots < needed) {
+        slots <<= 1;
+    }
+    mSlots.assign(slots * blockFrames * kChannels, 0.0f);
+    mMask = slots - 1;
+    mHead.store(0, std::memory_order_relaxed);
+    mTail.store(0, std::memory_order_relaxed);
+    mDropped.store(0, std::memory_order_relaxed);
+    mRecorded.store(0, std::memory_order_relaxed);
+    mFiles.store(0, std::memory_order_relaxed);
+    mReportedDrops = 0;
+
+    if (!openNextFile()) {
+        return false;
+    }
+
+    mStop = false;
+    mWriter = std::thread(&AudioRecorder::write, this);
+    mEnabled.store(true);
+    Log::write(LogLevel::Info, "Recording to %s, %zu blocks buffered",
+               options.path, slots);
+    return true;
+}
+
+void AudioRecorder::stop()
+{
+    if (!mWriter.joinable()) {
+        return;
+    }
+
+    // after this no block enters the ring, the writer drains the rest
+    mEnabled.store(false);
+    while (mPushing.load()) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mWriter.join();
+
+    Log::write(LogLevel::Info,
+               "Recording stopped, %llu blocks written, %llu dropped",
+               mRecorded.load(std::memory_order_relaxed),
+               mDropped.load(std::memory_order_relaxed));
+}
+
+void AudioRecorder::push(const float* input, const float* output,
+                         std::size_t frames)
+{
+    // announce the push before checking the flag, stop checks in reverse
+    mPushing.store(true);
+    if (!mEnabled.load()) {
+        mPushing.store(false, std::memory_order_release);
+        return;
+    }
+
+    std::uint64_t head = mHead.load(std::memory_order_relaxed);
+    if (head - mTail.load(std::memory_order_acquire) > mMask) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        float* slot = &mSlots[(head & mMask) * mBlockFrames * kChannels];
+        frames = std::min(frames, mBlockFrames);
+        for (std::size_t i = 0; i < frames; ++i) {
+            slot[kChannels * i] = input[i];
+            slot[kChannels * i + 1] = output[i];
+        }
+        std::fill(slot + kChannels * frames,
+                  slot + kChannels * mBlockFrames, 0.0f);
+        mHead.store(head + 1, std::memory_order_release);
+    }
+    mPushing.store(false, std::memory_order_release);
+}
+
+RecorderStats AudioRecorder::getStats() const
+{
+    RecorderStats stats;
+    stats.recording = mEnabled.load(std::memory_order_relaxed);
+    stats.recordedBlocks = mRecorded.load(std::memory_order_relaxed);
+    stats.droppedBlocks = mDropped.load(std::memory_order_relaxed);
+    stats.files = mFiles.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioRecorder::write()
+{
+    RTNR_TRACE_THREAD("recorder");
+    bool stopping = false;
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait_for(lock, kWriteInterval, [this]() { return mStop; });
+            stopping = mStop;
+        }
+        drain();
+    }
+
+    if (mFile != nullptr) {
+        sf_close(mFile);
+        mFile = nullptr;
+    }
+}
+
+void AudioRecorder::drain()
+{
+    RTNR_TRACE_SCOPE("recorder_drain");
+    std::uint64_t tail = mTail.load(std::memory_order_relaxed);
+    std::uint64_t head = mHead.load(std::memory_order_acquire);
+    while (tail != head) {
+        // one write per contiguous run of slots, at most two per pass
+        std::size_t slot = tail & mMask;
+        auto run = static_cast<std::size_t>(
+            std::min<std::uint64_t>(head - tail, mMask + 1 - slot));
+        const float* frames = &mSlots[slot * mBlockFrames * kChannels];
+
+        if (mFile != nullptr && writeFrames(frames, run * mBlockFrames)) {
+            mRecorded.fetch_add(run, std::memory_order_relaxed);
+        } else {
+            // keep draining after a disk error, the blocks count as lost
+            mDropped.fetch_add(run, std::memory_order_relaxed);
+        }
+        tail += run;
+        mTail.store(tail, std::memory_order_release);
+    }
+
+    std::uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+    if (dropped != mReportedDrops) {
+        Log::write(LogLevel::Warning,
+                   "%llu recording blocks dropped, the disk fell behind",
+                   dropped - mReportedDrops);
+        mReportedDrops = dropped;
+    }
+}
+
+bool AudioRecorder::writeFrames(const float* frames, std::size_t count)
+{
+    std::uint64_t limit = rotateFrames();
+    while (count > 0) {
+        if (limit > 0 && mFileFrames >= limit && !openNextFile()) {
+            return false;
+        }
+        std::size_t part = count;
+        if (limit > 0) {
+            part = static_cast<std::size_t>(
+                std::min<std::uint64_t>(part, limit - mFileFrames));
+        }
+
+        sf_count_t written;
+        {
+            RTNR_TRACE_SCOPE("file_write");
+            written = sf_writef_float(mFile, frames, part);
+        }
+        if (written != static_cast<sf_count_t>(part)) {
+            Log::write(LogLevel::Error, "Error writing recording: %s",
+                       sf_strerror(mFile));
+            sf_close(mFile);
+            mFile = nullptr;
+            return false;
+        }
+        mFileFrames += part;
+        frames += kChannels * part;
+        count -= part;
+    }
+    return true;
+}
+
+bool AudioRecorder::openNextFile()
+{
+    if (mFile != nullptr) {
+        sf_close(mFile);
+        mFile = nullptr;
+    }
+
+    std::size_t index = mFiles.load(std::memory_order_relaxed);
+    std::string path = rotateFrames() > 0
+                           ? rotatedPath(mOptions.path, index)
+                           : mOptions.path;
+
+    SF_INFO info = {};
+    info.samplerate = mSampleRate;
+    info.channels = kChannels;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    mFile = sf_open(path.c_str(), SFM_WRITE, &info);
+    if (mFile == nullptr) {
+        Log::write(LogLevel::Error, "Error opening recording %s: %s", path,
+                   sf_strerror(nullptr));
+        return false;
+    }
+
+    mFileFrames = 0;
+    mFiles.store(index + 1, std::memory_order_relaxed);
+    return true;
+}
+
+std::uint64_t AudioRecorder::rotateFrames() const
+{
+    std::uint64_t limit = 0;
+    if (mOptions.rotateSeconds > 0) {
+        limit = static_cast<std::uint64_t>(mOptions.rotateSeconds *
+                                           mSampleRate);
+    }
+    if (mOptions.rotateBytes > 0) {
+        std::uint64_t bySize = mOptions.rotateBytes / kFrameBytes;
+        limit = limit > 0 ? std::min(limit, bySize) : bySize;
+    }
+    // never rotate inside the first block of a file
+    return limit > 0 ? std::max<std::uint64_t>(limit, mBlockFrames) : 0;
+}
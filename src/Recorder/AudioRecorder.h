@@ -0,0 +1,147 @@
+#ifndef AUDIO_RECORDER_H
+#define AUDIO_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sndfile.h"
+
+/// @brief Settings of a recording.
+struct RecorderOptions
+{
+    /// @brief Output file. With rotation a four digit index is inserted
+    /// before the extension, "take.wav" becomes "take_0000.wav".
+    std::string path;
+    /// @brief Length after which a new file is started, 0 for no limit.
+    double rotateSeconds = 0;
+    /// @brief Size after which a new file is started, 0 for no limit.
+    std::uint64_t rotateBytes = 0;
+    /// @brief Audio the tap buffers while the disk is slow. Blocks that
+    /// find the buffer full are dropped and counted.
+    double bufferSeconds = 4;
+};
+
+/// @brief Snapshot of the recorder counters.
+struct RecorderStats
+{
+    /// @brief Flag to indicate that a recording runs.
+    bool recording = false;
+    /// @brief Number of blocks written to disk.
+    std::uint64_t recordedBlocks = 0;
+    /// @brief Number of blocks dropped because the buffer was full.
+    std::uint64_t droppedBlocks = 0;
+    /// @brief Number of files started, more than one with rotation.
+    std::size_t files = 0;
+};
+
+/// @brief Recording tap for the audio thread. Each block of raw input and
+/// processed output is copied into a preallocated ring as one stereo frame
+/// run, left the input and right the output. A writer thread drains the
+/// ring in large sequential writes through libsndfile and rotates the files
+/// by length or size. The tap never blocks or allocates; when the disk falls
+/// behind the ring fills up and further blocks are dropped and counted.
+class AudioRecorder
+{
+  private:
+    /// @brief Sample rate of the stream.
+    int mSampleRate;
+    /// @brief Number of frames in one block.
+    std::size_t mBlockFrames;
+    /// @brief Settings of the running recording.
+    RecorderOptions mOptions;
+
+    /// @brief Interleaved stereo frames of the ring slots.
+    std::vector<float> mSlots;
+    /// @brief Number of slots minus one, used to wrap the indices.
+    std::size_t mMask;
+    /// @brief Number of blocks pushed, written by the tap only.
+    alignas(64) std::atomic<std::uint64_t> mHead;
+    /// @brief Number of blocks drained, written by the writer only.
+    alignas(64) std::atomic<std::uint64_t> mTail;
+
+    /// @brief Flag to indicate that the tap accepts blocks.
+    std::atomic<bool> mEnabled;
+    /// @brief Flag set by the tap while it writes into the ring, so stop
+    /// can wait for a block in flight.
+    std::atomic<bool> mPushing;
+    /// @brief Number of blocks dropped in this recording.
+    std::atomic<std::uint64_t> mDropped;
+    /// @brief Number of blocks written in this recording.
+    std::atomic<std::uint64_t> mRecorded;
+    /// @brief Number of files started in this recording.
+    std::atomic<std::size_t> mFiles;
+
+    /// @brief The current file, written by the writer thread only.
+    SNDFILE* mFile;
+    /// @brief Frames in the current file.
+    std::uint64_t mFileFrames;
+    /// @brief Drop count the writer last reported.
+    std::uint64_t mReportedDrops;
+
+    /// @brief Thread that drains the ring.
+    std::thread mWriter;
+    /// @brief Guards mStop for the writer wake-up.
+    std::mutex mMutex;
+    /// @brief Wakes the writer early on stop.
+    std::condition_variable mWake;
+    /// @brief Flag to tell the writer to drain and finish.
+    bool mStop;
+
+    /// @brief Body of the writer thread.
+    void write();
+    /// @brief Writes every queued block to disk.
+    void drain();
+    /// @brief Writes frames, rotating the file where a limit is reached.
+    /// @param frames Interleaved stereo frames.
+    /// @param count Number of frames.
+    /// @return False if a file cannot be opened or written.
+    bool writeFrames(const float* frames, std::size_t count);
+    /// @brief Closes the current file and opens the next one.
+    /// @return False if the file cannot be opened.
+    bool openNextFile();
+    /// @brief Returns the number of frames after which a file is rotated.
+    /// @return The frame limit, 0 for no limit.
+    std::uint64_t rotateFrames() const;
+
+  public:
+    /// @brief Constructor for the AudioRecorder class, stopped.
+    AudioRecorder();
+    /// @brief Destructor for the AudioRecorder class, stops a recording.
+    ~AudioRecorder();
+
+    AudioRecorder(const AudioRecorder&) = delete;
+    AudioRecorder& operator=(const AudioRecorder&) = delete;
+
+    /// @brief Opens the first file, sizes the ring and enables the tap.
+    /// Stops a running recording first. Not real-time safe.
+    /// @param options Settings of the recording.
+    /// @param sampleRate Sample rate of the blocks.
+    /// @param blockFrames Number of frames in one block.
+    /// @return False if the first file cannot be opened.
+    bool start(const RecorderOptions& options, int sampleRate,
+               std::size_t blockFrames);
+
+    /// @brief Disables the tap, writes the buffered blocks and closes the
+    /// file. Not real-time safe.
+    void stop();
+
+    /// @brief Queues one block of input and output. Lock-free and
+    /// allocation-free, safe on the audio thread. Does nothing while
+    /// stopped.
+    /// @param input Raw input frames.
+    /// @param output Processed output frames.
+    /// @param frames Number of frames, at most the block size.
+    void push(const float* input, const float* output, std::size_t frames);
+
+    /// @brief Returns the recorder counters.
+    /// @return Snapshot of the counters.
+    RecorderStats getStats() const;
+};
+
+#endif // AUDIO_RECORDER_H
@@ -0,0 +1,105 @@
+#ifndef SHARED_AUDIO_LAYOUT_H
+#define SHARED_AUDIO_LAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Value of SharedAudioHeader::magic once the writer has set up the
+/// memory, "RTNR" in ASCII.
+constexpr std::uint32_t kSharedAudioMagic = 0x524e5452;
+/// @brief Version of the layout, bumped on every incompatible change.
+constexpr std::uint32_t kSharedAudioVersion = 1;
+/// @brief Number of readers that can report their position at once.
+constexpr std::size_t kSharedAudioMaxReaders = 8;
+/// @brief Alignment of the header parts and the slots, one cache line.
+constexpr std::size_t kSharedAudioAlignment = 64;
+
+/// @brief Position report of one reader, read by the writer for the lag
+/// metric. Readers claim a free entry when they open.
+struct alignas(kSharedAudioAlignment) SharedAudioReaderEntry
+{
+    /// @brief 1 while a reader holds the entry, 0 otherwise.
+    std::atomic<std::uint32_t> active;
+    /// @brief Sequence number of the next block the reader wants.
+    std::atomic<std::uint64_t> position;
+    /// @brief Number of blocks the reader lost to overruns.
+    std::atomic<std::uint64_t> overruns;
+};
+
+/// @brief Start of the shared memory of a SharedAudioSink. It is followed by
+/// blockCount slots of slotBytes each: a SharedAudioSlot and blockFrames
+/// mono float samples.
+struct SharedAudioHeader
+{
+    /// @brief kSharedAudioMagic, stored last by the writer.
+    std::atomic<std::uint32_t> magic;
+    /// @brief kSharedAudioVersion.
+    std::uint32_t version;
+    /// @brief Sample rate of the blocks.
+    std::uint32_t sampleRate;
+    /// @brief Number of frames in one block.
+    std::uint32_t blockFrames;
+    /// @brief Number of slots, a power of two.
+    std::uint32_t blockCount;
+    /// @brief Distance between two slots in bytes.
+    std::uint32_t slotBytes;
+    /// @brief Number of blocks published so far. Block n lives in slot
+    /// n % blockCount until block n + blockCount overwrites it.
+    alignas(kSharedAudioAlignment) std::atomic<std::uint64_t> published;
+    /// @brief Position reports of the readers.
+    SharedAudioReaderEntry readers[kSharedAudioMaxReaders];
+};
+
+/// @brief Start of one slot. The sequence works as a seqlock: it is odd
+/// while the writer fills the slot and 2n + 2 once block n is complete, so
+/// a reader can tell whether the block it read was overwritten meanwhile.
+struct alignas(kSharedAudioAlignment) SharedAudioSlot
+{
+    /// @brief 2n + 1 while block n is written, 2n + 2 when it is complete.
+    std::atomic<std::uint64_t> sequence;
+};
+
+/// @brief Returns the distance between two slots.
+/// @param blockFrames Number of frames in one block.
+/// @return The slot size in bytes, a multiple of kSharedAudioAlignment.
+constexpr std::size_t sharedAudioSlotBytes(std::size_t blockFrames)
+{
+    return (sizeof(SharedAudioSlot) + blockFrames * sizeof(float) +
+            kSharedAudioAlignment - 1) /
+           kSharedAudioAlignment * kSharedAudioAlignment;
+}
+
+/// @brief Returns the size of the shared memory.
+/// @param blockFrames Number of frames in one block.
+/// @param blockCount Number of slots.
+/// @return The size in bytes.
+constexpr std::size_t sharedAudioBytes(std::size_t blockFrames,
+                                       std::size_t blockCount)
+{
+    return (sizeof(SharedAudioHeader) + kSharedAudioAlignment - 1) /
+               kSharedAudioAlignment * kSharedAudioAlignment +
+           blockCount * sharedAudioSlotBytes(blockFrames);
+}
+
+/// @brief Returns a slot of the shared memory.
+/// @param header Start of the shared memory.
+/// @param index Slot index.
+/// @return Pointer to the slot, the samples follow it.
+inline SharedAudioSlot* sharedAudioSlot(SharedAudioHeader* header,
+                                        std::size_t index)
+{
+    auto* base = reinterpret_cast<unsigned char*>(header) +
+                 sharedAudioBytes(header->blockFrames, 0);
+    return reinterpret_cast<SharedAudioSlot*>(base + index * header->slotBytes);
+}
+
+/// @brief Returns the samples of a slot.
+/// @param slot The slot.
+/// @return Pointer to the block samples.
+inline float* sharedAudioSamples(SharedAudioSlot* slot)
+{
+    return reinterpret_cast<float*>(slot + 1);
+}
+
+#endif // SHARED_AUDIO_LAYOUT_H
@@ -0,0 +1,144 @@
+#include "SharedAudioReader.h"
+
+SharedAudioReader::SharedAudioReader() :
+    mHeader(nullptr), mEntry(nullptr), mNext(0), mAcquired(nullptr),
+    mOverruns(0)
+{}
+
+SharedAudioReader::~SharedAudioReader()
+{
+    close();
+}
+
+bool SharedAudioReader::open(const std::string& name)
+{
+    close();
+    if (!mMemory.open(name) || mMemory.size() < sizeof(SharedAudioHeader)) {
+        mMemory.close();
+        return false;
+    }
+
+    auto* header = static_cast<SharedAudioHeader*>(mMemory.data());
+    if (header->magic.load(std::memory_order_acquire) != kSharedAudioMagic ||
+        header->version != kSharedAudioVersion ||
+        mMemory.size() <
+            sharedAudioBytes(header->blockFrames, header->blockCount)) {
+        mMemory.close();
+        return false;
+    }
+    mHeader = header;
+
+    // report the position through a free entry, reading works without one
+    for (auto& entry : mHeader->readers) {
+        std::uint32_t expected = 0;
+        if (entry.active.compare_exchange_strong(expected, 1)) {
+            mEntry = &entry;
+            break;
+        }
+    }
+
+    mNext = mHeader->published.load(std::memory_order_acquire);
+    mOverruns = 0;
+    if (mEntry != nullptr) {
+        mEntry->position.store(mNext, std::memory_order_relaxed);
+        mEntry->overruns.store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void SharedAudioReader::close()
+{
+    if (mEntry != nullptr) {
+        mEntry->active.store(0, std::memory_order_release);
+        mEntry = nullptr;
+    }
+    mHeader = nullptr;
+    mAcquired = nullptr;
+    mMemory.close();
+}
+
+int SharedAudioReader::sampleRate() const
+{
+    return mHeader != nullptr ? static_cast<int>(mHeader->sampleRate) : 0;
+}
+
+std::size_t SharedAudioReader::blockFrames() const
+{
+    return mHeader != nullptr ? mHeader->blockFrames : 0;
+}
+
+void SharedAudioReader::skipOverrun(std::uint64_t published)
+{
+    // the slot of block published is being written next, keep clear of it
+    std::uint64_t oldest =
+        published >= mHeader->blockCount ? published - mHeader->blockCount + 1
+                                         : 0;
+    if (mNext < oldest) {
+        mOverruns += oldest - mNext;
+        mNext = oldest;
+    }
+}
+
+const float* SharedAudioReader::acquire(std::uint64_t& sequence)
+{
+    if (mHeader == nullptr) {
+        return nullptr;
+    }
+
+    std::uint64_t published =
+        mHeader->published.load(std::memory_order_acquire);
+    while (mNext < published) {
+        skipOverrun(published);
+        SharedAudioSlot* slot =
+            sharedAudioSlot(mHeader, mNext & (mHeader->blockCount - 1));
+        if (slot->sequence.load(std::memory_order_acquire) == 2 * mNext + 2) {
+            mAcquired = slot;
+            sequence = mNext;
+            return sharedAudioSamples(slot);
+        }
+
+        // overwritten between the two loads, catch up with the writer
+        ++mOverruns;
+        ++mNext;
+        published = mHeader->published.load(std::memory_order_acquire);
+    }
+    return nullptr;
+}
+
+bool SharedAudioReader::release()
+{
+    if (mAcquired == nullptr) {
+        return false;
+    }
+
+    // the reads of the samples must complete before the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = mAcquired->sequence.load(std::memory_order_relaxed) ==
+                  2 * mNext + 2;
+    if (!intact) {
+        ++mOverruns;
+    }
+    mAcquired = nullptr;
+    ++mNext;
+
+    if (mEntry != nullptr) {
+        mEntry->position.store(mNext, std::memory_order_relaxed);
+        mEntry->overruns.store(mOverruns, std::memory_order_relaxed);
+    }
+    return intact;
+}
+
+std::uint64_t SharedAudioReader::lag() const
+{
+    if (mHeader == nullptr) {
+        return 0;
+    }
+    std::uint64_t published =
+        mHeader->published.load(std::memory_order_acquire);
+    return published > mNext ? published - mNext : 0;
+}
+
+std::uint64_t SharedAudioReader::overruns() const
+{
+    return mOverruns;
+}
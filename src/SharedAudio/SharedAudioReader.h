@@ -0,0 +1,84 @@
+#ifndef SHARED_AUDIO_READER_H
+#define SHARED_AUDIO_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "SharedAudioLayout.h"
+#include "SharedMemory.h"
+
+/// @brief Reader of the blocks published by a SharedAudioSink in another
+/// process. Blocks are read in place in the shared memory: acquire returns a
+/// pointer into the ring and release tells whether the writer overwrote the
+/// block while it was used. Only depends on the standard library and the
+/// operating system, so consumers can link it on its own.
+class SharedAudioReader
+{
+  private:
+    /// @brief The mapped memory.
+    SharedMemory mMemory;
+    /// @brief Start of the mapped memory, null while closed.
+    SharedAudioHeader* mHeader;
+    /// @brief Position entry claimed in the header, null if all were taken.
+    SharedAudioReaderEntry* mEntry;
+    /// @brief Sequence number of the next block to read.
+    std::uint64_t mNext;
+    /// @brief Slot of the acquired block, null if none is acquired.
+    SharedAudioSlot* mAcquired;
+    /// @brief Number of blocks lost to overruns.
+    std::uint64_t mOverruns;
+
+    /// @brief Skips the blocks the writer may have overwritten.
+    /// @param published Number of published blocks.
+    void skipOverrun(std::uint64_t published);
+
+  public:
+    /// @brief Constructor for the SharedAudioReader class, closed.
+    SharedAudioReader();
+    /// @brief Destructor, releases the position entry.
+    ~SharedAudioReader();
+
+    SharedAudioReader(const SharedAudioReader&) = delete;
+    SharedAudioReader& operator=(const SharedAudioReader&) = delete;
+
+    /// @brief Maps the memory of a sink and starts at its newest block.
+    /// @param name Name the sink was opened with.
+    /// @return False if there is no sink under the name or its layout is
+    /// incompatible.
+    bool open(const std::string& name);
+
+    /// @brief Unmaps the memory and frees the position entry.
+    void close();
+
+    /// @brief Returns the sample rate of the blocks.
+    /// @return The sample rate, 0 while closed.
+    int sampleRate() const;
+
+    /// @brief Returns the number of frames in one block.
+    /// @return The block size, 0 while closed.
+    std::size_t blockFrames() const;
+
+    /// @brief Returns the next block in place.
+    /// @param sequence Receives the sequence number of the block. Gaps in the
+    /// numbers are overruns.
+    /// @return Pointer to the block in shared memory, null if no new block
+    /// was published. It stays valid until release.
+    const float* acquire(std::uint64_t& sequence);
+
+    /// @brief Finishes reading the acquired block.
+    /// @return False if the writer overwrote the block meanwhile; anything
+    /// read from it must be discarded and it counts as an overrun.
+    bool release();
+
+    /// @brief Returns how many published blocks were not read yet.
+    /// @return The lag in blocks.
+    std::uint64_t lag() const;
+
+    /// @brief Returns the number of blocks lost because the reader fell more
+    /// than the ring behind.
+    /// @return The overrun count.
+    std::uint64_t overruns() const;
+};
+
+#endif // SHARED_AUDIO_READER_H
@@ -0,0 +1,95 @@
+#include "SharedAudioSink.h"
+
+#include <algorithm>
+#include <new>
+
+SharedAudioSink::SharedAudioSink() : mHeader(nullptr), mNext(0) {}
+
+bool SharedAudioSink::open(const std::string& name, int sampleRate,
+                           std::size_t blockFrames, std::size_t blockCount)
+{
+    close();
+
+    std::size_t slots = 1;
+    while (slots < blockCount) {
+        slots <<= 1;
+    }
+    if (!mMemory.create(name, sharedAudioBytes(blockFrames, slots))) {
+        return false;
+    }
+
+    // the memory is zeroed: no block, no reader, no magic yet
+    mHeader = new (mMemory.data()) SharedAudioHeader();
+    mHeader->version = kSharedAudioVersion;
+    mHeader->sampleRate = static_cast<std::uint32_t>(sampleRate);
+    mHeader->blockFrames = static_cast<std::uint32_t>(blockFrames);
+    mHeader->blockCount = static_cast<std::uint32_t>(slots);
+    mHeader->slotBytes =
+        static_cast<std::uint32_t>(sharedAudioSlotBytes(blockFrames));
+    for (std::size_t i = 0; i < slots; ++i) {
+        new (sharedAudioSlot(mHeader, i)) SharedAudioSlot();
+    }
+    mNext = 0;
+    mHeader->magic.store(kSharedAudioMagic, std::memory_order_release);
+    return true;
+}
+
+void SharedAudioSink::close()
+{
+    if (mHeader != nullptr) {
+        mHeader->magic.store(0, std::memory_order_release);
+    }
+    mHeader = nullptr;
+    mMemory.close();
+}
+
+bool SharedAudioSink::isOpen() const
+{
+    return mHeader != nullptr;
+}
+
+void SharedAudioSink::publish(const float* block, std::size_t frames)
+{
+    std::size_t blockFrames = mHeader->blockFrames;
+    frames = std::min(frames, blockFrames);
+
+    SharedAudioSlot* slot =
+        sharedAudioSlot(mHeader, mNext & (mHeader->blockCount - 1));
+    float* samples = sharedAudioSamples(slot);
+
+    // odd while writing, so readers of the block it replaces notice
+    slot->sequence.store(2 * mNext + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::copy(block, block + frames, samples);
+    std::fill(samples + frames, samples + blockFrames, 0.0f);
+    slot->sequence.store(2 * mNext + 2, std::memory_order_release);
+
+    ++mNext;
+    mHeader->published.store(mNext, std::memory_order_release);
+}
+
+SharedSinkStats SharedAudioSink::getStats() const
+{
+    SharedSinkStats stats;
+    if (mHeader == nullptr) {
+        return stats;
+    }
+
+    stats.open = true;
+    stats.published = mHeader->published.load(std::memory_order_acquire);
+    for (const auto& reader : mHeader->readers) {
+        if (reader.active.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+        std::uint64_t position =
+            reader.position.load(std::memory_order_relaxed);
+        ++stats.readers;
+        if (position < stats.published) {
+            stats.maxReaderLag =
+                std::max(stats.maxReaderLag, stats.published - position);
+        }
+        stats.readerOverruns +=
+            reader.overruns.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,75 @@
+#ifndef SHARED_AUDIO_SINK_H
+#define SHARED_AUDIO_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "SharedAudioLayout.h"
+#include "SharedMemory.h"
+
+/// @brief Snapshot of the shared audio sink counters.
+struct SharedSinkStats
+{
+    /// @brief Flag to indicate that the sink is open.
+    bool open = false;
+    /// @brief Number of published blocks.
+    std::uint64_t published = 0;
+    /// @brief Number of readers reporting their position.
+    std::size_t readers = 0;
+    /// @brief Blocks the slowest reader is behind the writer.
+    std::uint64_t maxReaderLag = 0;
+    /// @brief Blocks lost to overruns over all current readers.
+    std::uint64_t readerOverruns = 0;
+};
+
+/// @brief Output sink publishing processed blocks into a lock-free ring in
+/// shared memory, so that other local processes read them in place through
+/// SharedAudioReader instead of a loopback device. There is one writer and
+/// any number of readers; the writer never waits for them. A reader that
+/// falls more than the ring behind skips ahead and counts an overrun.
+class SharedAudioSink
+{
+  private:
+    /// @brief The mapped memory.
+    SharedMemory mMemory;
+    /// @brief Start of the mapped memory, null while closed.
+    SharedAudioHeader* mHeader;
+    /// @brief Sequence number of the next block.
+    std::uint64_t mNext;
+
+  public:
+    /// @brief Constructor for the SharedAudioSink class, closed.
+    SharedAudioSink();
+
+    /// @brief Creates the shared memory and starts a new sequence.
+    /// @param name Name the readers open.
+    /// @param sampleRate Sample rate of the blocks.
+    /// @param blockFrames Number of frames in one block.
+    /// @param blockCount Minimum number of blocks the ring holds, rounded up
+    /// to a power of two.
+    /// @return False if the memory cannot be created.
+    bool open(const std::string& name, int sampleRate, std::size_t blockFrames,
+              std::size_t blockCount);
+
+    /// @brief Removes the shared memory. Readers keep their mapping but see
+    /// no new blocks.
+    void close();
+
+    /// @brief Returns whether the sink is open.
+    /// @return True if open.
+    bool isOpen() const;
+
+    /// @brief Publishes one block. Lock-free and allocation-free, safe on
+    /// the audio thread.
+    /// @param block Pointer to the frames.
+    /// @param frames Number of frames, at most the block size. Shorter blocks
+    /// are padded with silence.
+    void publish(const float* block, std::size_t frames);
+
+    /// @brief Returns the sink counters, including the reader lag.
+    /// @return Snapshot of the counters.
+    SharedSinkStats getStats() const;
+};
+
+#endif // SHARED_AUDIO_SINK_H
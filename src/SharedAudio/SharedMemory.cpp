@@ -0,0 +1,159 @@
+#include "SharedMemory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+/// @brief Returns the platform name of shared memory.
+std::string platformName(const std::string& name)
+{
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+#endif
+}
+} // namespace
+
+SharedMemory::SharedMemory() :
+    mData(nullptr), mSize(0), mOwner(false)
+#ifdef _WIN32
+    ,
+    mHandle(nullptr)
+#endif
+{}
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+bool SharedMemory::create(const std::string& name, std::size_t size)
+{
+    close();
+    mName = platformName(name);
+
+#ifdef _WIN32
+    auto bytes = static_cast<unsigned long long>(size);
+    mHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                 static_cast<DWORD>(bytes >> 32),
+                                 static_cast<DWORD>(bytes), mName.c_str());
+    if (mHandle == nullptr) {
+        return false;
+    }
+    mData = MapViewOfFile(mHandle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (mData == nullptr) {
+        CloseHandle(mHandle);
+        mHandle = nullptr;
+        return false;
+    }
+    ZeroMemory(mData, size);
+#else
+    // a crashed writer leaves its memory behind, start from scratch
+    shm_unlink(mName.c_str());
+    int fd = shm_open(mName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        shm_unlink(mName.c_str());
+        return false;
+    }
+    // new memory reads as zeros
+    mData = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mData == MAP_FAILED) {
+        mData = nullptr;
+        shm_unlink(mName.c_str());
+        return false;
+    }
+#endif
+
+    mSize = size;
+    mOwner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name)
+{
+    close();
+    mName = platformName(name);
+
+#ifdef _WIN32
+    mHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mName.c_str());
+    if (mHandle == nullptr) {
+        return false;
+    }
+    mData = MapViewOfFile(mHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (mData == nullptr ||
+        VirtualQuery(mData, &info, sizeof(info)) != sizeof(info)) {
+        close();
+        return false;
+    }
+    mSize = info.RegionSize;
+#else
+    int fd = shm_open(mName.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    mSize = static_cast<std::size_t>(info.st_size);
+    mData = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mData == MAP_FAILED) {
+        mData = nullptr;
+        mSize = 0;
+        return false;
+    }
+#endif
+
+    mOwner = false;
+    return true;
+}
+
+void SharedMemory::close()
+{
+#ifdef _WIN32
+    if (mData != nullptr) {
+        UnmapViewOfFile(mData);
+    }
+    if (mHandle != nullptr) {
+        CloseHandle(mHandle);
+        mHandle = nullptr;
+    }
+#else
+    if (mData != nullptr) {
+        munmap(mData, mSize);
+    }
+    if (mOwner) {
+        shm_unlink(mName.c_str());
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+    mOwner = false;
+}
+
+void* SharedMemory::data() const
+{
+    return mData;
+}
+
+std::size_t SharedMemory::size() const
+{
+    return mSize;
+}
@@ -0,0 +1,60 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <cstddef>
+#include <string>
+
+/// @brief Named shared memory mapped into the process: POSIX shm_open on
+/// Linux and macOS, a named file mapping on Windows. The creator removes the
+/// name on close; processes that still map it keep their mapping.
+class SharedMemory
+{
+  private:
+    /// @brief Start of the mapping, null if nothing is mapped.
+    void* mData;
+    /// @brief Size of the mapping in bytes.
+    std::size_t mSize;
+    /// @brief Platform name of the memory.
+    std::string mName;
+    /// @brief Flag to indicate that this object created the memory.
+    bool mOwner;
+#ifdef _WIN32
+    /// @brief Handle of the file mapping.
+    void* mHandle;
+#endif
+
+  public:
+    /// @brief Constructor for the SharedMemory class, maps nothing.
+    SharedMemory();
+    /// @brief Destructor, unmaps the memory.
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    /// @brief Creates and maps zeroed memory, replacing memory left under
+    /// the same name by a crashed process.
+    /// @param name Name shared with the other processes.
+    /// @param size Size in bytes.
+    /// @return False if the memory cannot be created.
+    bool create(const std::string& name, std::size_t size);
+
+    /// @brief Maps memory created by another process.
+    /// @param name Name shared with the other processes.
+    /// @return False if there is no memory under the name.
+    bool open(const std::string& name);
+
+    /// @brief Unmaps the memory and removes the name if this object created
+    /// it.
+    void close();
+
+    /// @brief Returns the start of the mapping.
+    /// @return Pointer to the memory, null if nothing is mapped.
+    void* data() const;
+
+    /// @brief Returns the size of the mapping.
+    /// @return The size in bytes.
+    std::size_t size() const;
+};
+
+#endif // SHARED_MEMORY_H
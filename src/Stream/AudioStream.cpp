@@ -1,10 +1,19 @@
 #include "AudioStream.h"
 
-AudioStream::AudioStream(std::string modelFilepath) : mStream(nullptr)
+#include <filesystem>
+
+AudioStream::AudioStream(std::string modelFilepath) :
+    mStream(nullptr), mResumeState(false), mGovernedStage(nullptr),
+    mSpectralKalman(StagePlacement::Off), mPipelineLatency(0),
+    mKernels(selectKernels(0)), mInputPeak(0), mInputRms(0), mOutputPeak(0),
+    mOutputRms(0), mHostLatency(0), mDeadlineFrames(0), mRealTimeMode(false),
+    mRealTimePolicy(RealTimePolicy::Fifo), mRealTimePriority(80),
+    mCallbackThreadReady(false), mCallbackPriority(false),
+    mCallbackDenormalsOff(false), mCallbackReported(false)
 {
     PaError err = Pa_Initialize();
     if (err != paNoError) {
-        printf(AudioStreamException(err).what());
+        Log::write(LogLevel::Error, "%s", AudioStreamException(err).what());
     }
 
     mSR = 48000;
@@ -13,7 +22,18 @@ AudioStream::AudioStream(std::string modelFilepath) : mStream(nullptr)
 
     mReduceNoiseStatus = false;
 
-    mModel = std::make_unique<cppflow::model>(modelFilepath);
+    // a manifest lists model variants, pick the best this host sustains
+    if (std::filesystem::is_regular_file(modelFilepath)) {
+        ModelVariant variant = ModelAutoTuner(mSR).select(
+            modelFilepath, [](const ModelVariant& variant)
+            { return createModel(variant.path, variant.blockLen); });
+        modelFilepath = variant.path;
+        mBlockLen = static_cast<int>(variant.blockLen);
+    }
+
+    mBlockAdapter.configure(mBlockLen);
+
+    mModels.setModel(createModel(modelFilepath, mBlockLen));
 
     mNoiseGate = std::make_unique<NoiseGate>(-100);
 }
@@ -24,33 +44,12 @@ AudioStream::~AudioStream()
     Pa_Terminate();
 }
 
-void AudioStream::openStream(int outDeviceId)
+bool AudioStream::openStream(int outDeviceId)
 {
-    if (mStream) {
-        closeStream();
-    }
-
-    // setup input device parameters
-    PaStreamParameters inParams;
-    setupDevice(inParams);
-
-    // setup output device parameters
-    PaStreamParameters outParams;
-    setupDevice(outParams, outDeviceId);
-
-    PaError err = Pa_OpenStream(&mStream, &inParams, &outParams, mSR, mBlockLen,
-                                0, processCallback, this);
-    if (err != paNoError) {
-        printf(AudioStreamException(err).what());
-    }
-
-    err = Pa_StartStream(mStream);
-    if (err != paNoError) {
-        printf(AudioStreamException(err).what());
-    }
+    return openStream(Pa_GetDefaultInputDevice(), outDeviceId);
 }
 
-void AudioStream::openStream(int inDeviceId, int outDeviceId)
+bool AudioStream::openStream(int inDeviceId, int outDeviceId)
 {
     if (mStream) {
         closeStream();
@@ -63,25 +62,79 @@ void AudioStream::openStream(int inDeviceId, int outDeviceId)
     // setup output device parameters
     PaStreamParameters outParams;
     setupDevice(outParams, outDeviceId);
+    if (outParams.device != paNoDevice) {
+        outParams.suggestedLatency =
+            Pa_GetDeviceInfo(outParams.device)->defaultLowOutputLatency;
+    }
 
-    PaError err = Pa_OpenStream(&mStream, &inParams, &outParams, mSR, mBlockLen,
-                                0, processCallback, &mModel);
+    // a block runs in the callback that completes it, the host buffers one
+    // block more than its low latency to absorb that burst
+    double blockSeconds = static_cast<double>(mBlockLen) / mSR;
+    inParams.suggestedLatency += blockSeconds;
+    outParams.suggestedLatency += blockSeconds;
+
+    // let the host pick its native buffer size, the block adapter
+    // re-blocks it to the model block
+    PaError err = Pa_OpenStream(&mStream, &inParams, &outParams, mSR,
+                                paFramesPerBufferUnspecified, 0,
+                                processCallback, this);
     if (err != paNoError) {
-        printf(AudioStreamException(err).what());
+        Log::write(LogLevel::Error, "%s", AudioStreamException(err).what());
+        mStream = nullptr;
+        return false;
     }
 
+    // the governor deadline depends on what the host actually buffers
+    const PaStreamInfo* info = Pa_GetStreamInfo(mStream);
+    mHostLatency = info != nullptr ? info->outputLatency : 0;
+    prepareStream();
+
     err = Pa_StartStream(mStream);
     if (err != paNoError) {
-        printf(AudioStreamException(err).what());
+        Log::write(LogLevel::Error, "%s", AudioStreamException(err).what());
+        // the stream never ran, it only needs to be closed
+        Pa_CloseStream(mStream);
+        mStream = nullptr;
+        if (mRealTimeReport.memoryLocked) {
+            RealTime::unlockMemory();
+            mRealTimeReport.memoryLocked = false;
+        }
+        return false;
     }
+
+    Log::write(LogLevel::Info,
+               "Stream latency: %.1f ms (%zu frames algorithmic)",
+               getLatency() * 1000,
+               mBlockAdapter.latency() + mPipelineLatency +
+                   mOutputStage.latency());
+    return true;
+}
+
+VirtualRunReport AudioStream::runVirtual(const VirtualDeviceOptions& options)
+{
+    closeStream();
+    // the virtual device buffers nothing beyond the callback
+    mHostLatency = 0;
+    prepareStream();
+
+    // the same callback a device would call, on the virtual device thread,
+    // flushed for the algorithmic latency so the output lines up with input
+    std::size_t latency = mBlockAdapter.latency() + mPipelineLatency +
+                          mOutputStage.latency();
+    VirtualRunReport report = VirtualDevice(options, mSR, latency)
+                                  .run(&AudioStream::processCallback, this);
+
+    PerformanceStats stats = mPerformance.snapshot();
+    report.blockP50 = stats.blockP50;
+    report.blockP99 = stats.blockP99;
+    return report;
 }
 
 void AudioStream::setupDevice(PaStreamParameters& params, int deviceId)
 {
     params.device = deviceId;
     if (params.device == paNoDevice) {
-        printf(
-            AudioStreamException("Error: No default input device.\n").what());
+        Log::write(LogLevel::Error, "No default input device");
     }
     params.channelCount = 1;
     params.sampleFormat = paFloat32;
@@ -90,6 +143,116 @@ void AudioStream::setupDevice(PaStreamParameters& params, int deviceId)
     params.hostApiSpecificStreamInfo = nullptr;
 }
 
+void AudioStream::buildPipeline()
+{
+    // gate, then the model with cheaper fallbacks under CPU pressure,
+    // optionally with the per-bin Kalman filter on either side
+    mPipeline.clear();
+    mPipeline.add<GateStage>(*mNoiseGate);
+    if (mSpectralKalman == StagePlacement::BeforeModel) {
+        mPipeline.add<SpectralKalmanStage>(mSR);
+    }
+    mGovernedStage = &mPipeline.add<GovernedStage>(
+        mSR, std::make_unique<ModelStage>(mModels, mBlockLen),
+        std::make_unique<KalmanStage>(), std::make_unique<PassThroughStage>());
+    if (mSpectralKalman == StagePlacement::AfterModel) {
+        mPipeline.add<SpectralKalmanStage>(mSR);
+    }
+    // a pipelined model adds latency, the bypass is delayed to match it
+    mPipelineLatency = mPipeline.latency();
+    mPipeline.build(mBlockLen,
+                    DelayLine::arenaBytes(mPipelineLatency, mBlockLen));
+    mBypassDelay.prepare(mPipelineLatency, mBlockLen, mPipeline.arena());
+    // the stream processes whole blocks without overlap
+    mKernels = selectKernels(mBlockLen);
+
+    mBlockAdapter.reset();
+    mOutputStage.reset();
+}
+
+void AudioStream::prepareStream()
+{
+    buildPipeline();
+    // a new session starts from zero unless a snapshot was restored
+    if (!mResumeState) {
+        mModels.active()->resetState();
+    }
+    mResumeState = false;
+    // the callback thread takes this ring without locking or allocating
+    RTNR_TRACE_RESERVE("audio_callback");
+    prepareRealTime();
+    mPerformance.reset(static_cast<double>(mBlockLen) / mSR);
+    mDeadlineFrames = 0;
+}
+
+void AudioStream::prepareRealTime()
+{
+    // a new stream gets a new callback thread
+    mCallbackThreadReady = false;
+    mCallbackPriority = false;
+    mCallbackDenormalsOff = false;
+    mCallbackReported = false;
+
+    mRealTimeReport = RealTimeReport();
+    // threads of the model follow the callback thread
+    mModels.setRealTimeMode(mRealTimeMode, mRealTimePolicy,
+                            mRealTimePriority);
+    if (!mRealTimeMode) {
+        return;
+    }
+
+    mRealTimeReport.requested = true;
+    mRealTimeReport.policy = mRealTimePolicy;
+    mRealTimeReport.priority = mRealTimePriority;
+
+    // keep pipeline memory resident so the callback never page faults
+    mRealTimeReport.memoryLocked = RealTime::lockMemory();
+    mRealTimeReport.prefaultedBytes = mPipeline.prefault();
+
+    // probe privileges off the audio thread, fall back to normal scheduling
+    mRealTimeReport.priorityAllowed =
+        RealTime::probeThreadPriority(mRealTimePolicy, mRealTimePriority);
+
+    Log::write(LogLevel::Info,
+               "Real-time mode: memory %s, %zu bytes prefaulted, %s "
+               "priority %d%s",
+               mRealTimeReport.memoryLocked ? "locked" : "not locked",
+               mRealTimeReport.prefaultedBytes,
+               mRealTimePolicy == RealTimePolicy::RoundRobin ? "SCHED_RR"
+                                                             : "SCHED_FIFO",
+               mRealTimePriority,
+               mRealTimeReport.priorityAllowed ? "" : " (not permitted)");
+}
+
+void AudioStream::setupCallbackThread()
+{
+    mCallbackDenormalsOff = RealTime::disableDenormals();
+    if (mRealTimeReport.priorityAllowed) {
+        mCallbackPriority =
+            RealTime::setThreadPriority(mRealTimePolicy, mRealTimePriority);
+    }
+    RealTime::prefaultStack();
+
+    mCallbackThreadReady.store(true, std::memory_order_release);
+}
+
+void AudioStream::updateDeadline(unsigned long framesPerBuffer)
+{
+    mDeadlineFrames = framesPerBuffer;
+    if (mGovernedStage == nullptr) {
+        return;
+    }
+
+    // the callback that completes a block must return before the host runs
+    // out of buffered output, which leaves its buffering minus one period;
+    // blocks arrive once per block duration, so more never helps, and at
+    // worst the block has to fit into the period itself
+    double period = static_cast<double>(framesPerBuffer) / mSR;
+    double block = static_cast<double>(mBlockLen) / mSR;
+    mGovernedStage->setDeadline(
+        std::min(block, std::max(period, mHostLatency - period)));
+}
+
 int AudioStream::processCallback(const void* inputBuffer, void* outputBuffer,
                                  unsigned long framesPerBuffer,
                                  const PaStreamCallbackTimeInfo* timeInfo,
@@ -103,81 +266,118 @@ int AudioStream::processCallback(const void* inputBuffer, void* outputBuffer,
     // getting(casting) this class from userData
     auto stream = static_cast<AudioStream*>(userData);
 
-    // create vector from input values
-    std::vector<float> inputBufferVector(in, in + framesPerBuffer);
-
-    // use noise gate
-    stream->mNoiseGate.get()->process(inputBufferVector);
-
-    // create tensor from input values
-    cppflow::tensor inputTensor(inputBufferVector, {framesPerBuffer});
-    // expand dimension to match model input
-    inputTensor = cppflow::expand_dims(inputTensor, 0);
-
-    // predict results using model
-    cppflow::tensor outputTensor = stream->mModel->operator()(
-        {{"serving_default_main_input:0", inputTensor}},
-        {"StatefulPartitionedCall:0"}
-    )[0];
-
-    // define the axes along which to remove dimensions of size 1
-    std::vector<long long int> axes = {0, 1};
-    // squeeze to get only output values
-    outputTensor = cppflow::squeeze(outputTensor, axes);
-    // get output results vector from tensor
-    std::vector<float> outputBufferVector = outputTensor.get_data<float>();
-
-    // get max amplitude value from output buffer amplitudes
-    float maxAmplitude =
-        *std::max_element(outputBufferVector.begin(), outputBufferVector.end());
-    // calculate max amplitude in dB
-    int valueDb = 20 * log10(maxAmplitude);
-    // emit signal with max output value
-    emit stream->tick(valueDb);
-
-    // emit signal with gated output values
-    emit stream->tickGated(maxAmplitude);
-
-    if (inputBuffer == NULL) {
-        for (int i = 0; i < framesPerBuffer; i++) {
-            *out++ = 0;
-        }
-    } else if (stream->mReduceNoiseStatus) {
-        for (int i = 0; i < framesPerBuffer; i++) {
-            // write all values to output
-            *out++ = outputBufferVector[i];
-        }
-    } else {
-        for (int i = 0; i < framesPerBuffer; i++) {
-            *out++ = *in++;
-        }
+    RTNR_TRACE_THREAD("audio_callback");
+    RTNR_TRACE_SCOPE("callback");
+    auto callbackStart = std::chrono::steady_clock::now();
+
+    // configure the callback thread once in real-time mode
+    if (stream->mRealTimeMode &&
+        !stream->mCallbackThreadReady.load(std::memory_order_acquire)) {
+        stream->setupCallbackThread();
+    }
+
+    if (framesPerBuffer != stream->mDeadlineFrames) {
+        stream->updateDeadline(framesPerBuffer);
+    }
+
+    // re-block the device buffer into model blocks
+    stream->mBlockAdapter.process(
+        in, out, framesPerBuffer, [stream](const float* block, float* result)
+        { stream->processBlock(block, result); });
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - callbackStart;
+    bool xrun = (statusFlags & (paInputUnderflow | paInputOverflow |
+                                paOutputUnderflow | paOutputOverflow)) != 0;
+    if (xrun) {
+        RTNR_LOG_EVERY(1000, LogLevel::Warning,
+                       "Dropout in audio callback, status flags 0x%lx",
+                       statusFlags);
     }
+    stream->mPerformance.recordCallback(
+        elapsed.count(), static_cast<double>(framesPerBuffer) / stream->mSR,
+        xrun);
 
     return paContinue;
 }
 
+void AudioStream::processBlock(const float* in, float* out)
+{
+    RTNR_TRACE_SCOPE("block");
+
+    float inputPeak = 0;
+    float inputSquares = 0;
+    mKernels.meter(in, mBlockLen, inputPeak, inputSquares);
+    mInputPeak.store(inputPeak, std::memory_order_relaxed);
+    mInputRms.store(std::sqrt(inputSquares / mBlockLen),
+                    std::memory_order_relaxed);
+
+    // gate and governed model, without copies between the stages
+    auto blockStart = std::chrono::steady_clock::now();
+    const float* processed = mPipeline.run(in, mBlockLen);
+    const float* bypassed = mBypassDelay.process(in, mBlockLen);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - blockStart;
+    mPerformance.recordBlock(elapsed.count());
+
+    // gain, limiter and meter in one pass straight into the output hop, the
+    // bypass goes through the same stage so toggling keeps the latency
+    OutputLevels levels;
+    {
+        RTNR_TRACE_SCOPE("output");
+        levels = mOutputStage.process(mReduceNoiseStatus ? processed : bypassed,
+                                      out,
+                                      static_cast<std::size_t>(mBlockLen));
+    }
+    mOutputPeak.store(levels.peak, std::memory_order_relaxed);
+    mOutputRms.store(levels.rms, std::memory_order_relaxed);
+
+    if (mSharedSink.isOpen()) {
+        mSharedSink.publish(out, static_cast<std::size_t>(mBlockLen));
+    }
+    // the delayed input lines up with the output in the recording
+    mRecorder.push(bypassed, out, static_cast<std::size_t>(mBlockLen));
+    mSpectrumTap.push(bypassed, out, static_cast<std::size_t>(mBlockLen));
+}
+
 void AudioStream::closeStream()
 {
     if (mStream) {
         PaError err = Pa_StopStream(mStream);
         if (err != paNoError) {
-            printf(AudioStreamException(err).what());
+            Log::write(LogLevel::Error, "%s", AudioStreamException(err).what());
         }
 
         err = Pa_CloseStream(mStream);
         if (err != paNoError) {
-            printf(AudioStreamException(err).what());
+            Log::write(LogLevel::Error, "%s", AudioStreamException(err).what());
         }
 
         mStream = nullptr;
+
+        // the callback has stopped, the arena can be read safely
+        Log::write(LogLevel::Info, "Arena high-water mark: %zu of %zu bytes",
+                   mPipeline.arena().highWaterMark(),
+                   mPipeline.arena().capacity());
+
+        if (mRealTimeReport.memoryLocked) {
+            RealTime::unlockMemory();
+            mRealTimeReport.memoryLocked = false;
+        }
     }
 }
 
+bool AudioStream::isStreamOpen() const
+{
+    return mStream != nullptr;
+}
+
 int AudioStream::getDeviceIdByName(const std::string& deviceName)
 {
     int deviceCount = Pa_GetDeviceCount();
     if (deviceCount < 0) {
-        printf(AudioStreamException(deviceCount).what());
+        Log::write(LogLevel::Error, "%s",
+                   AudioStreamException(deviceCount).what());
     }
 
     int deviceId = -1;
@@ -190,8 +390,7 @@ int AudioStream::getDeviceIdByName(const std::string& deviceName)
     }
 
     if (deviceId < 0) {
-        printf(AudioStreamException("Error: No such device with given name.\n")
-                   .what());
+        Log::write(LogLevel::Error, "No such device with given name");
     }
 
     return deviceId;
@@ -201,7 +400,8 @@ void AudioStream::debugPrintAllDevices()
 {
     int deviceCount = Pa_GetDeviceCount();
     if (deviceCount < 0) {
-        printf(AudioStreamException(deviceCount).what());
+        Log::write(LogLevel::Error, "%s",
+                   AudioStreamException(deviceCount).what());
     }
 
     std::cout << "Available audio devices:" << std::endl;
@@ -217,7 +417,8 @@ void AudioStream::debugPrintAllInputDevices()
 {
     int deviceCount = Pa_GetDeviceCount();
     if (deviceCount < 0) {
-        printf(AudioStreamException(deviceCount).what());
+        Log::write(LogLevel::Error, "%s",
+                   AudioStreamException(deviceCount).what());
     }
 
     std::cout << "Available input audio devices:" << std::endl;
@@ -233,7 +434,8 @@ void AudioStream::debugPrintAllOutputDevices()
 {
     int deviceCount = Pa_GetDeviceCount();
     if (deviceCount < 0) {
-        printf(AudioStreamException(deviceCount).what());
+        Log::write(LogLevel::Error, "%s",
+                   AudioStreamException(deviceCount).what());
     }
 
     std::cout << "Available output audio devices:" << std::endl;
@@ -251,7 +453,8 @@ std::vector<std::string> AudioStream::getAllInputDevices()
     // get all devices count
     int deviceCount = Pa_GetDeviceCount();
     if (deviceCount < 0) {
-        printf(AudioStreamException(deviceCount).what());
+        Log::write(LogLevel::Error, "%s",
+                   AudioStreamException(deviceCount).what());
     }
     // through all devices
     for (int i = 0; i < deviceCount; i++) {
@@ -270,3 +473,187 @@ void AudioStream::setReduceNoise(bool status)
 {
     mReduceNoiseStatus = status;
 }
+
+void AudioStream::setRealTimeMode(bool status, RealTimePolicy policy,
+                                  int priority)
+{
+    mRealTimeMode = status;
+    mRealTimePolicy = policy;
+    mRealTimePriority = priority;
+}
+
+void AudioStream::setSpectralKalman(StagePlacement placement)
+{
+    mSpectralKalman = placement;
+}
+
+RealTimeReport AudioStream::getRealTimeReport() const
+{
+    RealTimeReport report = mRealTimeReport;
+    report.callbackThreadStarted = mCallbackThreadReady;
+    report.callbackPriority = mCallbackPriority;
+    report.callbackDenormalsOff = mCallbackDenormalsOff;
+    return report;
+}
+
+bool AudioStream::swapModel(const std::string& modelFilepath)
+{
+    std::size_t blockLen = mBlockLen;
+    return mModels.swapAsync(
+        [modelFilepath, blockLen]()
+        { return createModel(modelFilepath, blockLen); });
+}
+
+ModelSwapStats AudioStream::getModelSwapStats() const
+{
+    return mModels.getStats();
+}
+
+bool AudioStream::resetModelState()
+{
+    if (mStream) {
+        return false;
+    }
+    mResumeState = false;
+    return mModels.active()->resetState();
+}
+
+bool AudioStream::snapshotModelState(LstmState& snapshot) const
+{
+    const LstmState* state = mModels.active()->state();
+    if (mStream || state == nullptr) {
+        return false;
+    }
+    snapshot = *state;
+    return true;
+}
+
+bool AudioStream::restoreModelState(const LstmState& snapshot)
+{
+    if (mStream) {
+        return false;
+    }
+    mResumeState = mModels.active()->restoreState(snapshot);
+    return mResumeState;
+}
+
+bool AudioStream::openSharedSink(const std::string& name,
+                                 std::size_t blockCount)
+{
+    if (mStream) {
+        return false;
+    }
+    if (!mSharedSink.open(name, mSR, static_cast<std::size_t>(mBlockLen),
+                          blockCount)) {
+        Log::write(LogLevel::Error, "Cannot create shared memory sink %s",
+                   name);
+        return false;
+    }
+    Log::write(LogLevel::Info, "Publishing output to shared memory %s",
+               name);
+    return true;
+}
+
+bool AudioStream::closeSharedSink()
+{
+    if (mStream) {
+        return false;
+    }
+    mSharedSink.close();
+    return true;
+}
+
+bool AudioStream::startRecording(const RecorderOptions& options)
+{
+    return mRecorder.start(options, mSR, static_cast<std::size_t>(mBlockLen));
+}
+
+void AudioStream::stopRecording()
+{
+    mRecorder.stop();
+}
+
+SpectrumTap& AudioStream::getSpectrumTap()
+{
+    return mSpectrumTap;
+}
+
+GovernorStats AudioStream::getGovernorStats() const
+{
+    if (mGovernedStage == nullptr) {
+        return GovernorStats();
+    }
+    return mGovernedStage->governor().getStats();
+}
+
+PerformanceStats AudioStream::getPerformanceStats()
+{
+    // the callback thread does not log what it was granted, the first poll
+    // after its setup does
+    RealTimeReport realTime = getRealTimeReport();
+    if (realTime.requested && realTime.callbackThreadStarted &&
+        !mCallbackReported.exchange(true)) {
+        Log::write(LogLevel::Info,
+                   "Real-time callback thread: priority %s, FTZ/DAZ %s",
+                   realTime.callbackPriority ? "granted" : "not granted",
+                   realTime.callbackDenormalsOff ? "on" : "off");
+    }
+
+    PerformanceStats stats = mPerformance.snapshot();
+    stats.latency = getLatency();
+    // the governor publishes its tier atomically, the audio thread never
+    // signals a switch
+    stats.tier = static_cast<int>(getGovernorStats().tier);
+
+    SharedSinkStats sink = mSharedSink.getStats();
+    stats.sinkOpen = sink.open;
+    stats.sinkReaders = sink.readers;
+    stats.sinkReaderLag = sink.maxReaderLag;
+    stats.sinkOverruns = sink.readerOverruns;
+
+    RecorderStats recorder = mRecorder.getStats();
+    stats.recording = recorder.recording;
+    stats.recordedBlocks = recorder.recordedBlocks;
+    stats.recordDropped = recorder.droppedBlocks;
+    return stats;
+}
+
+int AudioStream::getSampleRate() const
+{
+    return mSR;
+}
+
+double AudioStream::getLatency() const
+{
+    std::size_t frames = mBlockAdapter.latency() + mPipelineLatency +
+                         mOutputStage.latency();
+    double latency = static_cast<double>(frames) / mSR;
+    if (mStream) {
+        const PaStreamInfo* info = Pa_GetStreamInfo(mStream);
+        if (info != nullptr) {
+            latency += info->inputLatency + info->outputLatency;
+        }
+    }
+    return latency;
+}
+
+OutputLevels AudioStream::getInputLevels() const
+{
+    OutputLevels levels;
+    levels.peak = mInputPeak.load(std::memory_order_relaxed);
+    levels.rms = mInputRms.load(std::memory_order_relaxed);
+    return levels;
+}
+
+OutputLevels AudioStream::getOutputLevels() const
+{
+    OutputLevels levels;
+    levels.peak = mOutputPeak.load(std::memory_order_relaxed);
+    levels.rms = mOutputRms.load(std::memory_order_relaxed);
+    return levels;
+}
+
+void AudioStream::setOutputGain(int gainDb)
+{
+    mOutputStage.setGain(static_cast<float>(gainDb));
+}
@@ -3,16 +3,36 @@
 
 #include <QObject>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
 
-#include <cppflow/cppflow.h>
 #include <portaudio.h>
 
+#include "../DSP/Kernels.h"
 #include "../Filters/NoiseGate.h"
+#include "../Inference/ModelAutoTuner.h"
+#include "../Inference/ModelFactory.h"
+#include "../Inference/ModelSwitcher.h"
+#include "../Pipeline/DelayLine.h"
+#include "../Pipeline/GovernedStage.h"
+#include "../Pipeline/Pipeline.h"
+#include "../Pipeline/Stages.h"
+#include "../Recorder/AudioRecorder.h"
+#include "../SharedAudio/SharedAudioSink.h"
+#include "../Util/Log.h"
+#include "../Util/RealTime.h"
+#include "../Util/Trace.h"
 #include "AudioStreamException.h"
+#include "BlockAdapter.h"
+#include "DegradationGovernor.h"
+#include "OutputStage.h"
+#include "PerformanceMonitor.h"
+#include "SpectrumTap.h"
+#include "VirtualDevice.h"
 
 /// @brief Class representing an audio stream.
 class AudioStream : public QObject
@@ -31,8 +51,79 @@ class AudioStream : public QObject
     /// @brief Flag to indicate that the noise reduction is active.
     bool mReduceNoiseStatus;
 
-    /// @brief Trained noise reduction model smart pointer.
-    std::unique_ptr<cppflow::model> mModel;
+    /// @brief Owner of the trained noise reduction model, replaces it while
+    /// the stream runs.
+    ModelSwitcher mModels;
+    /// @brief Flag to keep a restored model state on the next stream open
+    /// instead of starting from zero.
+    bool mResumeState;
+
+    /// @brief Adapter that re-blocks device buffers of any size into model
+    /// blocks.
+    BlockAdapter mBlockAdapter;
+
+    /// @brief Processing graph run for every model block, built on every
+    /// stream open.
+    Pipeline mPipeline;
+    /// @brief The governed model stage inside the pipeline.
+    GovernedStage* mGovernedStage;
+    /// @brief Where the per-bin Kalman filter runs, applied on the next
+    /// stream open.
+    StagePlacement mSpectralKalman;
+    /// @brief Latency of the pipeline in frames, fixed when it is built so
+    /// that other threads never ask the model for it.
+    std::size_t mPipelineLatency;
+    /// @brief Input delayed by the pipeline latency for the bypass.
+    DelayLine mBypassDelay;
+
+    /// @brief Kernels specialized for the block size of the opened stream.
+    KernelTable mKernels;
+    /// @brief Peak of the last input block.
+    std::atomic<float> mInputPeak;
+    /// @brief RMS of the last input block.
+    std::atomic<float> mInputRms;
+
+    /// @brief Fused gain, limiter and meter stage before the device.
+    OutputStage mOutputStage;
+    /// @brief Peak of the last output block.
+    std::atomic<float> mOutputPeak;
+    /// @brief RMS of the last output block.
+    std::atomic<float> mOutputRms;
+
+    /// @brief Callback load, block timings and xruns of the opened stream.
+    PerformanceMonitor mPerformance;
+    /// @brief Output latency the host granted in seconds, 0 for a virtual
+    /// device. Set before the stream starts.
+    double mHostLatency;
+    /// @brief Callback size the governor deadline was computed for, audio
+    /// thread only.
+    unsigned long mDeadlineFrames;
+
+    /// @brief Ring in shared memory that receives every output block.
+    SharedAudioSink mSharedSink;
+    /// @brief Tap that records the input and output blocks to disk.
+    AudioRecorder mRecorder;
+    /// @brief Tap that hands the input and output blocks to the displays.
+    SpectrumTap mSpectrumTap;
+
+    /// @brief Flag to indicate that the real-time mode is requested.
+    bool mRealTimeMode;
+    /// @brief Scheduling policy for the callback thread in real-time mode.
+    RealTimePolicy mRealTimePolicy;
+    /// @brief Scheduling priority for the callback thread in real-time mode.
+    int mRealTimePriority;
+    /// @brief What was granted when the stream was opened in real-time mode.
+    RealTimeReport mRealTimeReport;
+    /// @brief Flag to indicate that the current callback thread is set up.
+    std::atomic<bool> mCallbackThreadReady;
+    /// @brief Flag to indicate that the callback thread got real-time
+    /// priority.
+    std::atomic<bool> mCallbackPriority;
+    /// @brief Flag to indicate that denormals are disabled on the callback
+    /// thread.
+    std::atomic<bool> mCallbackDenormalsOff;
+    /// @brief Flag to indicate that the callback thread setup was logged.
+    std::atomic<bool> mCallbackReported;
 
     /// @brief Static function representing the process callback function.
     /// @param inputBuffer Pointer to the input buffer.
@@ -54,24 +145,60 @@ class AudioStream : public QObject
     void setupDevice(PaStreamParameters& params,
                      int deviceId = Pa_GetDefaultInputDevice());
 
+    /// @brief Private function to process one model block.
+    /// @param in Pointer to the input block of mBlockLen frames.
+    /// @param out Pointer to the output block of mBlockLen frames.
+    void processBlock(const float* in, float* out);
+
+    /// @brief Private function to build the processing pipeline and reset
+    /// all processing state before a stream starts.
+    void buildPipeline();
+    /// @brief Private function to prepare everything a stream needs before
+    /// its first callback, for a device or a virtual device alike.
+    void prepareStream();
+    /// @brief Private function to lock memory, prefault buffers and probe
+    /// scheduling privileges before the stream starts in real-time mode.
+    void prepareRealTime();
+    /// @brief Private function to apply real-time priority and denormal
+    /// protection to the callback thread. Runs once per opened stream on the
+    /// callback thread itself.
+    void setupCallbackThread();
+    /// @brief Private function to set the deadline of the governor for the
+    /// callback size. Runs on the callback thread when the size changes.
+    /// @param framesPerBuffer Number of frames in the callback.
+    void updateDeadline(unsigned long framesPerBuffer);
+
   public:
     /// @brief Constructor for the AudioStream class.
-    /// @param modelFilepath Path to the noise reduction model directory.
+    /// @param modelFilepath Path to the noise reduction model directory, "aot"
+    /// for the compiled model, or a manifest of model variants to pick from
+    /// by benchmarking this host.
+    /// @throws std::runtime_error If the manifest cannot be read.
     AudioStream(std::string modelFilepath = "./model");
     /// @brief Destructor for the AudioStream class.
     ~AudioStream();
 
     /// @brief Function to open the stream from the default input device.
     /// @param outDeviceId The ID of the output device.
-    /// @throws AudioStreamException If there is an error opening the stream.
-    void openStream(int outDeviceId);
+    /// @return False if the stream cannot be opened or started, no stream is
+    /// left open then.
+    bool openStream(int outDeviceId);
     /// @brief Function to open the stream.
     /// @param inDeviceId The ID of the input device.
     /// @param outDeviceId The ID of the output device.
-    /// @throws AudioStreamException If there is an error opening the stream.
-    void openStream(int inDeviceId, int outDeviceId);
+    /// @return False if the stream cannot be opened or started, no stream is
+    /// left open then.
+    bool openStream(int inDeviceId, int outDeviceId);
     /// @brief Function to close the audio stream.
     void closeStream();
+    /// @brief Function to run the stream callback on a virtual device fed
+    /// from a file instead of a sound card. Blocks until the file is done.
+    /// @param options Files, buffer size and pacing of the virtual device.
+    /// @return Throughput and timings of the run.
+    VirtualRunReport runVirtual(const VirtualDeviceOptions& options);
+    /// @brief Function to check whether a stream is open.
+    /// @return True if a stream is open.
+    bool isStreamOpen() const;
 
     /// @brief Function to get the device ID by name.
     /// @param deviceName The name of the device.
@@ -86,24 +213,121 @@ class AudioStream : public QObject
     /// @return Vector with the names of the input devices.
     std::vector<std::string> getAllInputDevices();
 
+    /// @brief Function to request the real-time mode. Takes effect on the next
+    /// openStream call.
+    /// @param status Boolean to set.
+    /// @param policy The scheduling policy for the callback thread.
+    /// @param priority The scheduling priority for the callback thread.
+    void setRealTimeMode(bool status,
+                         RealTimePolicy policy = RealTimePolicy::Fifo,
+                         int priority = 80);
+    /// @brief Function to run the per-bin Kalman filter before or after the
+    /// model. Takes effect on the next openStream call.
+    /// @param placement Where the filter runs, Off to remove it.
+    void setSpectralKalman(StagePlacement placement);
+
+    /// @brief Function to get what was granted for the real-time mode.
+    /// @return The real-time report of the currently opened stream.
+    RealTimeReport getRealTimeReport() const;
+
+    /// @brief Function to get the sample rate of the stream.
+    /// @return The sample rate in Hz.
+    int getSampleRate() const;
+
+    /// @brief Function to get the end-to-end latency of the opened stream:
+    /// device input and output latency plus the one block re-blocking delay
+    /// and the pipeline latency. A block runs inside the callback that
+    /// completes it, so the stream asks the host for one block of buffering
+    /// on top of its low latency to absorb that burst; the device latencies
+    /// include it.
+    /// @return The latency in seconds.
+    double getLatency() const;
+
+    /// @brief Function to get the levels of the last input block.
+    /// @return Peak and RMS of the samples received from the device.
+    OutputLevels getInputLevels() const;
+    /// @brief Function to get the levels of the last output block.
+    /// @return Peak and RMS of the samples sent to the device.
+    OutputLevels getOutputLevels() const;
+
+    /// @brief Function to replace the noise reduction model without stopping
+    /// the stream. The model is loaded and warmed in the background and
+    /// crossfaded in at the next block boundary; the old one is freed off the
+    /// audio thread. With no stream open, the swap completes on the next open.
+    /// @param modelFilepath Path to the new model directory. The model must
+    /// take blocks of the current block length and have the latency of the
+    /// current model, a split model only replaces a split model.
+    /// @return False if a swap is already in progress.
+    bool swapModel(const std::string& modelFilepath);
+    /// @brief Function to get the model swap counters.
+    /// @return Snapshot of the swap count, load and adoption times.
+    ModelSwapStats getModelSwapStats() const;
+
+    /// @brief Function to clear the LSTM state of the model. Every stream
+    /// open does this too, unless a state was restored before it.
+    /// @return False if a stream is open or the model keeps its state
+    /// hidden in the runtime.
+    bool resetModelState();
+    /// @brief Function to copy the LSTM state of the model, to pause a
+    /// session or move it to another stream.
+    /// @param snapshot Receives the state.
+    /// @return False if a stream is open or the model keeps its state
+    /// hidden in the runtime.
+    bool snapshotModelState(LstmState& snapshot) const;
+    /// @brief Function to continue from a snapshot on the next stream open,
+    /// without a warm-up.
+    /// @param snapshot The state, from a model with the same layout.
+    /// @return False if a stream is open, the model keeps its state hidden
+    /// or the layout differs.
+    bool restoreModelState(const LstmState& snapshot);
+
+    /// @brief Function to publish every output block to a shared memory ring
+    /// that other local processes read with SharedAudioReader.
+    /// @param name Name of the shared memory.
+    /// @param blockCount Number of blocks the ring holds, the slack a reader
+    /// has before it overruns.
+    /// @return False if a stream is open or the memory cannot be created.
+    bool openSharedSink(const std::string& name, std::size_t blockCount = 32);
+    /// @brief Function to stop publishing and remove the shared memory.
+    /// @return False if a stream is open.
+    bool closeSharedSink();
+
+    /// @brief Function to record the input and the processed output to a
+    /// stereo file, also while the stream runs. The audio thread only copies
+    /// the blocks, a background thread writes them.
+    /// @param options File, rotation and buffer settings.
+    /// @return False if the file cannot be opened.
+    bool startRecording(const RecorderOptions& options);
+    /// @brief Function to write the buffered blocks and close the recording.
+    void stopRecording();
+
+    /// @brief Function to get the tap that hands every input and output
+    /// block to a display thread. It is detached until a reader attaches.
+    /// @return The tap, alive as long as the stream object.
+    SpectrumTap& getSpectrumTap();
+
+    /// @brief Function to get the degradation governor counters.
+    /// @return Snapshot of the switch events and the time spent per tier.
+    GovernorStats getGovernorStats() const;
+
+    /// @brief Function to get the performance counters of the opened stream.
+    /// Lock-free, meant to be polled from a single thread at a low rate. The
+    /// first poll after the real-time setup of the callback thread logs what
+    /// that thread was granted.
+    /// @return Snapshot of the load, block timings, xruns and latency.
+    PerformanceStats getPerformanceStats();
+
     /// @brief The class object smart pointer which is responsible for noise
     /// gating.
     std::unique_ptr<NoiseGate> mNoiseGate;
 
-  signals:
-    /// @brief The custom signal for passing the maximum amplitude value in dB
-    /// on sound input.
-    /// @param value The maximum amplitude value in dB.
-    void tick(int value);
-    /// @brief The custom signal for passing the maximum amplitude value on
-    /// sound input.
-    /// @param outBuffer The maximum amplitude value.
-    void tickGated(float value);
-
   public slots:
     /// @brief Function to set noise reduction status.
     /// @param status Boolean to set.
     void setReduceNoise(bool status);
+    /// @brief Function to set the output gain applied before the limiter.
+    /// @param gainDb The gain in dB.
+    void setOutputGain(int gainDb);
 };
 
 #endif // AUDIO_STREAM_H
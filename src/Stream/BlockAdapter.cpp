@@ -0,0 +1,31 @@
+#include "BlockAdapter.h"
+
+BlockAdapter::BlockAdapter(std::size_t hop) : mHop(0), mFill(0)
+{
+    configure(hop);
+}
+
+void BlockAdapter::configure(std::size_t hop)
+{
+    mHop = hop;
+    mInput.assign(mHop, 0.0f);
+    mOutput.assign(mHop, 0.0f);
+    mFill = 0;
+}
+
+void BlockAdapter::reset()
+{
+    std::fill(mInput.begin(), mInput.end(), 0.0f);
+    std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+    mFill = 0;
+}
+
+std::size_t BlockAdapter::hop() const
+{
+    return mHop;
+}
+
+std::size_t BlockAdapter::latency() const
+{
+    return mHop;
+}
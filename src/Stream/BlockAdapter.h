@@ -0,0 +1,98 @@
+#ifndef BLOCK_ADAPTER_H
+#define BLOCK_ADAPTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/// @brief The BlockAdapter class decouples the device buffer size from the
+/// processing block size. Callbacks of any and varying size are accumulated
+/// into fixed hops, every full hop is processed once, and the output is
+/// emitted with a constant latency of exactly one hop. The input and output
+/// hops are the only buffers, both allocated by configure, so the adapter
+/// never allocates on the audio thread. A hop is processed inside the
+/// callback that completes it, so that callback carries the cost of a whole
+/// hop while the others only copy; the host buffer has to absorb it.
+class BlockAdapter
+{
+  private:
+    /// @brief Number of frames in one processing hop.
+    std::size_t mHop;
+    /// @brief Input frames accumulated for the next hop.
+    std::vector<float> mInput;
+    /// @brief Output frames of the last processed hop.
+    std::vector<float> mOutput;
+    /// @brief Number of frames already accumulated in the input hop. The
+    /// same number of frames has been emitted from the output hop.
+    std::size_t mFill;
+
+  public:
+    /// @brief Constructor for the BlockAdapter class.
+    /// @param hop Number of frames in one processing hop.
+    BlockAdapter(std::size_t hop = 0);
+
+    /// @brief Allocates the hop buffers and resets the adapter.
+    /// @param hop Number of frames in one processing hop.
+    void configure(std::size_t hop);
+
+    /// @brief Clears the accumulated frames and primes the output with one
+    /// hop of silence.
+    void reset();
+
+    /// @brief Returns the number of frames in one processing hop.
+    /// @return The hop size.
+    std::size_t hop() const;
+
+    /// @brief Returns the constant delay between input and output.
+    /// @return The latency in frames.
+    std::size_t latency() const;
+
+    /// @brief Pushes the callback input, processes every completed hop and
+    /// pulls the same number of output frames.
+    /// @param in Pointer to the input frames, nullptr is treated as silence.
+    /// @param out Pointer to the output frames.
+    /// @param frames Number of frames in the callback buffers.
+    /// @param processHop Callable invoked as processHop(const float* in,
+    /// float* out) for every full hop.
+    template <typename ProcessHop>
+    void process(const float* in, float* out, std::size_t frames,
+                 ProcessHop&& processHop);
+};
+
+template <typename ProcessHop>
+void BlockAdapter::process(const float* in, float* out, std::size_t frames,
+                           ProcessHop&& processHop)
+{
+    if (mHop == 0) {
+        std::fill(out, out + frames, 0.0f);
+        return;
+    }
+
+    while (frames > 0) {
+        // the free input space always equals the unread output
+        std::size_t chunk = std::min(frames, mHop - mFill);
+
+        if (in != nullptr) {
+            std::copy(in, in + chunk, mInput.begin() + mFill);
+            in += chunk;
+        } else {
+            std::fill(mInput.begin() + mFill, mInput.begin() + mFill + chunk,
+                      0.0f);
+        }
+        std::copy(mOutput.begin() + mFill, mOutput.begin() + mFill + chunk,
+                  out);
+        out += chunk;
+
+        mFill += chunk;
+        frames -= chunk;
+
+        // the whole hop runs within this callback
+        if (mFill == mHop) {
+            processHop(static_cast<const float*>(mInput.data()),
+                       mOutput.data());
+            mFill = 0;
+        }
+    }
+}
+
+#endif // BLOCK_ADAPTER_H
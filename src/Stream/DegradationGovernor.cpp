@@ -0,0 +1,146 @@
+#include "DegradationGovernor.h"
+
+#include <algorithm>
+
+namespace
+{
+/// @brief Upper bound for the upgrade backoff, in multiples of the initial
+/// recovery period.
+constexpr int kMaxBackoffFactor = 16;
+} // namespace
+
+DegradationGovernor::DegradationGovernor(double highLoad, double lowLoad,
+                                         int recoverBlocks) :
+    mBlockSeconds(0), mDeadlineSeconds(0), mMissLoad(1.0),
+    mHighLoad(highLoad), mLowLoad(lowLoad), mRecoverBlocks(recoverBlocks),
+    mBackoffBlocks(recoverBlocks),
+    mCalmBlocks(0), mTierBlocks(0), mProbing(false), mSmoothing(0.2),
+    mLoad(0),
+    mTier(static_cast<int>(ProcessingTier::Model)), mDowngrades(0),
+    mUpgrades(0), mDeadlineMisses(0), mPublishedLoad(0)
+{
+    for (auto& blocks : mBlocksInTier) {
+        blocks = 0;
+    }
+}
+
+void DegradationGovernor::reset(double blockSeconds)
+{
+    mBlockSeconds = blockSeconds;
+    mDeadlineSeconds = blockSeconds;
+    mBackoffBlocks = mRecoverBlocks;
+    mCalmBlocks = 0;
+    mTierBlocks = 0;
+    mProbing = false;
+    mLoad = 0;
+    mTier = static_cast<int>(ProcessingTier::Model);
+    mPublishedLoad = 0;
+}
+
+void DegradationGovernor::setDeadline(double seconds)
+{
+    mDeadlineSeconds.store(seconds, std::memory_order_relaxed);
+}
+
+ProcessingTier DegradationGovernor::tier() const
+{
+    return static_cast<ProcessingTier>(mTier.load(std::memory_order_relaxed));
+}
+
+ProcessingTier DegradationGovernor::update(double processingSeconds)
+{
+    ProcessingTier current = tier();
+    mBlocksInTier[static_cast<int>(current)].fetch_add(
+        1, std::memory_order_relaxed);
+
+    double deadline = mDeadlineSeconds.load(std::memory_order_relaxed);
+    if (deadline <= 0) {
+        return current;
+    }
+
+    double blockLoad = processingSeconds / deadline;
+    mLoad += mSmoothing * (blockLoad - mLoad);
+    mPublishedLoad.store(static_cast<int>(mLoad * 1000),
+                         std::memory_order_relaxed);
+
+    if (blockLoad >= mMissLoad) {
+        mDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // the probe survived a full recovery period, trust the tier again
+    ++mTierBlocks;
+    if (mProbing && mTierBlocks >= mRecoverBlocks) {
+        mProbing = false;
+        mBackoffBlocks = mRecoverBlocks;
+    }
+
+    // step down on a missed deadline or a sustained high load
+    if (blockLoad >= mMissLoad || mLoad >= mHighLoad) {
+        mCalmBlocks = 0;
+        if (current != ProcessingTier::Gate) {
+            // a failed probe makes the next probe wait longer
+            if (mProbing) {
+                mBackoffBlocks = std::min(mBackoffBlocks * 2,
+                                          mRecoverBlocks * kMaxBackoffFactor);
+                mProbing = false;
+            }
+            switchTo(
+                static_cast<ProcessingTier>(static_cast<int>(current) + 1));
+        }
+        return tier();
+    }
+
+    if (mLoad > mLowLoad) {
+        mCalmBlocks = 0;
+        return current;
+    }
+
+    // enough headroom for long enough, probe the better tier
+    if (++mCalmBlocks >= mBackoffBlocks && current != ProcessingTier::Model) {
+        mCalmBlocks = 0;
+        mProbing = true;
+        switchTo(
+            static_cast<ProcessingTier>(static_cast<int>(current) - 1));
+    }
+
+    return tier();
+}
+
+void DegradationGovernor::switchTo(ProcessingTier tier)
+{
+    if (static_cast<int>(tier) > mTier.load(std::memory_order_relaxed)) {
+        mDowngrades.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        mUpgrades.fetch_add(1, std::memory_order_relaxed);
+    }
+    // the new tier costs differently, start measuring from scratch
+    mLoad = 0;
+    mTierBlocks = 0;
+    mTier.store(static_cast<int>(tier), std::memory_order_relaxed);
+}
+
+GovernorStats DegradationGovernor::getStats() const
+{
+    GovernorStats stats;
+    stats.tier = tier();
+    stats.downgrades = mDowngrades.load(std::memory_order_relaxed);
+    stats.upgrades = mUpgrades.load(std::memory_order_relaxed);
+    stats.deadlineMisses = mDeadlineMisses.load(std::memory_order_relaxed);
+    double blockSeconds = mBlockSeconds.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kProcessingTierCount; ++i) {
+        stats.secondsInTier[i] =
+            mBlocksInTier[i].load(std::memory_order_relaxed) * blockSeconds;
+    }
+    stats.load = mPublishedLoad.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void DegradationGovernor::crossfade(const float* from, const float* to,
+                                    float* out, std::size_t frames)
+{
+    float step = 1.0f / static_cast<float>(frames);
+    for (std::size_t i = 0; i < frames; ++i) {
+        float t = (static_cast<float>(i) + 0.5f) * step;
+        out[i] = from[i] + t * (to[i] - from[i]);
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef DEGRADATION_GOVERNOR_H
+#define DEGRADATION_GOVERNOR_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Processing tiers ordered from the best quality to the cheapest.
+enum class ProcessingTier
+{
+    /// @brief Noise gate followed by the neural noise reduction model.
+    Model = 0,
+    /// @brief Noise gate followed by per-sample Kalman smoothing.
+    Kalman = 1,
+    /// @brief Noise gate only.
+    Gate = 2
+};
+
+/// @brief Number of processing tiers.
+constexpr std::size_t kProcessingTierCount = 3;
+
+/// @brief Snapshot of the governor counters.
+struct GovernorStats
+{
+    /// @brief The tier used for the next block.
+    ProcessingTier tier = ProcessingTier::Model;
+    /// @brief Number of switches to a cheaper tier.
+    std::uint64_t downgrades = 0;
+    /// @brief Number of switches to a better tier.
+    std::uint64_t upgrades = 0;
+    /// @brief Number of blocks that took longer than their deadline.
+    std::uint64_t deadlineMisses = 0;
+    /// @brief Time spent in each tier in seconds, indexed by ProcessingTier.
+    std::array<double, kProcessingTierCount> secondsInTier{};
+    /// @brief Smoothed processing time divided by the deadline.
+    double load = 0;
+};
+
+/// @brief The DegradationGovernor class tracks the processing time of every
+/// block against its deadline and picks the processing tier for the next
+/// block. It steps down to a cheaper tier as soon as the load gets too close
+/// to the deadline and probes the better tier again after a period of
+/// headroom, doubling that period each time a probe fails to avoid flapping.
+/// The update function is called from the audio thread only, the statistics
+/// may be read from any thread.
+class DegradationGovernor
+{
+  private:
+    /// @brief Duration of one block in seconds, read by getStats on other
+    /// threads.
+    std::atomic<double> mBlockSeconds;
+    /// @brief Time a block may take in seconds.
+    std::atomic<double> mDeadlineSeconds;
+    /// @brief Load of a single block that forces a downgrade.
+    double mMissLoad;
+    /// @brief Smoothed load that forces a downgrade.
+    double mHighLoad;
+    /// @brief Smoothed load under which the governor tries to upgrade.
+    double mLowLoad;
+    /// @brief Number of calm blocks before the first upgrade attempt.
+    int mRecoverBlocks;
+    /// @brief Current number of calm blocks required before an upgrade.
+    int mBackoffBlocks;
+    /// @brief Number of consecutive calm blocks in the current tier.
+    int mCalmBlocks;
+    /// @brief Number of blocks processed since the last switch.
+    int mTierBlocks;
+    /// @brief Flag to indicate that the current tier is an upgrade probe.
+    bool mProbing;
+    /// @brief Smoothing factor of the load moving average.
+    double mSmoothing;
+    /// @brief Smoothed load, audio thread only.
+    double mLoad;
+
+    /// @brief The tier used for the next block.
+    std::atomic<int> mTier;
+    /// @brief Counter of switches to a cheaper tier.
+    std::atomic<std::uint64_t> mDowngrades;
+    /// @brief Counter of switches to a better tier.
+    std::atomic<std::uint64_t> mUpgrades;
+    /// @brief Counter of blocks that missed their deadline.
+    std::atomic<std::uint64_t> mDeadlineMisses;
+    /// @brief Counter of blocks processed in each tier.
+    std::array<std::atomic<std::uint64_t>, kProcessingTierCount> mBlocksInTier;
+    /// @brief Smoothed load published for other threads, in 1/1000 units.
+    std::atomic<int> mPublishedLoad;
+
+    /// @brief Switches the tier and updates the counters.
+    /// @param tier The new tier.
+    void switchTo(ProcessingTier tier);
+
+  public:
+    /// @brief Constructor for the DegradationGovernor class.
+    /// @param highLoad Smoothed load that forces a downgrade. Defaults to 0.75.
+    /// @param lowLoad Smoothed load under which an upgrade is attempted.
+    /// Defaults to 0.25.
+    /// @param recoverBlocks Number of calm blocks before the first upgrade
+    /// attempt. Defaults to 64.
+    DegradationGovernor(double highLoad = 0.75, double lowLoad = 0.25,
+                        int recoverBlocks = 64);
+
+    /// @brief Resets the governor to the best tier for a new stream. The
+    /// deadline is the block duration until setDeadline is called.
+    /// @param blockSeconds Duration of one block in seconds.
+    void reset(double blockSeconds);
+
+    /// @brief Sets the time a block may take. May be called from any thread.
+    /// @param seconds The deadline in seconds.
+    void setDeadline(double seconds);
+
+    /// @brief Returns the tier that should process the next block.
+    /// @return The current tier.
+    ProcessingTier tier() const;
+
+    /// @brief Records the processing time of a block and picks the tier for
+    /// the next block. Called from the audio thread only.
+    /// @param processingSeconds The time spent on the block in seconds.
+    /// @return The tier for the next block.
+    ProcessingTier update(double processingSeconds);
+
+    /// @brief Returns a snapshot of the governor counters.
+    /// @return The governor statistics.
+    GovernorStats getStats() const;
+
+    /// @brief Linearly crossfades two blocks.
+    /// @param from The block faded out.
+    /// @param to The block faded in.
+    /// @param out The output block, may alias one of the inputs.
+    /// @param frames Number of frames in each block.
+    static void crossfade(const float* from, const float* to, float* out,
+                          std::size_t frames);
+};
+
+#endif // DEGRADATION_GOVERNOR_H
@@ -0,0 +1,155 @@
+#include "OutputStage.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// @brief Number of samples handled together on the unlimited fast path.
+constexpr std::size_t kChunk = 16;
+} // namespace
+
+OutputStage::OutputStage(std::size_t lookahead, float ceilingDb,
+                         float releaseMs, int sampleRate) :
+    mGain(1.0f), mCeiling(std::pow(10.0f, ceilingDb / 20.0f)),
+    mDelay(std::max<std::size_t>(lookahead, 1), 0.0f), mDelayPos(0),
+    mLimiterGain(1.0f), mTargetGain(1.0f), mGainStep(0), mRampLeft(0),
+    mHoldLeft(0),
+    mRelease(1.0f - std::exp(-1000.0f / (releaseMs * sampleRate)))
+{}
+
+void OutputStage::reset()
+{
+    std::fill(mDelay.begin(), mDelay.end(), 0.0f);
+    mDelayPos = 0;
+    mLimiterGain = 1.0f;
+    mTargetGain = 1.0f;
+    mGainStep = 0;
+    mRampLeft = 0;
+    mHoldLeft = 0;
+}
+
+std::size_t OutputStage::latency() const
+{
+    return mDelay.size();
+}
+
+void OutputStage::setGain(float gainDb)
+{
+    mGain.store(std::pow(10.0f, gainDb / 20.0f), std::memory_order_relaxed);
+}
+
+float OutputStage::limitSample(float sample)
+{
+    const std::size_t lookahead = mDelay.size();
+
+    float level = std::fabs(sample);
+    if (level > mCeiling) {
+        float required = mCeiling / level;
+        // keep the gain down until this sample has left the delay line
+        mHoldLeft = lookahead;
+        if (required < mTargetGain) {
+            // reach the required gain exactly when the sample is output
+            float step = (required - mLimiterGain) / lookahead;
+            mGainStep = mRampLeft > 0 ? std::min(mGainStep, step) : step;
+            mTargetGain = required;
+            mRampLeft = lookahead;
+        }
+    }
+
+    if (mRampLeft > 0) {
+        mLimiterGain = std::max(mLimiterGain + mGainStep, mTargetGain);
+        --mRampLeft;
+    } else if (mHoldLeft > 0) {
+        --mHoldLeft;
+    } else if (mLimiterGain < 1.0f) {
+        mLimiterGain += (1.0f - mLimiterGain) * mRelease;
+        if (mLimiterGain > 0.9999f) {
+            mLimiterGain = 1.0f;
+        }
+        mTargetGain = mLimiterGain;
+    }
+
+    float delayed = mDelay[mDelayPos];
+    mDelay[mDelayPos] = sample;
+    mDelayPos = mDelayPos + 1 == lookahead ? 0 : mDelayPos + 1;
+
+    // the clamp keeps the ceiling even for overlapping ramps
+    return std::clamp(delayed * mLimiterGain, -mCeiling, mCeiling);
+}
+
+OutputLevels OutputStage::process(const float* in, float* out,
+                                  std::size_t frames)
+{
+    const float gain = mGain.load(std::memory_order_relaxed);
+    const std::size_t lookahead = mDelay.size();
+
+    // per-lane accumulators keep the reductions vectorizable without
+    // reassociating floating point math
+    float lanePeak[kChunk] = {};
+    float laneSquares[kChunk] = {};
+
+    std::size_t i = 0;
+    while (i < frames) {
+        std::size_t chunk = std::min(kChunk, frames - i);
+
+        bool idle = mRampLeft == 0 && mHoldLeft == 0 && mLimiterGain == 1.0f;
+        if (idle && chunk == kChunk && mDelayPos + kChunk <= lookahead) {
+            float scaled[kChunk];
+            float chunkPeak[kChunk];
+            for (std::size_t k = 0; k < kChunk; ++k) {
+                scaled[k] = in[i + k] * gain;
+                chunkPeak[k] = std::fabs(scaled[k]);
+            }
+
+            float maxLevel = 0;
+            for (std::size_t k = 0; k < kChunk; ++k) {
+                maxLevel = std::max(maxLevel, chunkPeak[k]);
+            }
+
+            // nothing to limit, the stage is a pure delay for this chunk
+            if (maxLevel <= mCeiling) {
+                float* delay = mDelay.data() + mDelayPos;
+                for (std::size_t k = 0; k < kChunk; ++k) {
+                    float delayed = delay[k];
+                    delay[k] = scaled[k];
+                    out[i + k] = delayed;
+                    lanePeak[k] = std::max(lanePeak[k], std::fabs(delayed));
+                    laneSquares[k] += delayed * delayed;
+                }
+                mDelayPos += kChunk;
+                if (mDelayPos == lookahead) {
+                    mDelayPos = 0;
+                }
+                i += kChunk;
+                continue;
+            }
+        }
+
+        for (std::size_t k = 0; k < chunk; ++k) {
+            float limited = limitSample(in[i + k] * gain);
+            out[i + k] = limited;
+            lanePeak[k] = std::max(lanePeak[k], std::fabs(limited));
+            laneSquares[k] += limited * limited;
+        }
+        i += chunk;
+    }
+
+    OutputLevels levels;
+    float squares = 0;
+    for (std::size_t k = 0; k < kChunk; ++k) {
+        levels.peak = std::max(levels.peak, lanePeak[k]);
+        squares += laneSquares[k];
+    }
+    levels.rms = frames > 0 ? std::sqrt(squares / frames) : 0.0f;
+
+    return levels;
+}
+
+int OutputStage::toDecibels(float amplitude, int floorDb)
+{
+    if (!(amplitude > 0)) {
+        return floorDb;
+    }
+    return std::max(floorDb, static_cast<int>(20 * std::log10(amplitude)));
+}
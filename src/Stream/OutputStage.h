@@ -0,0 +1,88 @@
+#ifndef OUTPUT_STAGE_H
+#define OUTPUT_STAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// @brief Peak and RMS level of one output block.
+struct OutputLevels
+{
+    /// @brief Maximum absolute sample value.
+    float peak = 0;
+    /// @brief Root mean square of the samples.
+    float rms = 0;
+};
+
+/// @brief The OutputStage class is the last stage before the device buffer.
+/// In a single pass over the block it applies the output gain, runs a short
+/// lookahead brickwall limiter, writes the result and measures its peak and
+/// RMS. Runs of samples that need no limiting take a branch-free chunked path
+/// that the compiler vectorizes; the limiter envelope itself is only updated
+/// sample by sample while it is active.
+class OutputStage
+{
+  private:
+    /// @brief Output gain as linear factor, may be changed from any thread.
+    std::atomic<float> mGain;
+    /// @brief Maximum absolute output sample value.
+    float mCeiling;
+    /// @brief Lookahead delay line.
+    std::vector<float> mDelay;
+    /// @brief Current position in the delay line.
+    std::size_t mDelayPos;
+    /// @brief Current limiter gain.
+    float mLimiterGain;
+    /// @brief Gain the current attack ramp ends at.
+    float mTargetGain;
+    /// @brief Limiter gain change per sample during the attack ramp.
+    float mGainStep;
+    /// @brief Number of samples left in the attack ramp.
+    std::size_t mRampLeft;
+    /// @brief Number of samples the gain is held before the release starts.
+    std::size_t mHoldLeft;
+    /// @brief Release smoothing factor per sample.
+    float mRelease;
+
+    /// @brief Processes one sample through the limiter.
+    /// @param sample The sample with the output gain applied.
+    /// @return The delayed and limited sample.
+    float limitSample(float sample);
+
+  public:
+    /// @brief Constructor for the OutputStage class.
+    /// @param lookahead Lookahead of the limiter in frames. Defaults to 48,
+    /// 1 ms for 48k sr.
+    /// @param ceilingDb Limiter ceiling in dBFS. Defaults to -0.1.
+    /// @param releaseMs Limiter release time in milliseconds. Defaults to 50.
+    /// @param sampleRate Sample rate. Defaults to 48000.
+    OutputStage(std::size_t lookahead = 48, float ceilingDb = -0.1f,
+                float releaseMs = 50.0f, int sampleRate = 48000);
+
+    /// @brief Clears the delay line and the limiter state.
+    void reset();
+
+    /// @brief Returns the delay added by the limiter lookahead.
+    /// @return The latency in frames.
+    std::size_t latency() const;
+
+    /// @brief Sets the output gain.
+    /// @param gainDb The gain in dB.
+    void setGain(float gainDb);
+
+    /// @brief Applies gain and limiter and measures the written samples.
+    /// @param in Pointer to the input block.
+    /// @param out Pointer to the output block, must not alias the input.
+    /// @param frames Number of frames in the block.
+    /// @return Peak and RMS of the output block.
+    OutputLevels process(const float* in, float* out, std::size_t frames);
+
+    /// @brief Converts an amplitude to dB, clamped to the meter floor, so
+    /// silence never produces NaN or -inf.
+    /// @param amplitude The amplitude.
+    /// @param floorDb The lowest value returned. Defaults to -100.
+    /// @return The level in dB.
+    static int toDecibels(float amplitude, int floorDb = -100);
+};
+
+#endif // OUTPUT_STAGE_H
@@ -0,0 +1,99 @@
+#include "PerformanceMonitor.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+/// @brief Weight of the newest callback in the smoothed load.
+constexpr float kLoadSmoothing = 0.1f;
+} // namespace
+
+PerformanceMonitor::PerformanceMonitor() :
+    mBlockSeconds(0), mBlocks(0), mLoad(0), mPeakLoad(0), mXruns(0)
+{
+    for (auto& time : mBlockTimes) {
+        time.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PerformanceMonitor::reset(double blockSeconds)
+{
+    mBlockSeconds = blockSeconds;
+    mBlocks.store(0, std::memory_order_relaxed);
+    mLoad.store(0, std::memory_order_relaxed);
+    mPeakLoad.store(0, std::memory_order_relaxed);
+    mXruns.store(0, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::recordCallback(double seconds, double budgetSeconds,
+                                        bool xrun)
+{
+    if (xrun) {
+        mXruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (budgetSeconds <= 0) {
+        return;
+    }
+
+    float load = static_cast<float>(seconds / budgetSeconds);
+    float smoothed = mLoad.load(std::memory_order_relaxed);
+    mLoad.store(smoothed + kLoadSmoothing * (load - smoothed),
+                std::memory_order_relaxed);
+
+    // the reader clears the peak, so raise it with a compare exchange
+    float peak = mPeakLoad.load(std::memory_order_relaxed);
+    while (load > peak &&
+           !mPeakLoad.compare_exchange_weak(peak, load,
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+void PerformanceMonitor::recordBlock(double seconds)
+{
+    std::uint64_t blocks = mBlocks.load(std::memory_order_relaxed);
+    mBlockTimes[blocks % kWindow].store(static_cast<float>(seconds),
+                                        std::memory_order_relaxed);
+    mBlocks.store(blocks + 1, std::memory_order_release);
+}
+
+PerformanceStats PerformanceMonitor::snapshot()
+{
+    PerformanceStats stats;
+    stats.callbackLoad = mLoad.load(std::memory_order_relaxed);
+    stats.callbackPeakLoad = mPeakLoad.exchange(0, std::memory_order_relaxed);
+    stats.xruns = mXruns.load(std::memory_order_relaxed);
+    stats.blocks = mBlocks.load(std::memory_order_acquire);
+
+    // a slot may be overwritten while it is copied, which only mixes in a
+    // newer block time
+    std::size_t count =
+        static_cast<std::size_t>(std::min<std::uint64_t>(stats.blocks,
+                                                         kWindow));
+    if (count == 0) {
+        return stats;
+    }
+    std::array<float, kWindow> times;
+    for (std::size_t i = 0; i < count; ++i) {
+        times[i] = mBlockTimes[i].load(std::memory_order_relaxed);
+    }
+
+    auto percentile = [&times, count](double fraction)
+    {
+        std::size_t index = static_cast<std::size_t>(fraction * (count - 1));
+        std::nth_element(times.begin(), times.begin() + index,
+                         times.begin() + count);
+        return static_cast<double>(times[index]);
+    };
+    stats.blockP50 = percentile(0.5);
+    stats.blockP99 = percentile(0.99);
+
+    if (mBlockSeconds > 0) {
+        double mean =
+            std::accumulate(times.begin(), times.begin() + count, 0.0) /
+            count;
+        stats.realTimeFactor = mean / mBlockSeconds;
+    }
+
+    return stats;
+}
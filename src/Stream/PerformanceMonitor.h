@@ -0,0 +1,101 @@
+#ifndef PERFORMANCE_MONITOR_H
+#define PERFORMANCE_MONITOR_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Snapshot of the stream performance counters.
+struct PerformanceStats
+{
+    /// @brief Smoothed callback time divided by the callback duration.
+    double callbackLoad = 0;
+    /// @brief Highest callback load since the previous snapshot.
+    double callbackPeakLoad = 0;
+    /// @brief Median processing time of the recent blocks in seconds.
+    double blockP50 = 0;
+    /// @brief 99th percentile processing time of the recent blocks in
+    /// seconds.
+    double blockP99 = 0;
+    /// @brief Mean processing time of the recent blocks divided by the block
+    /// duration. Values near 1 mean the model barely keeps up.
+    double realTimeFactor = 0;
+    /// @brief Number of callbacks that reported an input or output underflow
+    /// or overflow.
+    std::uint64_t xruns = 0;
+    /// @brief Number of blocks processed since the stream was opened.
+    std::uint64_t blocks = 0;
+    /// @brief End-to-end latency in seconds, filled in by the stream.
+    double latency = 0;
+    /// @brief Processing tier of the governor as ProcessingTier value,
+    /// filled in by the stream.
+    int tier = 0;
+    /// @brief Flag to indicate that the shared memory sink is open, filled
+    /// in by the stream like the other sink counters.
+    bool sinkOpen = false;
+    /// @brief Number of processes reading the shared memory sink.
+    std::size_t sinkReaders = 0;
+    /// @brief Blocks the slowest sink reader is behind.
+    std::uint64_t sinkReaderLag = 0;
+    /// @brief Blocks the sink readers lost to overruns.
+    std::uint64_t sinkOverruns = 0;
+    /// @brief Flag to indicate that a recording runs, filled in by the
+    /// stream like the recording counters.
+    bool recording = false;
+    /// @brief Blocks written to the recording.
+    std::uint64_t recordedBlocks = 0;
+    /// @brief Blocks the recording lost because the disk fell behind.
+    std::uint64_t recordDropped = 0;
+};
+
+/// @brief The PerformanceMonitor class collects callback and block timings
+/// on the audio thread and hands out snapshots to one reader thread. Both
+/// sides only touch atomics, so polling the monitor adds no cost to the
+/// audio thread.
+class PerformanceMonitor
+{
+  public:
+    /// @brief Number of recent blocks the percentiles are computed over.
+    static constexpr std::size_t kWindow = 256;
+
+  private:
+    /// @brief Duration of one block in seconds.
+    double mBlockSeconds;
+    /// @brief Processing times of the recent blocks, used as a ring.
+    std::array<std::atomic<float>, kWindow> mBlockTimes;
+    /// @brief Number of blocks recorded.
+    std::atomic<std::uint64_t> mBlocks;
+    /// @brief Smoothed callback load.
+    std::atomic<float> mLoad;
+    /// @brief Highest callback load since the previous snapshot.
+    std::atomic<float> mPeakLoad;
+    /// @brief Number of callbacks with an xrun.
+    std::atomic<std::uint64_t> mXruns;
+
+  public:
+    /// @brief Constructor for the PerformanceMonitor class.
+    PerformanceMonitor();
+
+    /// @brief Clears all counters for a new stream. Must not be called while
+    /// the stream is running.
+    /// @param blockSeconds Duration of one block in seconds.
+    void reset(double blockSeconds);
+
+    /// @brief Records one callback. Audio thread only.
+    /// @param seconds Time spent in the callback.
+    /// @param budgetSeconds Duration of the audio in the callback.
+    /// @param xrun Flag to indicate that the host reported an xrun.
+    void recordCallback(double seconds, double budgetSeconds, bool xrun);
+
+    /// @brief Records the processing time of one block. Audio thread only.
+    /// @param seconds Time spent processing the block.
+    void recordBlock(double seconds);
+
+    /// @brief Returns the current counters and restarts the peak load. Meant
+    /// for a single polling thread.
+    /// @return The snapshot, without the latency.
+    PerformanceStats snapshot();
+};
+
+#endif // PERFORMANCE_MONITOR_H
@@ -0,0 +1,78 @@
+#include "SpectrumTap.h"
+
+#include <algorithm>
+
+SpectrumTap::SpectrumTap(std::size_t capacity) :
+    mHead(0), mTail(0), mEnabled(false), mDropped(0)
+{
+    std::size_t slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    mInput.assign(slots, 0.0f);
+    mOutput.assign(slots, 0.0f);
+    mMask = slots - 1;
+}
+
+void SpectrumTap::attach()
+{
+    // the reader owns the tail, skipping to the head drops stale samples
+    mTail.store(mHead.load(std::memory_order_acquire),
+                std::memory_order_release);
+    mEnabled.store(true, std::memory_order_release);
+}
+
+void SpectrumTap::detach()
+{
+    mEnabled.store(false, std::memory_order_release);
+}
+
+void SpectrumTap::push(const float* input, const float* output,
+                       std::size_t frames)
+{
+    if (!mEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::uint64_t head = mHead.load(std::memory_order_relaxed);
+    std::uint64_t used = head - mTail.load(std::memory_order_acquire);
+    if (used + frames > mMask + 1) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // at most two runs, before and after the end of the ring
+    std::size_t start = head & mMask;
+    std::size_t first = std::min(frames, mMask + 1 - start);
+    std::copy(input, input + first, mInput.begin() + start);
+    std::copy(output, output + first, mOutput.begin() + start);
+    std::copy(input + first, input + frames, mInput.begin());
+    std::copy(output + first, output + frames, mOutput.begin());
+    mHead.store(head + frames, std::memory_order_release);
+}
+
+std::size_t SpectrumTap::read(float* input, float* output,
+                              std::size_t maxFrames)
+{
+    std::uint64_t tail = mTail.load(std::memory_order_relaxed);
+    std::uint64_t head = mHead.load(std::memory_order_acquire);
+    auto frames = static_cast<std::size_t>(
+        std::min<std::uint64_t>(head - tail, maxFrames));
+
+    std::size_t start = tail & mMask;
+    std::size_t first = std::min(frames, mMask + 1 - start);
+    std::copy(mInput.begin() + start, mInput.begin() + start + first, input);
+    std::copy(mOutput.begin() + start, mOutput.begin() + start + first,
+              output);
+    std::copy(mInput.begin(), mInput.begin() + (frames - first),
+              input + first);
+    std::copy(mOutput.begin(), mOutput.begin() + (frames - first),
+              output + first);
+    mTail.store(tail + frames, std::memory_order_release);
+    return frames;
+}
+
+std::uint64_t SpectrumTap::dropped() const
+{
+    return mDropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+#ifndef SPECTRUM_TAP_H
+#define SPECTRUM_TAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Tap that hands the input and output samples of the audio thread
+/// to one analysis thread, for displays. The audio thread only copies the
+/// block into two preallocated rings; it never blocks, allocates or waits
+/// for the reader. A block that does not fit is dropped and counted, and
+/// while no reader is attached the push returns at once.
+class SpectrumTap
+{
+  private:
+    /// @brief Input samples, as a ring.
+    std::vector<float> mInput;
+    /// @brief Output samples, as a ring.
+    std::vector<float> mOutput;
+    /// @brief Capacity minus one, used to wrap the indices.
+    std::size_t mMask;
+    /// @brief Number of samples pushed, written by the audio thread only.
+    alignas(64) std::atomic<std::uint64_t> mHead;
+    /// @brief Number of samples read, written by the reader only.
+    alignas(64) std::atomic<std::uint64_t> mTail;
+
+    /// @brief Flag to indicate that a reader is attached.
+    std::atomic<bool> mEnabled;
+    /// @brief Number of blocks dropped because the reader fell behind.
+    std::atomic<std::uint64_t> mDropped;
+
+  public:
+    /// @brief Constructor for the SpectrumTap class, detached.
+    /// @param capacity Minimum number of samples buffered per side. Defaults
+    /// to 16384, a third of a second at 48 kHz.
+    explicit SpectrumTap(std::size_t capacity = 16384);
+
+    SpectrumTap(const SpectrumTap&) = delete;
+    SpectrumTap& operator=(const SpectrumTap&) = delete;
+
+    /// @brief Starts accepting blocks and discards what was buffered
+    /// before. Reader thread only.
+    void attach();
+
+    /// @brief Stops accepting blocks. A push in flight completes into the
+    /// ring and is discarded by the next attach.
+    void detach();
+
+    /// @brief Queues one block of input and output. Lock-free and
+    /// allocation-free, safe on the audio thread.
+    /// @param input Input samples, aligned with the output.
+    /// @param output Output samples.
+    /// @param frames Number of samples.
+    void push(const float* input, const float* output, std::size_t frames);
+
+    /// @brief Takes the oldest queued samples. Reader thread only.
+    /// @param input Receives the input samples.
+    /// @param output Receives the output samples.
+    /// @param maxFrames Capacity of both buffers.
+    /// @return Number of samples read, 0 if the tap is empty.
+    std::size_t read(float* input, float* output, std::size_t maxFrames);
+
+    /// @brief Returns the number of blocks dropped since construction.
+    /// @return The drop count.
+    std::uint64_t dropped() const;
+};
+
+#endif // SPECTRUM_TAP_H
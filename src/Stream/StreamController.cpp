@@ -0,0 +1,200 @@
+#include "StreamController.h"
+
+#include <algorithm>
+#include <chrono>
+
+StreamController::StreamController(AudioStream& stream, QObject* parent) :
+    QObject(parent), mStream(stream), mStop(false),
+    mOpen(stream.isStreamOpen())
+{
+    mWorker = std::thread(&StreamController::work, this);
+}
+
+StreamController::~StreamController()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCommands.clear();
+        mStop = true;
+    }
+    mWake.notify_one();
+    mWorker.join();
+}
+
+void StreamController::openStream(int deviceId)
+{
+    StreamCommand command;
+    command.type = StreamCommandType::Open;
+    command.deviceId = deviceId;
+    post(command);
+}
+
+void StreamController::closeStream()
+{
+    StreamCommand command;
+    command.type = StreamCommandType::Close;
+    post(command);
+}
+
+void StreamController::setRealTimeMode(bool status)
+{
+    StreamCommand command;
+    command.type = StreamCommandType::SetRealTimeMode;
+    command.enabled = status;
+    post(command);
+}
+
+void StreamController::setSpectralKalman(StagePlacement placement)
+{
+    StreamCommand command;
+    command.type = StreamCommandType::SetSpectralKalman;
+    command.placement = placement;
+    post(command);
+}
+
+void StreamController::setReduceNoise(bool status)
+{
+    StreamCommand command;
+    command.type = StreamCommandType::SetReduceNoise;
+    command.enabled = status;
+    post(command);
+}
+
+void StreamController::openSharedSink(const std::string& name)
+{
+    StreamCommand command;
+    command.type = StreamCommandType::OpenSharedSink;
+    command.sinkName = name;
+    post(command);
+}
+
+void StreamController::startRecording(const RecorderOptions& options)
+{
+    StreamCommand command;
+    command.type = StreamCommandType::StartRecording;
+    command.recording = options;
+    post(command);
+}
+
+bool StreamController::isStreamOpen() const
+{
+    return mOpen.load();
+}
+
+bool StreamController::tryGetPerformanceStats(PerformanceStats& stats)
+{
+    std::unique_lock<std::mutex> lock(mStreamMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !mStream.isStreamOpen()) {
+        return false;
+    }
+    stats = mStream.getPerformanceStats();
+    return true;
+}
+
+void StreamController::post(const StreamCommand& command)
+{
+    auto isDevice = [](StreamCommandType type) {
+        return type == StreamCommandType::Open ||
+               type == StreamCommandType::Close;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // only the last device selection and the last value of a setting
+        // matter, the order between the survivors is kept
+        bool device = isDevice(command.type);
+        mCommands.erase(
+            std::remove_if(mCommands.begin(), mCommands.end(),
+                           [&](const StreamCommand& pending) {
+                               return device ? isDevice(pending.type)
+                                             : pending.type == command.type;
+                           }),
+            mCommands.end());
+        mCommands.push_back(command);
+    }
+    mWake.notify_one();
+}
+
+bool StreamController::hasPendingDeviceCommand()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return std::any_of(mCommands.begin(), mCommands.end(),
+                       [](const StreamCommand& pending) {
+                           return pending.type == StreamCommandType::Open ||
+                                  pending.type == StreamCommandType::Close;
+                       });
+}
+
+void StreamController::work()
+{
+    RTNR_TRACE_THREAD("stream_controller");
+    while (true) {
+        StreamCommand command;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait(lock, [this]() { return mStop || !mCommands.empty(); });
+            if (mStop) {
+                return;
+            }
+            command = mCommands.front();
+            mCommands.pop_front();
+        }
+        execute(command);
+    }
+}
+
+void StreamController::execute(const StreamCommand& command)
+{
+    RTNR_TRACE_SCOPE("stream_command");
+    auto start = std::chrono::steady_clock::now();
+    bool opened = false;
+    {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        switch (command.type) {
+            case StreamCommandType::Open:
+                opened = mStream.openStream(command.deviceId);
+                break;
+            case StreamCommandType::Close:
+                mStream.closeStream();
+                break;
+            case StreamCommandType::SetRealTimeMode:
+                mStream.setRealTimeMode(command.enabled);
+                break;
+            case StreamCommandType::SetSpectralKalman:
+                mStream.setSpectralKalman(command.placement);
+                break;
+            case StreamCommandType::SetReduceNoise:
+                mStream.setReduceNoise(command.enabled);
+                break;
+            case StreamCommandType::OpenSharedSink:
+                mStream.openSharedSink(command.sinkName);
+                break;
+            case StreamCommandType::StartRecording:
+                mStream.startRecording(command.recording);
+                break;
+        }
+        mOpen.store(mStream.isStreamOpen());
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (command.type == StreamCommandType::Open) {
+        Log::write(LogLevel::Info, "Stream open on device %d took %.1f ms",
+                   command.deviceId, elapsed.count());
+    } else if (command.type == StreamCommandType::Close) {
+        Log::write(LogLevel::Info, "Stream close took %.1f ms",
+                   elapsed.count());
+    } else {
+        return;
+    }
+
+    // a queued open or close makes this result stale, it reports instead
+    if (hasPendingDeviceCommand()) {
+        return;
+    }
+    if (command.type == StreamCommandType::Open) {
+        emit streamOpened(command.deviceId, opened);
+    } else {
+        emit streamClosed();
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef STREAM_CONTROLLER_H
+#define STREAM_CONTROLLER_H
+
+#include <QObject>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "AudioStream.h"
+
+/// @brief Kind of a command for the stream controller.
+enum class StreamCommandType
+{
+    /// @brief Open the stream on a device, closing the current one first.
+    Open,
+    /// @brief Close the stream.
+    Close,
+    /// @brief Request or drop the real-time mode for the next open.
+    SetRealTimeMode,
+    /// @brief Place the per-bin Kalman filter for the next open.
+    SetSpectralKalman,
+    /// @brief Turn the noise reduction on or off.
+    SetReduceNoise,
+    /// @brief Publish the output to shared memory from the next open.
+    OpenSharedSink,
+    /// @brief Record the input and the output to disk.
+    StartRecording
+};
+
+/// @brief One queued command for the stream controller.
+struct StreamCommand
+{
+    /// @brief What to do.
+    StreamCommandType type;
+    /// @brief Device to open, for Open.
+    int deviceId = 0;
+    /// @brief Requested state, for SetRealTimeMode and SetReduceNoise.
+    bool enabled = false;
+    /// @brief Requested placement, for SetSpectralKalman.
+    StagePlacement placement = StagePlacement::Off;
+    /// @brief Name of the shared memory, for OpenSharedSink.
+    std::string sinkName;
+    /// @brief Recording settings, for StartRecording.
+    RecorderOptions recording;
+};
+
+/// @brief The StreamController class moves the slow device work of an
+/// AudioStream off the GUI thread. Opening and stopping a PortAudio stream
+/// can take hundreds of milliseconds, so the GUI only queues commands and a
+/// controller thread runs them in order, reporting back through queued
+/// signals. Device commands coalesce: a new open or close replaces any that
+/// has not started yet, so a quick series of selections opens only the last
+/// device, and a result that is already superseded is not reported. Setting
+/// commands replace a pending one of the same kind. Counters are read with a
+/// try-lock, so polling never waits for a command either.
+class StreamController : public QObject
+{
+    Q_OBJECT
+
+  private:
+    /// @brief The controlled stream, owned by the caller.
+    AudioStream& mStream;
+
+    /// @brief Commands not started yet.
+    std::deque<StreamCommand> mCommands;
+    /// @brief Guards mCommands and mStop.
+    std::mutex mMutex;
+    /// @brief Wakes the controller thread on a command or on stop.
+    std::condition_variable mWake;
+    /// @brief Flag to tell the controller thread to finish.
+    bool mStop;
+
+    /// @brief Held while a command runs on the stream.
+    std::mutex mStreamMutex;
+    /// @brief Flag to indicate that the stream is open, for the GUI.
+    std::atomic<bool> mOpen;
+
+    /// @brief Thread that runs the commands.
+    std::thread mWorker;
+
+    /// @brief Queues a command, replacing the pending ones it supersedes.
+    /// @param command The command.
+    void post(const StreamCommand& command);
+    /// @brief Body of the controller thread.
+    void work();
+    /// @brief Runs one command on the stream.
+    /// @param command The command.
+    void execute(const StreamCommand& command);
+    /// @brief Checks whether an open or close is queued.
+    /// @return True if a device command is pending.
+    bool hasPendingDeviceCommand();
+
+  public:
+    /// @brief Constructor for the StreamController class, starts the
+    /// controller thread.
+    /// @param stream The controlled stream, must outlive the controller.
+    /// @param parent The parent object. Defaults to nullptr.
+    StreamController(AudioStream& stream, QObject* parent = nullptr);
+    /// @brief Destructor for the StreamController class. Finishes the
+    /// running command and drops the pending ones.
+    ~StreamController();
+
+    StreamController(const StreamController&) = delete;
+    StreamController& operator=(const StreamController&) = delete;
+
+    /// @brief Queues opening the stream on a device, which closes the
+    /// current stream first.
+    /// @param deviceId The device ID.
+    void openStream(int deviceId);
+    /// @brief Queues closing the stream.
+    void closeStream();
+    /// @brief Queues requesting the real-time mode for the next open.
+    /// @param status Boolean to set.
+    void setRealTimeMode(bool status);
+    /// @brief Queues placing the per-bin Kalman filter for the next open.
+    /// @param placement Where the filter runs, Off to remove it.
+    void setSpectralKalman(StagePlacement placement);
+    /// @brief Queues turning the noise reduction on or off.
+    /// @param status Boolean to set.
+    void setReduceNoise(bool status);
+    /// @brief Queues publishing the output to shared memory. A failure is
+    /// logged by the stream.
+    /// @param name Name of the shared memory.
+    void openSharedSink(const std::string& name);
+    /// @brief Queues starting a recording. A failure is logged by the
+    /// recorder.
+    /// @param options File, rotation and buffer settings.
+    void startRecording(const RecorderOptions& options);
+
+    /// @brief Function to check whether the stream is open, as of the last
+    /// finished command.
+    /// @return True if the stream is open.
+    bool isStreamOpen() const;
+    /// @brief Function to read the performance counters without waiting for
+    /// a running command.
+    /// @param stats Receives the counters.
+    /// @return False if a command runs or no stream is open.
+    bool tryGetPerformanceStats(PerformanceStats& stats);
+
+  signals:
+    /// @brief The custom signal emitted when an open finished and no other
+    /// device command is queued.
+    /// @param deviceId The device ID.
+    /// @param opened Flag to indicate that the stream was opened and
+    /// started.
+    void streamOpened(int deviceId, bool opened);
+    /// @brief The custom signal emitted when a close finished and no other
+    /// device command is queued.
+    void streamClosed();
+};
+
+#endif // STREAM_CONTROLLER_H
@@ -0,0 +1,208 @@
+#include "VirtualDevice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "sndfile.h"
+
+#include "../Util/Log.h"
+
+namespace
+{
+/// @brief Seed of the jitter, fixed so that runs are repeatable.
+constexpr unsigned kJitterSeed = 42;
+} // namespace
+
+std::string VirtualRunReport::toString() const
+{
+    if (!ok) {
+        return "Virtual device run failed\n";
+    }
+
+    std::ostringstream out;
+    out << "Virtual device report:\n";
+    out << "  audio / wall time:   " << audioSeconds << " s / " << wallSeconds
+        << " s\n";
+    out << "  throughput:          " << throughput << "x real time\n";
+    out << "  callbacks:           " << callbacks << ", " << lateCallbacks
+        << " late\n";
+    out << "  callback p50 / p99:  " << callbackP50 * 1000 << " ms / "
+        << callbackP99 * 1000 << " ms, max " << callbackMax * 1000 << " ms\n";
+    out << "  block p50 / p99:     " << blockP50 * 1000 << " ms / "
+        << blockP99 * 1000 << " ms\n";
+    return out.str();
+}
+
+VirtualDevice::VirtualDevice(const VirtualDeviceOptions& options,
+                             int sampleRate, std::size_t latency) :
+    mOptions(options), mSampleRate(sampleRate), mLatency(latency), mFrames(0)
+{
+    mOptions.framesPerBuffer = std::max(mOptions.framesPerBuffer, 1ul);
+}
+
+bool VirtualDevice::load()
+{
+    SF_INFO info = {};
+    SNDFILE* file = sf_open(mOptions.inputPath.c_str(), SFM_READ, &info);
+    if (file == nullptr) {
+        Log::write(LogLevel::Error, "Error opening input file %s: %s",
+                   mOptions.inputPath, sf_strerror(file));
+        return false;
+    }
+    if (info.samplerate != mSampleRate) {
+        Log::write(LogLevel::Error, "Input file %s has %d Hz, expected %d Hz",
+                   mOptions.inputPath, info.samplerate, mSampleRate);
+        sf_close(file);
+        return false;
+    }
+
+    std::vector<float> interleaved(static_cast<std::size_t>(info.frames) *
+                                   info.channels);
+    mFrames = static_cast<std::size_t>(
+        sf_readf_float(file, interleaved.data(), info.frames));
+    sf_close(file);
+
+    // the first channel, followed by silence that flushes the latency and
+    // padded to whole buffers
+    std::size_t buffers =
+        (mFrames + mLatency + mOptions.framesPerBuffer - 1) /
+        mOptions.framesPerBuffer;
+    mInput.assign(buffers * mOptions.framesPerBuffer, 0.0f);
+    for (std::size_t i = 0; i < mFrames; ++i) {
+        mInput[i] = interleaved[i * info.channels];
+    }
+    mOutput.assign(mInput.size(), 0.0f);
+    mTimings.assign(buffers, 0.0);
+    return true;
+}
+
+bool VirtualDevice::save() const
+{
+    SF_INFO info = {};
+    info.samplerate = mSampleRate;
+    info.channels = 1;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE* file = sf_open(mOptions.outputPath.c_str(), SFM_WRITE, &info);
+    if (file == nullptr) {
+        Log::write(LogLevel::Error, "Error opening output file %s: %s",
+                   mOptions.outputPath, sf_strerror(file));
+        return false;
+    }
+    // the lead of the output is the latency, dropped to line up with input
+    sf_count_t written =
+        sf_writef_float(file, mOutput.data() + mLatency, mFrames);
+    sf_close(file);
+    if (written != static_cast<sf_count_t>(mFrames)) {
+        Log::write(LogLevel::Error, "Error writing output file %s",
+                   mOptions.outputPath);
+        return false;
+    }
+
+    if (mOptions.timingsPath.empty()) {
+        return true;
+    }
+    std::ofstream timings(mOptions.timingsPath);
+    timings << "callback,seconds\n";
+    for (std::size_t i = 0; i < mTimings.size(); ++i) {
+        timings << i << "," << mTimings[i] << "\n";
+    }
+    if (!timings) {
+        Log::write(LogLevel::Error, "Error writing timings file %s",
+                   mOptions.timingsPath);
+        return false;
+    }
+    return true;
+}
+
+void VirtualDevice::drive(PaStreamCallback* callback, void* userData,
+                          VirtualRunReport& report)
+{
+    using Clock = std::chrono::steady_clock;
+    const unsigned long frames = mOptions.framesPerBuffer;
+    const std::chrono::duration<double> period(static_cast<double>(frames) /
+                                               mSampleRate);
+    std::mt19937 random(kJitterSeed);
+    std::uniform_real_distribution<double> jitter(0.0,
+                                                  mOptions.jitterMs / 1000);
+
+    PaStreamCallbackFlags flags = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < mTimings.size(); ++i) {
+        auto deadline =
+            start + std::chrono::duration_cast<Clock::duration>((i + 1) *
+                                                                period);
+        if (mOptions.pacing == VirtualPacing::RealTime) {
+            // a device asks for a buffer once the previous one has played
+            auto wake = deadline - period +
+                        std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>(jitter(random)));
+            std::this_thread::sleep_until(wake);
+        }
+
+        auto callbackStart = Clock::now();
+        PaStreamCallbackTimeInfo timeInfo;
+        timeInfo.currentTime =
+            std::chrono::duration<double>(callbackStart - start).count();
+        timeInfo.inputBufferAdcTime = timeInfo.currentTime;
+        timeInfo.outputBufferDacTime = timeInfo.currentTime + period.count();
+
+        int result = callback(&mInput[i * frames], &mOutput[i * frames],
+                              frames, &timeInfo, flags, userData);
+        auto callbackEnd = Clock::now();
+        mTimings[i] =
+            std::chrono::duration<double>(callbackEnd - callbackStart).count();
+        ++report.callbacks;
+
+        // a late buffer underflows the output, the device says so next time
+        flags = 0;
+        bool late = mOptions.pacing == VirtualPacing::RealTime
+                        ? callbackEnd > deadline
+                        : mTimings[i] > period.count();
+        if (late) {
+            ++report.lateCallbacks;
+            if (mOptions.pacing == VirtualPacing::RealTime) {
+                flags = paOutputUnderflow;
+            }
+        }
+        if (result != paContinue) {
+            break;
+        }
+    }
+    report.wallSeconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+VirtualRunReport VirtualDevice::run(PaStreamCallback* callback,
+                                    void* userData)
+{
+    VirtualRunReport report;
+    if (!load()) {
+        return report;
+    }
+
+    // the callback gets a thread of its own, as with a real device
+    std::thread device([&]() { drive(callback, userData, report); });
+    device.join();
+
+    report.audioSeconds =
+        static_cast<double>(report.callbacks * mOptions.framesPerBuffer) /
+        mSampleRate;
+    if (report.wallSeconds > 0) {
+        report.throughput = report.audioSeconds / report.wallSeconds;
+    }
+    if (report.callbacks > 0) {
+        std::vector<double> sorted(mTimings.begin(),
+                                   mTimings.begin() + report.callbacks);
+        std::sort(sorted.begin(), sorted.end());
+        report.callbackP50 = sorted[(sorted.size() - 1) / 2];
+        report.callbackP99 = sorted[(sorted.size() - 1) * 99 / 100];
+        report.callbackMax = sorted.back();
+    }
+
+    report.ok = save();
+    return report;
+}
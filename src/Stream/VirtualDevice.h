@@ -0,0 +1,127 @@
+#ifndef VIRTUAL_DEVICE_H
+#define VIRTUAL_DEVICE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <portaudio.h>
+
+/// @brief How the virtual device schedules its callbacks.
+enum class VirtualPacing
+{
+    /// @brief One buffer per buffer duration, like a sound card.
+    RealTime,
+    /// @brief Every buffer as soon as the previous callback returns.
+    Fast
+};
+
+/// @brief Settings of a virtual device run.
+struct VirtualDeviceOptions
+{
+    /// @brief WAV file fed as input, the first channel is used.
+    std::string inputPath;
+    /// @brief Mono file the output is written to.
+    std::string outputPath;
+    /// @brief Optional CSV file receiving the time of every callback.
+    std::string timingsPath;
+    /// @brief Frames per callback, like the buffer size of a device.
+    unsigned long framesPerBuffer = 512;
+    /// @brief Callback scheduling.
+    VirtualPacing pacing = VirtualPacing::RealTime;
+    /// @brief Largest random delay of a callback in real-time pacing, in
+    /// milliseconds, to emulate a scheduler that wakes the driver late.
+    double jitterMs = 0;
+};
+
+/// @brief Result of a virtual device run.
+struct VirtualRunReport
+{
+    /// @brief Flag to indicate that the files were read and written.
+    bool ok = false;
+    /// @brief Number of callbacks.
+    std::size_t callbacks = 0;
+    /// @brief Duration of the fed audio in seconds.
+    double audioSeconds = 0;
+    /// @brief Wall-clock duration of the run in seconds.
+    double wallSeconds = 0;
+    /// @brief Audio seconds processed per wall-clock second.
+    double throughput = 0;
+    /// @brief Median callback time in seconds.
+    double callbackP50 = 0;
+    /// @brief 99th percentile callback time in seconds.
+    double callbackP99 = 0;
+    /// @brief Longest callback time in seconds.
+    double callbackMax = 0;
+    /// @brief Callbacks that returned after the next buffer was due. In
+    /// real-time pacing the following callback reports an output underflow.
+    std::size_t lateCallbacks = 0;
+    /// @brief Median model block time in seconds, filled in by the stream.
+    double blockP50 = 0;
+    /// @brief 99th percentile model block time in seconds, filled in by the
+    /// stream.
+    double blockP99 = 0;
+
+    /// @brief Function to format the report.
+    /// @return The report as human readable multi-line text.
+    std::string toString() const;
+};
+
+/// @brief The VirtualDevice class stands in for a PortAudio device. It reads
+/// a WAV file and drives a stream callback with it on a callback thread of
+/// its own, with the same arguments a device passes, paced to real time or
+/// as fast as possible, and writes what the callback produces to a file.
+/// The input is followed by silence for the latency of the callback and the
+/// same number of frames is dropped from the head of the output, so the
+/// output lines up with the input.
+/// Both files are held in memory during the run so that disk access never
+/// shows up in the timings.
+class VirtualDevice
+{
+  private:
+    /// @brief Settings of the run.
+    VirtualDeviceOptions mOptions;
+    /// @brief Sample rate the callback expects.
+    int mSampleRate;
+    /// @brief Algorithmic latency of the callback in frames.
+    std::size_t mLatency;
+    /// @brief The input and the latency flush, padded to whole buffers.
+    std::vector<float> mInput;
+    /// @brief The output, as long as the padded input.
+    std::vector<float> mOutput;
+    /// @brief Number of frames in the input file.
+    std::size_t mFrames;
+    /// @brief Time of every callback in seconds.
+    std::vector<double> mTimings;
+
+    /// @brief Reads the input file.
+    /// @return False if it cannot be read or has another sample rate.
+    bool load();
+    /// @brief Writes the output file and the optional timings.
+    /// @return False if a file cannot be written.
+    bool save() const;
+    /// @brief Runs the callbacks on the calling thread.
+    /// @param callback The stream callback.
+    /// @param userData User data passed to the callback.
+    /// @param report Receives the counters.
+    void drive(PaStreamCallback* callback, void* userData,
+               VirtualRunReport& report);
+
+  public:
+    /// @brief Constructor for the VirtualDevice class.
+    /// @param options Settings of the run.
+    /// @param sampleRate Sample rate the callback expects.
+    /// @param latency Algorithmic latency of the callback in frames.
+    /// Defaults to 0.
+    VirtualDevice(const VirtualDeviceOptions& options, int sampleRate,
+                  std::size_t latency = 0);
+
+    /// @brief Feeds the whole input file through a callback and writes the
+    /// output. Blocks until the run is complete.
+    /// @param callback The stream callback, as given to Pa_OpenStream.
+    /// @param userData User data passed to the callback.
+    /// @return The report, not ok if a file cannot be read or written.
+    VirtualRunReport run(PaStreamCallback* callback, void* userData);
+};
+
+#endif // VIRTUAL_DEVICE_H
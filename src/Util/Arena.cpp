@@ -0,0 +1,62 @@
+#include "Arena.h"
+
+#include <cstdint>
+
+#include "RealTime.h"
+
+Arena::Arena(std::size_t capacity) :
+    mBase(nullptr), mCapacity(0), mOffset(0), mHighWaterMark(0)
+{
+    reserve(capacity);
+}
+
+void Arena::reserve(std::size_t capacity)
+{
+    mStorage.assign(capacity + kAlignment, 0);
+
+    // align the base to the cache line
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(mStorage.data());
+    std::size_t padding = (kAlignment - address % kAlignment) % kAlignment;
+    mBase = mStorage.data() + padding;
+
+    mCapacity = capacity;
+    reset();
+}
+
+std::size_t Arena::mark() const
+{
+    return mOffset;
+}
+
+void Arena::rewind(std::size_t mark)
+{
+    if (mark <= mOffset) {
+        mOffset = mark;
+    }
+}
+
+void Arena::reset()
+{
+    mOffset = 0;
+    mHighWaterMark = 0;
+}
+
+std::size_t Arena::capacity() const
+{
+    return mCapacity;
+}
+
+std::size_t Arena::used() const
+{
+    return mOffset;
+}
+
+std::size_t Arena::highWaterMark() const
+{
+    return mHighWaterMark;
+}
+
+std::size_t Arena::prefault()
+{
+    return RealTime::prefault(mBase, mCapacity);
+}
@@ -0,0 +1,125 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/// @brief Linear allocator for the scratch memory of one stream or job. The
+/// arena is sized once when the stream is configured and hands out cache
+/// line aligned blocks by bumping an offset, so the audio thread never calls
+/// the system allocator. Allocations are released all at once with rewind,
+/// which makes per-block scratch free.
+class Arena
+{
+  private:
+    /// @brief Raw storage, over-allocated by one alignment unit.
+    std::vector<unsigned char> mStorage;
+    /// @brief Aligned start of the usable storage.
+    unsigned char* mBase;
+    /// @brief Usable capacity in bytes.
+    std::size_t mCapacity;
+    /// @brief Offset of the next free byte.
+    std::size_t mOffset;
+    /// @brief Largest offset ever reached.
+    std::size_t mHighWaterMark;
+
+  public:
+    /// @brief Alignment of every allocation: one cache line, which also
+    /// covers every SIMD register width.
+    static constexpr std::size_t kAlignment = 64;
+
+    /// @brief Constructor for the Arena class.
+    /// @param capacity Usable capacity in bytes. Defaults to 0.
+    Arena(std::size_t capacity = 0);
+
+    /// @brief Returns the arena space an allocation takes.
+    /// @tparam T The element type.
+    /// @param count The number of elements.
+    /// @return The size in bytes, rounded up to the alignment.
+    template <typename T>
+    static constexpr std::size_t bytesFor(std::size_t count)
+    {
+        return (count * sizeof(T) + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    /// @brief Replaces the storage with a new one and frees everything.
+    /// Must not be called while the stream is running.
+    /// @param capacity Usable capacity in bytes.
+    void reserve(std::size_t capacity);
+
+    /// @brief Allocates an aligned, uninitialized array.
+    /// @tparam T The element type, must be trivially destructible.
+    /// @param count The number of elements.
+    /// @return Pointer to the array.
+    /// @throws std::bad_alloc If the arena is exhausted, which means a user
+    /// declared less memory than it takes.
+    template <typename T>
+    T* allocate(std::size_t count);
+
+    /// @brief Returns the current offset, to be passed to rewind later.
+    /// @return The current offset.
+    std::size_t mark() const;
+
+    /// @brief Frees everything allocated after the given mark.
+    /// @param mark A value returned by mark.
+    void rewind(std::size_t mark);
+
+    /// @brief Frees all allocations and clears the high-water mark.
+    void reset();
+
+    /// @brief Returns the usable capacity.
+    /// @return The capacity in bytes.
+    std::size_t capacity() const;
+
+    /// @brief Returns the number of bytes in use.
+    /// @return The used size in bytes.
+    std::size_t used() const;
+
+    /// @brief Returns the largest number of bytes ever in use.
+    /// @return The high-water mark in bytes.
+    std::size_t highWaterMark() const;
+
+    /// @brief Touches the whole storage so the audio thread never page
+    /// faults on it.
+    /// @return Number of bytes touched.
+    std::size_t prefault();
+};
+
+template <typename T>
+T* Arena::allocate(std::size_t count)
+{
+    std::size_t bytes = bytesFor<T>(count);
+    if (mOffset + bytes > mCapacity) {
+        throw std::bad_alloc();
+    }
+
+    T* data = reinterpret_cast<T*>(mBase + mOffset);
+    mOffset += bytes;
+    if (mOffset > mHighWaterMark) {
+        mHighWaterMark = mOffset;
+    }
+    return data;
+}
+
+/// @brief Scope that rewinds an arena to the offset it had on construction.
+class ArenaScope
+{
+  private:
+    /// @brief The arena.
+    Arena& mArena;
+    /// @brief The offset on construction.
+    std::size_t mMark;
+
+  public:
+    /// @brief Constructor for the ArenaScope class.
+    /// @param arena The arena to rewind on destruction.
+    ArenaScope(Arena& arena) : mArena(arena), mMark(arena.mark()) {}
+    /// @brief Destructor, frees everything allocated in the scope.
+    ~ArenaScope() { mArena.rewind(mMark); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+#endif // ARENA_H
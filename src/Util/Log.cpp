@@ -0,0 +1,298 @@
+#include "Log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "MpscRing.h"
+#include "Trace.h"
+
+namespace
+{
+/// @brief Records queued between two writer passes.
+constexpr std::size_t kRingCapacity = 1 << 12;
+/// @brief Interval between two passes of the writer.
+constexpr std::chrono::milliseconds kWriteInterval(20);
+
+/// @brief Shared state of the log.
+struct Logger
+{
+    Logger() : ring(kRingCapacity), level(LogLevel::Info), dropped(0) {}
+
+    MpscRing<LogRecord> ring;
+    std::atomic<LogLevel> level;
+    std::atomic<std::uint64_t> dropped;
+
+    /// @brief Guards the writer thread and the output.
+    std::mutex mutex;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::FILE* output = nullptr;
+    std::uint64_t reportedDrops = 0;
+};
+
+/// @brief The logger, created before main so that no real-time thread pays
+/// for its construction.
+Logger gLogger;
+
+const char* levelName(LogLevel level)
+{
+    switch (level) {
+        case LogLevel::Debug:
+            return "debug";
+        case LogLevel::Info:
+            return "info";
+        case LogLevel::Warning:
+            return "warning";
+        case LogLevel::Error:
+            return "error";
+    }
+    return "";
+}
+
+/// @brief Writes every queued record. The logger mutex must be held.
+void drain(Logger& logger)
+{
+    std::FILE* output = logger.output != nullptr ? logger.output : stderr;
+    LogRecord record;
+    while (logger.ring.pop(record)) {
+        std::fprintf(output, "%s\n", Log::format(record).c_str());
+    }
+
+    std::uint64_t dropped = logger.dropped.load(std::memory_order_relaxed);
+    if (dropped != logger.reportedDrops) {
+        std::fprintf(output, "%llu log records dropped, ring full\n",
+                     static_cast<unsigned long long>(dropped -
+                                                     logger.reportedDrops));
+        logger.reportedDrops = dropped;
+    }
+    std::fflush(output);
+}
+
+/// @brief Appends one conversion of a format to a line.
+/// @param line The line.
+/// @param spec The conversion with flags, width and precision but without
+/// length modifiers.
+/// @param conversion The conversion character.
+/// @param arg The argument.
+/// @param record The record holding the copied strings.
+void appendConversion(std::string& line, std::string spec, char conversion,
+                      const LogArg& arg, const LogRecord& record)
+{
+    // convert the stored value to what the conversion expects
+    long long integer = arg.i;
+    double real = arg.d;
+    switch (arg.type) {
+        case LogArg::Type::Int:
+            real = static_cast<double>(arg.i);
+            break;
+        case LogArg::Type::Unsigned:
+            integer = static_cast<long long>(arg.u);
+            real = static_cast<double>(arg.u);
+            break;
+        case LogArg::Type::Double:
+            integer = static_cast<long long>(arg.d);
+            break;
+        case LogArg::Type::Text:
+            integer = 0;
+            real = 0;
+            break;
+    }
+
+    char buffer[256];
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec += "ll";
+            spec += conversion;
+            std::snprintf(buffer, sizeof(buffer), spec.c_str(), integer);
+            break;
+        case 'c':
+            spec += conversion;
+            std::snprintf(buffer, sizeof(buffer), spec.c_str(),
+                          static_cast<int>(integer));
+            break;
+        case 's':
+            spec += conversion;
+            if (arg.type == LogArg::Type::Text) {
+                std::snprintf(buffer, sizeof(buffer), spec.c_str(),
+                              record.text + arg.text);
+            } else if (arg.type == LogArg::Type::Double) {
+                std::snprintf(buffer, sizeof(buffer), "%g", real);
+            } else {
+                std::snprintf(buffer, sizeof(buffer), "%lld", integer);
+            }
+            break;
+        default:
+            spec += conversion;
+            std::snprintf(buffer, sizeof(buffer), spec.c_str(), real);
+            break;
+    }
+    line += buffer;
+}
+} // namespace
+
+bool LogRateLimit::allow(std::uint32_t& suppressed)
+{
+    std::int64_t now = Trace::now();
+    std::int64_t next = mNext.load(std::memory_order_relaxed);
+    if (now < next ||
+        !mNext.compare_exchange_strong(next, now + mInterval,
+                                       std::memory_order_relaxed)) {
+        mSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = mSuppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+void Log::push(LogRecord& record)
+{
+    record.time = Trace::now();
+    if (!gLogger.ring.push(record)) {
+        gLogger.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Log::addText(LogRecord& record, const char* text)
+{
+    // a string that does not fit is cut, one that finds no room is empty
+    std::size_t offset = record.textUsed;
+    if (offset == LogRecord::kTextBytes) {
+        offset = LogRecord::kTextBytes - 1;
+    }
+    std::size_t used = offset;
+    while (text != nullptr && *text != '\0' &&
+           used + 1 < LogRecord::kTextBytes) {
+        record.text[used++] = *text++;
+    }
+    record.text[used++] = '\0';
+
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::Type::Text;
+    arg.text = static_cast<std::uint16_t>(offset);
+    record.textUsed = static_cast<std::uint16_t>(used);
+}
+
+bool Log::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(gLogger.mutex);
+    if (gLogger.running) {
+        return true;
+    }
+
+    bool opened = true;
+    if (!path.empty()) {
+        gLogger.output = std::fopen(path.c_str(), "a");
+        opened = gLogger.output != nullptr;
+    }
+
+    gLogger.running = true;
+    gLogger.writer = std::thread([]() {
+        RTNR_TRACE_THREAD("log_writer");
+        while (gLogger.running) {
+            {
+                std::lock_guard<std::mutex> lock(gLogger.mutex);
+                drain(gLogger);
+            }
+            std::this_thread::sleep_for(kWriteInterval);
+        }
+    });
+
+    if (!opened) {
+        write(LogLevel::Error, "Cannot open log file %s, using stderr",
+              path);
+    }
+    return opened;
+}
+
+void Log::stop()
+{
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(gLogger.mutex);
+        gLogger.running = false;
+        writer.swap(gLogger.writer);
+    }
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    std::lock_guard<std::mutex> lock(gLogger.mutex);
+    drain(gLogger);
+    if (gLogger.output != nullptr) {
+        std::fclose(gLogger.output);
+        gLogger.output = nullptr;
+    }
+}
+
+void Log::setLevel(LogLevel level)
+{
+    gLogger.level.store(level, std::memory_order_relaxed);
+}
+
+bool Log::enabled(LogLevel level)
+{
+    return level >= gLogger.level.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Log::dropped()
+{
+    return gLogger.dropped.load(std::memory_order_relaxed);
+}
+
+std::string Log::format(const LogRecord& record)
+{
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "[%10.3f] %s: ",
+                  record.time * 1e-9, levelName(record.level));
+    std::string line = prefix;
+
+    std::size_t nextArg = 0;
+    for (const char* c = record.format; *c != '\0'; ++c) {
+        if (*c != '%') {
+            line += *c;
+            continue;
+        }
+        if (c[1] == '%') {
+            line += '%';
+            ++c;
+            continue;
+        }
+
+        // flags, width and precision are kept, length modifiers are
+        // replaced to match the stored type
+        std::string spec = "%";
+        const char* end = c + 1;
+        while (*end != '\0' && std::strchr("-+ #0123456789.", *end)) {
+            spec += *end++;
+        }
+        while (*end != '\0' && std::strchr("hljztL", *end)) {
+            ++end;
+        }
+        if (*end == '\0') {
+            line += c;
+            break;
+        }
+
+        if (nextArg < record.argCount) {
+            appendConversion(line, spec, *end, record.args[nextArg++],
+                             record);
+        } else {
+            line.append(c, end + 1);
+        }
+        c = end;
+    }
+
+    if (record.suppressed > 0) {
+        line += " (" + std::to_string(record.suppressed) +
+                " similar suppressed)";
+    }
+    return line;
+}
@@ -0,0 +1,249 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/// @brief Severity of a log record.
+enum class LogLevel : std::uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+/// @brief One argument of a log record, stored in binary form.
+struct LogArg
+{
+    /// @brief Kind of the stored value.
+    enum class Type : std::uint8_t
+    {
+        Int,
+        Unsigned,
+        Double,
+        Text
+    };
+
+    /// @brief Kind of the stored value.
+    Type type;
+    union
+    {
+        /// @brief Value of a signed integer.
+        long long i;
+        /// @brief Value of an unsigned integer.
+        unsigned long long u;
+        /// @brief Value of a floating point number.
+        double d;
+        /// @brief Offset of a copied string in the record text.
+        std::uint16_t text;
+    };
+};
+
+/// @brief Fixed-size binary log record. The message is formatted by the
+/// writer thread, so producers only copy the arguments.
+struct LogRecord
+{
+    /// @brief Maximum number of arguments, further ones are ignored.
+    static constexpr std::size_t kMaxArgs = 6;
+    /// @brief Room for the copied string arguments, longer ones are cut.
+    static constexpr std::size_t kTextBytes = 128;
+
+    /// @brief Time in nanoseconds on the trace clock.
+    std::int64_t time;
+    /// @brief printf-style format, a string with static storage duration.
+    const char* format;
+    /// @brief Number of records a rate limit dropped before this one.
+    std::uint32_t suppressed;
+    /// @brief Severity.
+    LogLevel level;
+    /// @brief Number of stored arguments.
+    std::uint8_t argCount;
+    /// @brief Number of used text bytes.
+    std::uint16_t textUsed;
+    /// @brief The arguments.
+    LogArg args[kMaxArgs];
+    /// @brief Copied string arguments, each terminated by a null character.
+    char text[kTextBytes];
+};
+
+/// @brief Rate limit of one log site: at most one record per interval, the
+/// records in between are counted and reported with the next one. Lock-free
+/// and constant-initialized, so it can be a static of a real-time function.
+class LogRateLimit
+{
+  private:
+    /// @brief Minimum time between two records in nanoseconds.
+    std::int64_t mInterval;
+    /// @brief Earliest time of the next record.
+    std::atomic<std::int64_t> mNext;
+    /// @brief Records dropped since the last one.
+    std::atomic<std::uint32_t> mSuppressed;
+
+  public:
+    /// @brief Constructor for the LogRateLimit class.
+    /// @param interval Minimum time between two records in nanoseconds.
+    constexpr LogRateLimit(std::int64_t interval) :
+        mInterval(interval), mNext(0), mSuppressed(0)
+    {}
+
+    /// @brief Takes the slot of the current interval.
+    /// @param suppressed Receives the number of records dropped before.
+    /// @return False if the record must be dropped.
+    bool allow(std::uint32_t& suppressed);
+};
+
+/// @brief Logging that is safe on real-time threads. Producers fill a
+/// LogRecord with the format and binary copies of the arguments and push it
+/// into a lock-free ring, which never blocks, allocates or touches stdio. A
+/// writer thread formats the records and writes them to stderr or a file.
+/// Records pushed before start are kept until the writer runs; when the ring
+/// is full they are dropped and counted. Formats must be string literals and
+/// take integer, floating point and string arguments; strings are copied.
+class Log
+{
+  private:
+    /// @brief Stamps and pushes a filled record.
+    /// @param record The record.
+    static void push(LogRecord& record);
+
+    /// @brief Stores one argument in a record.
+    template <typename T>
+    static void addArg(LogRecord& record, const T& value);
+    /// @brief Copies a string argument into a record.
+    static void addText(LogRecord& record, const char* text);
+
+  public:
+    /// @brief Starts the writer thread.
+    /// @param path Log file, appended to. Empty for stderr.
+    /// @return False if the file cannot be opened, stderr is used then.
+    static bool start(const std::string& path = "");
+
+    /// @brief Writes the queued records and stops the writer thread.
+    static void stop();
+
+    /// @brief Sets the lowest level that is logged. Defaults to Info.
+    /// @param level The level.
+    static void setLevel(LogLevel level);
+
+    /// @brief Returns whether records of a level are logged.
+    /// @param level The level.
+    /// @return True if the level is at least the set level.
+    static bool enabled(LogLevel level);
+
+    /// @brief Returns the number of records dropped because the ring was
+    /// full.
+    /// @return The drop count.
+    static std::uint64_t dropped();
+
+    /// @brief Logs a record. Lock-free, safe on real-time threads.
+    /// @param level Severity.
+    /// @param format printf-style format, a string literal.
+    /// @param args Integer, floating point or string arguments.
+    template <typename... Args>
+    static void write(LogLevel level, const char* format,
+                      const Args&... args);
+
+    /// @brief Logs a record unless the rate limit of its site drops it.
+    /// @param limit The rate limit of the log site.
+    /// @param level Severity.
+    /// @param format printf-style format, a string literal.
+    /// @param args Integer, floating point or string arguments.
+    template <typename... Args>
+    static void write(LogRateLimit& limit, LogLevel level, const char* format,
+                      const Args&... args);
+
+    /// @brief Fills a record the way write does, without queueing it.
+    /// @param level Severity.
+    /// @param suppressed Number of records a rate limit dropped before.
+    /// @param format printf-style format, a string literal.
+    /// @param args Integer, floating point or string arguments.
+    /// @return The record, with a time of zero.
+    template <typename... Args>
+    static LogRecord makeRecord(LogLevel level, std::uint32_t suppressed,
+                                const char* format, const Args&... args);
+
+    /// @brief Formats a record as one line without the line break.
+    /// @param record The record.
+    /// @return The formatted line.
+    static std::string format(const LogRecord& record);
+};
+
+template <typename T>
+void Log::addArg(LogRecord& record, const T& value)
+{
+    if (record.argCount == LogRecord::kMaxArgs) {
+        return;
+    }
+    LogArg& arg = record.args[record.argCount];
+    if constexpr (std::is_same_v<T, std::string>) {
+        addText(record, value.c_str());
+        return;
+    } else if constexpr (std::is_convertible_v<const T&, const char*>) {
+        addText(record, value);
+        return;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        arg.type = LogArg::Type::Double;
+        arg.d = static_cast<double>(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        arg.type = LogArg::Type::Int;
+        arg.i = static_cast<long long>(value);
+    } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        arg.type = LogArg::Type::Unsigned;
+        arg.u = static_cast<unsigned long long>(value);
+    } else {
+        static_assert(std::is_arithmetic_v<T>, "Unsupported log argument");
+    }
+    ++record.argCount;
+}
+
+template <typename... Args>
+LogRecord Log::makeRecord(LogLevel level, std::uint32_t suppressed,
+                          const char* format, const Args&... args)
+{
+    LogRecord record;
+    record.time = 0;
+    record.format = format;
+    record.suppressed = suppressed;
+    record.level = level;
+    record.argCount = 0;
+    record.textUsed = 0;
+    (addArg(record, args), ...);
+    return record;
+}
+
+template <typename... Args>
+void Log::write(LogLevel level, const char* format, const Args&... args)
+{
+    if (enabled(level)) {
+        LogRecord record = makeRecord(level, 0, format, args...);
+        push(record);
+    }
+}
+
+template <typename... Args>
+void Log::write(LogRateLimit& limit, LogLevel level, const char* format,
+                const Args&... args)
+{
+    std::uint32_t suppressed = 0;
+    if (enabled(level) && limit.allow(suppressed)) {
+        LogRecord record = makeRecord(level, suppressed, format, args...);
+        push(record);
+    }
+}
+
+/// @brief Logs at most once per interval from this site, for anomalies that
+/// may repeat every block.
+/// @param intervalMs Minimum time between two records in milliseconds.
+/// @param level Severity.
+#define RTNR_LOG_EVERY(intervalMs, level, ...)                                 \
+    do {                                                                       \
+        static LogRateLimit rtnrLogLimit(                                      \
+            static_cast<std::int64_t>(intervalMs) * 1000000);                  \
+        Log::write(rtnrLogLimit, level, __VA_ARGS__);                          \
+    } while (0)
+
+#endif // LOG_H
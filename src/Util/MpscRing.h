@@ -0,0 +1,123 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// @brief Bounded lock-free queue for any number of producer threads and one
+/// consumer thread. Every slot carries a sequence number, so producers claim
+/// slots with one compare-and-swap and never wait for each other to finish
+/// writing. Push and pop never block or allocate. The capacity is rounded up
+/// to a power of two.
+/// @tparam T The element type, copied in and out of the slots.
+template <typename T>
+class MpscRing
+{
+  private:
+    /// @brief One element with the sequence number that tells whose turn
+    /// the slot is.
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    /// @brief The slots.
+    std::unique_ptr<Slot[]> mSlots;
+    /// @brief Capacity minus one, used to wrap the indices.
+    std::size_t mMask;
+    /// @brief Number of claimed slots, shared by the producers.
+    alignas(64) std::atomic<std::size_t> mHead;
+    /// @brief Number of popped elements, used by the consumer only.
+    alignas(64) std::size_t mTail;
+
+  public:
+    /// @brief Constructor for the MpscRing class.
+    /// @param capacity Minimum number of elements the ring holds.
+    explicit MpscRing(std::size_t capacity);
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /// @brief Appends an element. Any thread.
+    /// @param value The element.
+    /// @return False if the ring is full and the element was dropped.
+    bool push(const T& value);
+
+    /// @brief Removes the oldest element. Consumer thread only.
+    /// @param value Receives the element.
+    /// @return False if the ring is empty or the oldest element is still
+    /// being written.
+    bool pop(T& value);
+
+    /// @brief Returns the number of slots.
+    /// @return The capacity.
+    std::size_t capacity() const;
+};
+
+template <typename T>
+MpscRing<T>::MpscRing(std::size_t capacity) : mHead(0), mTail(0)
+{
+    std::size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mSlots.reset(new Slot[size]);
+    mMask = size - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool MpscRing<T>::push(const T& value)
+{
+    std::size_t head = mHead.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &mSlots[head & mMask];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto lag = static_cast<std::intptr_t>(sequence) -
+                   static_cast<std::intptr_t>(head);
+        if (lag == 0) {
+            // the slot is free, claim it
+            if (mHead.compare_exchange_weak(head, head + 1,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // the consumer has not freed the slot of the previous lap
+            return false;
+        } else {
+            head = mHead.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->value = value;
+    slot->sequence.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool MpscRing<T>::pop(T& value)
+{
+    Slot& slot = mSlots[mTail & mMask];
+    if (slot.sequence.load(std::memory_order_acquire) != mTail + 1) {
+        return false;
+    }
+    value = slot.value;
+    // free the slot for the producers of the next lap
+    slot.sequence.store(mTail + mMask + 1, std::memory_order_release);
+    ++mTail;
+    return true;
+}
+
+template <typename T>
+std::size_t MpscRing<T>::capacity() const
+{
+    return mMask + 1;
+}
+
+#endif // MPSC_RING_H
@@ -0,0 +1,121 @@
+#include "RealTime.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define RTNR_HAS_SSE_CSR
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace
+{
+/// @brief Page size used to step through buffers while prefaulting.
+constexpr std::size_t kPageSize = 4096;
+
+#if defined(__linux__)
+/// @brief Converts the portable policy to the POSIX policy constant.
+int toPosixPolicy(RealTimePolicy policy)
+{
+    return policy == RealTimePolicy::RoundRobin ? SCHED_RR : SCHED_FIFO;
+}
+#endif
+} // namespace
+
+bool RealTime::disableDenormals()
+{
+#if defined(RTNR_HAS_SSE_CSR)
+    // FTZ (bit 15) and DAZ (bit 6) of the MXCSR register
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+    return true;
+#elif defined(__aarch64__)
+    // FZ (bit 24) of the FPCR register
+    unsigned long fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ __volatile__("msr fpcr, %0" ::"r"(fpcr | (1UL << 24)));
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RealTime::setThreadPriority(RealTimePolicy policy, int priority)
+{
+#if defined(__linux__)
+    int posixPolicy = toPosixPolicy(policy);
+    sched_param param{};
+    param.sched_priority =
+        std::clamp(priority, sched_get_priority_min(posixPolicy),
+                   sched_get_priority_max(posixPolicy));
+    return pthread_setschedparam(pthread_self(), posixPolicy, &param) == 0;
+#elif defined(_WIN32)
+    (void)policy;
+    (void)priority;
+    return SetThreadPriority(GetCurrentThread(),
+                             THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    (void)policy;
+    (void)priority;
+    return false;
+#endif
+}
+
+bool RealTime::probeThreadPriority(RealTimePolicy policy, int priority)
+{
+    bool granted = false;
+    std::thread probe(
+        [&granted, policy, priority]()
+        { granted = setThreadPriority(policy, priority); });
+    probe.join();
+    return granted;
+}
+
+bool RealTime::lockMemory()
+{
+#if defined(__linux__)
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    return false;
+#endif
+}
+
+void RealTime::unlockMemory()
+{
+#if defined(__linux__)
+    munlockall();
+#endif
+}
+
+std::size_t RealTime::prefault(void* data, std::size_t bytes)
+{
+    if (data == nullptr || bytes == 0) {
+        return 0;
+    }
+
+    // read and write back one byte per page, keeping the buffer contents
+    volatile unsigned char* bytePtr = static_cast<unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; i += kPageSize) {
+        bytePtr[i] = bytePtr[i];
+    }
+    bytePtr[bytes - 1] = bytePtr[bytes - 1];
+
+    return bytes;
+}
+
+void RealTime::prefaultStack()
+{
+    volatile unsigned char stack[64 * 1024];
+    for (std::size_t i = 0; i < sizeof(stack); i += kPageSize) {
+        stack[i] = 0;
+    }
+}
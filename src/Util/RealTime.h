@@ -0,0 +1,84 @@
+#ifndef REAL_TIME_H
+#define REAL_TIME_H
+
+#include <cstddef>
+
+/// @brief Scheduling policy requested for real-time threads.
+enum class RealTimePolicy
+{
+    /// @brief First-in first-out real-time scheduling (SCHED_FIFO).
+    Fifo,
+    /// @brief Round-robin real-time scheduling (SCHED_RR).
+    RoundRobin
+};
+
+/// @brief Summary of what the operating system granted when the real-time
+/// mode was requested.
+struct RealTimeReport
+{
+    /// @brief Flag to indicate that the real-time mode was requested.
+    bool requested = false;
+    /// @brief Flag to indicate that all process memory is locked in RAM.
+    bool memoryLocked = false;
+    /// @brief Number of bytes of pipeline buffers touched before streaming.
+    std::size_t prefaultedBytes = 0;
+    /// @brief Flag to indicate that a real-time thread priority is allowed.
+    bool priorityAllowed = false;
+    /// @brief Flag to indicate that the callback thread has been set up.
+    bool callbackThreadStarted = false;
+    /// @brief Flag to indicate that the callback thread runs with real-time
+    /// priority.
+    bool callbackPriority = false;
+    /// @brief Flag to indicate that flush-to-zero and denormals-are-zero are
+    /// active on the callback thread.
+    bool callbackDenormalsOff = false;
+    /// @brief Requested scheduling policy.
+    RealTimePolicy policy = RealTimePolicy::Fifo;
+    /// @brief Requested scheduling priority.
+    int priority = 0;
+};
+
+/// @brief Collection of platform helpers to run audio threads with real-time
+/// guarantees. Every function degrades gracefully and reports failure instead
+/// of throwing when the privileges are missing or the platform lacks support.
+class RealTime
+{
+  public:
+    /// @brief Enables flush-to-zero and denormals-are-zero on the calling
+    /// thread, so decaying filter and LSTM states never hit slow denormal
+    /// arithmetic.
+    /// @return True if the floating point mode was changed.
+    static bool disableDenormals();
+
+    /// @brief Sets real-time scheduling for the calling thread.
+    /// @param policy The scheduling policy.
+    /// @param priority The scheduling priority, clamped to the valid range.
+    /// @return True if the priority was granted.
+    static bool setThreadPriority(RealTimePolicy policy, int priority);
+
+    /// @brief Checks on a short-lived probe thread whether the process may
+    /// use the given real-time priority, without touching the caller.
+    /// @param policy The scheduling policy.
+    /// @param priority The scheduling priority.
+    /// @return True if the priority can be granted.
+    static bool probeThreadPriority(RealTimePolicy policy, int priority);
+
+    /// @brief Locks all current and future process memory in RAM.
+    /// @return True if the memory was locked.
+    static bool lockMemory();
+
+    /// @brief Unlocks all process memory.
+    static void unlockMemory();
+
+    /// @brief Touches every page of a buffer so that the first access from
+    /// the audio thread does not page fault.
+    /// @param data Pointer to the buffer.
+    /// @param bytes Size of the buffer in bytes.
+    /// @return Number of bytes touched.
+    static std::size_t prefault(void* data, std::size_t bytes);
+
+    /// @brief Touches the first 64 KiB of the calling thread stack.
+    static void prefaultStack();
+};
+
+#endif // REAL_TIME_H
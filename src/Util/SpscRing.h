@@ -0,0 +1,101 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// @brief Bounded lock-free queue for exactly one producer thread and one
+/// consumer thread. Push and pop never block or allocate, so the producer can
+/// be the audio thread. The capacity is rounded up to a power of two.
+/// @tparam T The element type, copied in and out of the slots.
+template <typename T>
+class SpscRing
+{
+  private:
+    /// @brief The slots.
+    std::vector<T> mSlots;
+    /// @brief Capacity minus one, used to wrap the indices.
+    std::size_t mMask;
+    /// @brief Number of pushed elements, written by the producer only.
+    alignas(64) std::atomic<std::size_t> mHead;
+    /// @brief Number of popped elements, written by the consumer only.
+    alignas(64) std::atomic<std::size_t> mTail;
+
+  public:
+    /// @brief Constructor for the SpscRing class.
+    /// @param capacity Minimum number of elements the ring holds.
+    explicit SpscRing(std::size_t capacity);
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// @brief Appends an element. Producer thread only.
+    /// @param value The element.
+    /// @return False if the ring is full and the element was dropped.
+    bool push(const T& value);
+
+    /// @brief Removes the oldest element. Consumer thread only.
+    /// @param value Receives the element.
+    /// @return False if the ring is empty.
+    bool pop(T& value);
+
+    /// @brief Returns the number of queued elements. Exact on the consumer
+    /// and producer threads, approximate elsewhere.
+    /// @return The element count.
+    std::size_t size() const;
+
+    /// @brief Returns the number of slots.
+    /// @return The capacity.
+    std::size_t capacity() const;
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(std::size_t capacity) : mHead(0), mTail(0)
+{
+    std::size_t count = 1;
+    while (count < capacity) {
+        count <<= 1;
+    }
+    mSlots.resize(count);
+    mMask = count - 1;
+}
+
+template <typename T>
+bool SpscRing<T>::push(const T& value)
+{
+    std::size_t head = mHead.load(std::memory_order_relaxed);
+    if (head - mTail.load(std::memory_order_acquire) > mMask) {
+        return false;
+    }
+    mSlots[head & mMask] = value;
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscRing<T>::pop(T& value)
+{
+    std::size_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail == mHead.load(std::memory_order_acquire)) {
+        return false;
+    }
+    value = mSlots[tail & mMask];
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+std::size_t SpscRing<T>::size() const
+{
+    return mHead.load(std::memory_order_acquire) -
+           mTail.load(std::memory_order_acquire);
+}
+
+template <typename T>
+std::size_t SpscRing<T>::capacity() const
+{
+    return mMask + 1;
+}
+
+#endif // SPSC_RING_H
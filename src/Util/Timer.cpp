@@ -2,15 +2,20 @@
 
 void Timer::start()
 {
-    m_start_time = high_resolution_clock::now();
+    m_start_time = steady_clock::now();
 }
 
 void Timer::stop()
 {
-    m_end_time = high_resolution_clock::now();
+    m_end_time = steady_clock::now();
 }
 
 double Timer::elapsedMilliseconds() const
 {
-    return duration_cast<milliseconds>(m_end_time - m_start_time).count();
+    return duration<double, std::milli>(m_end_time - m_start_time).count();
+}
+
+long long Timer::elapsedNanoseconds() const
+{
+    return duration_cast<nanoseconds>(m_end_time - m_start_time).count();
 }
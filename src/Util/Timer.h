@@ -3,20 +3,22 @@
 
 #include <chrono>
 
+using std::chrono::duration;
 using std::chrono::duration_cast;
-using std::chrono::high_resolution_clock;
-using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
 using std::chrono::time_point;
 
-/// @brief Class for measuring the execution time of a piece of code.
+/// @brief Class for measuring the execution time of a piece of code. Uses the
+/// steady clock, which never jumps with wall clock adjustments.
 class Timer
 {
   private:
     /// @brief The start time point of the timer
-    time_point<high_resolution_clock> m_start_time;
+    time_point<steady_clock> m_start_time;
 
     /// @brief The end time point of the timer.
-    time_point<high_resolution_clock> m_end_time;
+    time_point<steady_clock> m_end_time;
 
   public:
     /// @brief Start the timer.
@@ -26,8 +28,12 @@ class Timer
     void stop();
 
     /// @brief Get the elapsed time in milliseconds.
-    /// @return The elapsed time in milliseconds.
+    /// @return The elapsed time in milliseconds, with the fractional part.
     double elapsedMilliseconds() const;
+
+    /// @brief Get the elapsed time in nanoseconds.
+    /// @return The elapsed time in nanoseconds.
+    long long elapsedNanoseconds() const;
 };
 
 #endif // TIMER_H
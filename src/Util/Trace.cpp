@@ -0,0 +1,315 @@
+#include "Trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SpscRing.h"
+
+namespace
+{
+/// @brief Zones a thread can record between two drains.
+constexpr std::size_t kRingCapacity = 1 << 14;
+/// @brief Zones kept for the export, the oldest are overwritten.
+constexpr std::size_t kHistoryCapacity = 1 << 18;
+/// @brief Interval between two drains of the collector.
+constexpr std::chrono::milliseconds kCollectInterval(50);
+/// @brief Most rings the tracer hands out, further threads go untraced.
+constexpr std::size_t kMaxThreads = 64;
+
+/// @brief Ring and identity of one traced thread. A ring outlives its
+/// thread and is taken over by the next thread of the same name.
+struct ThreadTrace
+{
+    ThreadTrace(const char* threadName, int threadId, bool owned) :
+        name(threadName), id(threadId), ring(kRingCapacity), dropped(0),
+        attached(owned)
+    {}
+
+    std::string name;
+    int id;
+    SpscRing<TraceEvent> ring;
+    std::atomic<std::size_t> dropped;
+    /// @brief Set while a thread records into the ring.
+    std::atomic<bool> attached;
+};
+
+/// @brief Zone tagged with the id of its thread.
+struct CollectedEvent
+{
+    int thread;
+    TraceEvent event;
+};
+
+/// @brief Shared state of the tracer. Rings are never freed, so the zones of
+/// finished threads stay exportable.
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTrace>> threads;
+    /// @brief The rings again, published for lookups without the mutex.
+    std::array<std::atomic<ThreadTrace*>, kMaxThreads> published{};
+    std::atomic<std::size_t> publishedCount{0};
+    std::vector<CollectedEvent> history;
+    std::size_t historyNext = 0;
+    bool historyWrapped = false;
+
+    std::thread collector;
+    std::condition_variable wake;
+    bool running = false;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+const std::chrono::steady_clock::time_point kEpoch =
+    std::chrono::steady_clock::now();
+
+/// @brief Ring of the calling thread, handed back when the thread ends.
+struct ThreadHandle
+{
+    ThreadTrace* trace = nullptr;
+
+    ~ThreadHandle()
+    {
+        if (trace) {
+            trace->attached.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadHandle tCurrent;
+
+/// @brief Takes over a free ring of the given name without a lock.
+/// @return The ring, null if there is none.
+ThreadTrace* claim(Registry& registry, const char* name)
+{
+    std::size_t count =
+        registry.publishedCount.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; ++i) {
+        ThreadTrace* trace =
+            registry.published[i].load(std::memory_order_relaxed);
+        bool expected = false;
+        if (!trace->attached.compare_exchange_strong(
+                expected, true, std::memory_order_acquire)) {
+            continue;
+        }
+        // only the owner renames a ring, the name is stable once claimed
+        if (trace->name == name) {
+            return trace;
+        }
+        trace->attached.store(false, std::memory_order_release);
+    }
+    return nullptr;
+}
+
+/// @brief Allocates a ring and publishes it. The registry mutex must be
+/// held.
+/// @return The ring, null if the tracer is out of rings.
+ThreadTrace* create(Registry& registry, const char* name, bool attached)
+{
+    if (registry.threads.size() == kMaxThreads) {
+        return nullptr;
+    }
+    int id = static_cast<int>(registry.threads.size()) + 1;
+    registry.threads.push_back(
+        std::make_unique<ThreadTrace>(name, id, attached));
+    ThreadTrace* trace = registry.threads.back().get();
+    registry.published[registry.threads.size() - 1].store(
+        trace, std::memory_order_relaxed);
+    registry.publishedCount.store(registry.threads.size(),
+                                  std::memory_order_release);
+    return trace;
+}
+
+/// @brief Moves the queued zones of every thread into the history. The
+/// registry mutex must be held.
+void drain(Registry& registry)
+{
+    if (registry.history.size() < kHistoryCapacity) {
+        registry.history.resize(kHistoryCapacity);
+    }
+
+    for (const auto& thread : registry.threads) {
+        CollectedEvent collected;
+        collected.thread = thread->id;
+        while (thread->ring.pop(collected.event)) {
+            registry.history[registry.historyNext] = collected;
+            registry.historyNext = (registry.historyNext + 1) %
+                                   kHistoryCapacity;
+            if (registry.historyNext == 0) {
+                registry.historyWrapped = true;
+            }
+        }
+    }
+}
+
+/// @brief Writes a string as a JSON string literal.
+void writeJsonString(std::ostream& out, const std::string& value)
+{
+    out << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+} // namespace
+
+std::int64_t Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - kEpoch)
+        .count();
+}
+
+void Trace::registerThread(const char* name)
+{
+    // only the thread itself renames its entry, so the check needs no lock
+    ThreadTrace* current = tCurrent.trace;
+    if (current && current->name == name) {
+        return;
+    }
+
+    Registry& instance = registry();
+    if (!current) {
+        tCurrent.trace = claim(instance, name);
+        if (tCurrent.trace) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    if (current) {
+        current->name = name;
+        return;
+    }
+    tCurrent.trace = create(instance, name, true);
+}
+
+void Trace::reserveThread(const char* name)
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    for (const auto& thread : instance.threads) {
+        if (!thread->attached.load(std::memory_order_acquire) &&
+            thread->name == name) {
+            return;
+        }
+    }
+    create(instance, name, false);
+}
+
+void Trace::record(const char* name, std::int64_t start,
+                   std::int64_t duration)
+{
+    if (!tCurrent.trace) {
+        registerThread("thread");
+        if (!tCurrent.trace) {
+            return;
+        }
+    }
+    if (!tCurrent.trace->ring.push({name, start, duration})) {
+        tCurrent.trace->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Trace::start()
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    if (instance.running) {
+        return;
+    }
+
+    instance.running = true;
+    instance.collector = std::thread([&instance]() {
+        std::unique_lock<std::mutex> lock(instance.mutex);
+        while (instance.running) {
+            drain(instance);
+            instance.wake.wait_for(lock, kCollectInterval);
+        }
+    });
+}
+
+void Trace::stop()
+{
+    Registry& instance = registry();
+    {
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        if (!instance.running) {
+            return;
+        }
+        instance.running = false;
+    }
+    instance.wake.notify_all();
+    instance.collector.join();
+
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    drain(instance);
+}
+
+bool Trace::dump(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    drain(instance);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& thread : instance.threads) {
+        out << (first ? "" : ",")
+            << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+            << thread->id << ",\"args\":{\"name\":";
+        writeJsonString(out, thread->name);
+        out << "}}";
+        first = false;
+    }
+
+    // oldest zone first, timestamps in microseconds
+    std::size_t count = instance.historyWrapped ? kHistoryCapacity
+                                                : instance.historyNext;
+    std::size_t begin = instance.historyWrapped ? instance.historyNext : 0;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (std::size_t i = 0; i < count; ++i) {
+        const CollectedEvent& collected =
+            instance.history[(begin + i) % kHistoryCapacity];
+        out << (first ? "" : ",") << "\n{\"ph\":\"X\",\"name\":";
+        writeJsonString(out, collected.event.name);
+        out << ",\"pid\":1,\"tid\":" << collected.thread
+            << ",\"ts\":" << collected.event.start / 1000.0
+            << ",\"dur\":" << collected.event.duration / 1000.0 << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+
+    return static_cast<bool>(out);
+}
+
+std::size_t Trace::dropped()
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    std::size_t dropped = 0;
+    for (const auto& thread : instance.threads) {
+        dropped += thread->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
@@ -0,0 +1,106 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// @brief One completed zone.
+struct TraceEvent
+{
+    /// @brief Zone name, a string with static storage duration.
+    const char* name;
+    /// @brief Start time in nanoseconds since the trace epoch.
+    std::int64_t start;
+    /// @brief Duration in nanoseconds.
+    std::int64_t duration;
+};
+
+/// @brief Low-overhead tracing of hot-path zones. Every thread records its
+/// zones into its own lock-free ring, so recording is two clock reads and a
+/// store. A collector thread drains the rings into a bounded history that is
+/// exported as Chrome trace JSON, which chrome://tracing and Perfetto open.
+/// Use the RTNR_TRACE_* macros so zones compile out unless the build defines
+/// RTNR_ENABLE_TRACING.
+class Trace
+{
+  public:
+    /// @brief Returns the trace clock.
+    /// @return Nanoseconds since the trace epoch on a steady clock.
+    static std::int64_t now();
+
+    /// @brief Names the calling thread and gives it a ring. A ring of the
+    /// same name that is reserved or was left by a finished thread is taken
+    /// over without a lock or an allocation, otherwise one is allocated.
+    /// Calling it again with the same name is cheap. Threads that record
+    /// without registering are registered on their first zone.
+    /// @param name Thread name shown in the trace.
+    static void registerThread(const char* name);
+
+    /// @brief Allocates a ring for a thread that is not started yet, so its
+    /// registration on a real-time thread is lock-free. Does nothing if a
+    /// free ring of that name exists.
+    /// @param name Thread name the ring is reserved for.
+    static void reserveThread(const char* name);
+
+    /// @brief Records a completed zone on the calling thread. Never blocks;
+    /// the zone is dropped if the ring of the thread is full.
+    /// @param name Zone name, a string with static storage duration.
+    /// @param start Start time from now.
+    /// @param duration Duration in nanoseconds.
+    static void record(const char* name, std::int64_t start,
+                       std::int64_t duration);
+
+    /// @brief Starts the collector thread.
+    static void start();
+
+    /// @brief Stops the collector thread after a final drain.
+    static void stop();
+
+    /// @brief Writes the collected zones as Chrome trace JSON.
+    /// @param path Output file path.
+    /// @return True on success.
+    static bool dump(const std::string& path);
+
+    /// @brief Returns the number of zones dropped because a ring was full.
+    /// @return The drop count over all threads.
+    static std::size_t dropped();
+};
+
+/// @brief RAII zone recorded from construction to destruction.
+class TraceScope
+{
+  private:
+    /// @brief Zone name.
+    const char* mName;
+    /// @brief Start time.
+    std::int64_t mStart;
+
+  public:
+    /// @brief Constructor for the TraceScope class, opens the zone.
+    /// @param name Zone name, a string with static storage duration.
+    TraceScope(const char* name) : mName(name), mStart(Trace::now()) {}
+    /// @brief Destructor, closes and records the zone.
+    ~TraceScope() { Trace::record(mName, mStart, Trace::now() - mStart); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#ifdef RTNR_ENABLE_TRACING
+#define RTNR_TRACE_CONCAT_INNER(a, b) a##b
+#define RTNR_TRACE_CONCAT(a, b) RTNR_TRACE_CONCAT_INNER(a, b)
+/// @brief Records a zone for the rest of the enclosing scope.
+#define RTNR_TRACE_SCOPE(name)                                                 \
+    TraceScope RTNR_TRACE_CONCAT(rtnrTraceScope, __LINE__)(name)
+/// @brief Names the calling thread in the trace.
+#define RTNR_TRACE_THREAD(name) Trace::registerThread(name)
+/// @brief Allocates the ring of a thread started later.
+#define RTNR_TRACE_RESERVE(name) Trace::reserveThread(name)
+#else
+#define RTNR_TRACE_SCOPE(name) ((void)0)
+#define RTNR_TRACE_THREAD(name) ((void)0)
+#define RTNR_TRACE_RESERVE(name) ((void)0)
+#endif
+
+#endif // TRACE_H
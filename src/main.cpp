@@ -1,13 +1,222 @@
 #include <QApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <iostream>
 
+#include "AudioFile/AudioFile.h"
+#include "DSP/KernelBench.h"
 #include "GUI/MainWidget.h"
+#include "Inference/ModelProbe.h"
+#include "Metrics/Metrics.h"
+#include "Stream/AudioStream.h"
+#include "Util/Log.h"
+#include "Util/Trace.h"
 
 int main(int argc, char* argv[])
 {
     QApplication a(argc, argv);
 
-    MainWidget widget;
+    // diagnostics are formatted off the audio threads, to stderr by default
+    QString logPath;
+    int logIndex = QApplication::arguments().indexOf("--log");
+    if (logIndex >= 0 && logIndex + 1 < QApplication::arguments().size()) {
+        logPath = QApplication::arguments().at(logIndex + 1);
+    }
+    Log::start(logPath.toStdString());
+
+    // compare model backends instead of starting the GUI
+    QStringList arguments = QApplication::arguments();
+    if (arguments.contains("--probe-model")) {
+        qint64 binarySize =
+            QFileInfo(QApplication::applicationFilePath()).size();
+        std::cout << "Binary size: " << binarySize / 1024 << " KiB"
+                  << std::endl;
+        for (int i = 0; i + 1 < arguments.size(); ++i) {
+            if (arguments.at(i) == "--probe-model") {
+                std::string model = arguments.at(i + 1).toStdString();
+                try {
+                    std::cout << ModelProbe::run(model, 1536).toString()
+                              << std::endl;
+                } catch (const std::exception& e) {
+                    std::cout << model << ": " << e.what() << std::endl;
+                }
+            }
+        }
+        Log::stop();
+        return 0;
+    }
+
+    // time the specialized DSP kernels against the generic ones
+    if (arguments.contains("--bench-kernels")) {
+        std::cout << KernelBench::run(1536, 384).toString() << std::endl;
+        std::cout << KernelBench::run(1536, 1536).toString() << std::endl;
+        Log::stop();
+        return 0;
+    }
+
+    // score processed files against their references, one pair per line
+    int scoreIndex = arguments.indexOf("--score-list");
+    if (scoreIndex >= 0 && scoreIndex + 1 < arguments.size()) {
+        QFile list(arguments.at(scoreIndex + 1));
+        if (!list.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            std::cerr << "Cannot read " << list.fileName().toStdString()
+                      << std::endl;
+            Log::stop();
+            return 1;
+        }
+        std::vector<std::pair<std::string, std::string>> pairs;
+        QTextStream lines(&list);
+        while (!lines.atEnd()) {
+            QStringList files =
+                lines.readLine().simplified().split(' ', Qt::SkipEmptyParts);
+            if (files.size() >= 2) {
+                pairs.emplace_back(files.at(0).toStdString(),
+                                   files.at(1).toStdString());
+            }
+        }
+        std::size_t threads = 0;
+        int threadsIndex = arguments.indexOf("--score-threads");
+        if (threadsIndex >= 0 && threadsIndex + 1 < arguments.size()) {
+            threads = arguments.at(threadsIndex + 1).toULong();
+        }
+
+        bool ok = true;
+        std::cout << MetricScores::csvHeader() << std::endl;
+        for (const MetricScores& scores : Metrics::scoreBatch(pairs, threads)) {
+            std::cout << scores.toCsv() << std::endl;
+            ok = ok && scores.ok;
+        }
+        Log::stop();
+        return ok ? 0 : 1;
+    }
+
+    // a model directory, a manifest of variants to auto-tune between, or
+    // "spectral" for the Wiener filter tier
+    std::string modelFilepath = "./model";
+    int modelIndex = QApplication::arguments().indexOf("--model");
+    if (modelIndex >= 0 && modelIndex + 1 < QApplication::arguments().size()) {
+        modelFilepath =
+            QApplication::arguments().at(modelIndex + 1).toStdString();
+    }
+
+    // optional per-bin Kalman filter on the STFT magnitudes around the model
+    StagePlacement spectralKalman = StagePlacement::Off;
+    int spectralKalmanIndex = arguments.indexOf("--spectral-kalman");
+    if (spectralKalmanIndex >= 0 &&
+        spectralKalmanIndex + 1 < arguments.size()) {
+        QString placement = arguments.at(spectralKalmanIndex + 1);
+        if (placement == "pre") {
+            spectralKalman = StagePlacement::BeforeModel;
+        } else if (placement == "post") {
+            spectralKalman = StagePlacement::AfterModel;
+        }
+    }
+
+    // denoise a file offline as fast as possible, for archives
+    int denoiseIndex = arguments.indexOf("--denoise-file");
+    if (denoiseIndex >= 0 && denoiseIndex + 2 < arguments.size()) {
+        ProcessAudioFile file(arguments.at(denoiseIndex + 1).toStdString(),
+                              arguments.at(denoiseIndex + 2).toStdString());
+        double factor = file.neural(modelFilepath);
+        if (factor >= 0) {
+            std::cout << "Real-time factor: " << factor << std::endl;
+        }
+        Log::stop();
+        return factor >= 0 ? 0 : 1;
+    }
+
+    // feed a file through the live callback path instead of a device
+    int virtualIndex = arguments.indexOf("--virtual-input");
+    if (virtualIndex >= 0 && virtualIndex + 1 < arguments.size()) {
+        VirtualDeviceOptions options;
+        options.inputPath = arguments.at(virtualIndex + 1).toStdString();
+        options.outputPath = "virtual_output.wav";
+        int outputIndex = arguments.indexOf("--virtual-output");
+        if (outputIndex >= 0 && outputIndex + 1 < arguments.size()) {
+            options.outputPath = arguments.at(outputIndex + 1).toStdString();
+        }
+        int timingsIndex = arguments.indexOf("--virtual-timings");
+        if (timingsIndex >= 0 && timingsIndex + 1 < arguments.size()) {
+            options.timingsPath = arguments.at(timingsIndex + 1).toStdString();
+        }
+        int bufferIndex = arguments.indexOf("--virtual-buffer");
+        if (bufferIndex >= 0 && bufferIndex + 1 < arguments.size()) {
+            options.framesPerBuffer = arguments.at(bufferIndex + 1).toULong();
+        }
+        int jitterIndex = arguments.indexOf("--virtual-jitter");
+        if (jitterIndex >= 0 && jitterIndex + 1 < arguments.size()) {
+            options.jitterMs = arguments.at(jitterIndex + 1).toDouble();
+        }
+        if (arguments.contains("--virtual-fast")) {
+            options.pacing = VirtualPacing::Fast;
+        }
+
+        AudioStream stream(modelFilepath);
+        stream.setReduceNoise(true);
+        stream.setRealTimeMode(arguments.contains("--realtime"));
+        stream.setSpectralKalman(spectralKalman);
+        VirtualRunReport report = stream.runVirtual(options);
+        std::cout << report.toString();
+        Log::stop();
+        return report.ok ? 0 : 1;
+    }
+
+    MainWidget widget(nullptr, modelFilepath);
+    // opt-in real-time scheduling for the audio callback
+    if (QApplication::arguments().contains("--realtime")) {
+        widget.setRealTimeMode(true);
+    }
+    widget.setSpectralKalman(spectralKalman);
+    // let local processes read the processed audio from shared memory
+    int sinkIndex = QApplication::arguments().indexOf("--shm-sink");
+    if (sinkIndex >= 0 && sinkIndex + 1 < QApplication::arguments().size()) {
+        widget.openSharedSink(
+            QApplication::arguments().at(sinkIndex + 1).toStdString());
+    }
+    // record input and output for audits, optionally split into parts
+    int recordIndex = QApplication::arguments().indexOf("--record");
+    if (recordIndex >= 0 &&
+        recordIndex + 1 < QApplication::arguments().size()) {
+        RecorderOptions options;
+        options.path =
+            QApplication::arguments().at(recordIndex + 1).toStdString();
+        int secondsIndex =
+            QApplication::arguments().indexOf("--record-rotate-seconds");
+        if (secondsIndex >= 0 &&
+            secondsIndex + 1 < QApplication::arguments().size()) {
+            options.rotateSeconds =
+                QApplication::arguments().at(secondsIndex + 1).toDouble();
+        }
+        int sizeIndex = QApplication::arguments().indexOf("--record-rotate-mb");
+        if (sizeIndex >= 0 &&
+            sizeIndex + 1 < QApplication::arguments().size()) {
+            options.rotateBytes =
+                QApplication::arguments().at(sizeIndex + 1).toULongLong() *
+                1024 * 1024;
+        }
+        widget.startRecording(options);
+    }
+    // record hot-path zones and write them as Chrome trace JSON on exit
+    QString tracePath;
+    int traceIndex = QApplication::arguments().indexOf("--trace");
+    if (traceIndex >= 0 && traceIndex + 1 < QApplication::arguments().size()) {
+        tracePath = QApplication::arguments().at(traceIndex + 1);
+        RTNR_TRACE_THREAD("gui");
+        Trace::start();
+    }
     widget.show();
 
-    return QApplication::exec();
+    int result = QApplication::exec();
+
+    if (!tracePath.isEmpty()) {
+        Trace::stop();
+        if (!Trace::dump(tracePath.toStdString())) {
+            Log::write(LogLevel::Error, "Error writing trace file %s",
+                       tracePath.toStdString());
+        }
+    }
+    Log::stop();
+
+    return result;
 }